@@ -0,0 +1,144 @@
+#version 460 core
+
+layout (local_size_x = 64) in;
+
+layout (location = 0) uniform uint u_meshlet_count;
+
+layout (binding = 0, std140) uniform CameraInformation
+{
+    mat4 ProjectionMatrix;
+    mat4 ViewMatrix;
+    vec4 CameraPosition;
+    vec4 FrustumPlanes[6];
+} u_camera_information;
+
+#include "Include/Object.glsl"
+
+struct SMeshlet
+{
+    vec4 CenterRadius;
+    vec4 ConeApexCutoff;
+    vec4 ConeAxis;
+    uint FirstIndex;
+    uint IndexCount;
+    int BaseVertex;
+    uint ObjectIndex;
+};
+
+struct SDrawElementsIndirectCommand
+{
+    uint IndexCount;
+    uint InstanceCount;
+    uint FirstIndex;
+    int BaseVertex;
+    uint BaseInstance;
+};
+
+layout (binding = 3, std430) restrict readonly buffer ObjectsBuffer
+{
+    SObject Objects[];
+};
+
+layout (binding = 6, std430) restrict readonly buffer MeshletBuffer
+{
+    SMeshlet Meshlets[];
+};
+
+layout (binding = 7, std430) restrict writeonly buffer MeshletIndirectBuffer
+{
+    SDrawElementsIndirectCommand DrawCommands[];
+};
+
+layout (binding = 8, std430) restrict buffer MeshletIndirectCountBuffer
+{
+    // one per draw bucket
+    uint DrawCounts[];
+};
+
+// lod selected per object on the cpu, only objects in view at lod 0 are drawn through their meshlets
+layout (binding = 9, std430) restrict readonly buffer ObjectLodBuffer
+{
+    uint ObjectLods[];
+};
+
+bool IsSphereVisible(vec3 center, float radius)
+{
+    for (int i = 0; i < 6; i++) {
+        if (dot(u_camera_information.FrustumPlanes[i].xyz, center) + u_camera_information.FrustumPlanes[i].w < -radius) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// the whole cluster faces away from the camera when the view direction falls outside of its normal cone
+bool IsConeBackfacing(vec3 coneApex, vec3 coneAxis, float coneCutoff)
+{
+    if (coneCutoff >= 1.0) {
+        return false;
+    }
+
+    vec3 view = coneApex - u_camera_information.CameraPosition.xyz;
+    return dot(normalize(view), coneAxis) >= coneCutoff;
+}
+
+// the cutoff of a cone only survives a matrix which keeps angles, rotation and uniform scale, mirrored or not
+bool IsConformal(mat3 matrix)
+{
+    const float epsilon = 1e-3;
+    vec3 lengths = vec3(length(matrix[0]), length(matrix[1]), length(matrix[2]));
+    float maxLength = max(lengths.x, max(lengths.y, lengths.z));
+    float minLength = min(lengths.x, min(lengths.y, lengths.z));
+    if (maxLength - minLength > epsilon * maxLength) {
+        return false;
+    }
+
+    float maxShear = max(abs(dot(matrix[0], matrix[1])), max(abs(dot(matrix[1], matrix[2])), abs(dot(matrix[2], matrix[0]))));
+    return maxShear <= epsilon * maxLength * maxLength;
+}
+
+void main()
+{
+    uint meshletIndex = gl_GlobalInvocationID.x;
+    if (meshletIndex >= u_meshlet_count) {
+        return;
+    }
+
+    SMeshlet meshlet = Meshlets[meshletIndex];
+    if (ObjectLods[meshlet.ObjectIndex] != 0) {
+        return;
+    }
+
+    SObject object = Objects[meshlet.ObjectIndex];
+    mat4 worldMatrix = object.WorldMatrix;
+
+    vec3 center = (worldMatrix * vec4(meshlet.CenterRadius.xyz, 1.0)).xyz;
+    float scale = max(length(worldMatrix[0].xyz), max(length(worldMatrix[1].xyz), length(worldMatrix[2].xyz)));
+    float radius = meshlet.CenterRadius.w * scale;
+
+    if (!IsSphereVisible(center, radius)) {
+        return;
+    }
+
+    // the cone holds winding normals, they transform with the cofactor matrix: the inverse-transpose times the
+    // determinant, which also flips them when the matrix mirrors. non-uniform scale and shear skip the test
+    mat3 normalMatrix = mat3(worldMatrix);
+    if (IsConformal(normalMatrix)) {
+        mat3 cofactorMatrix = mat3(
+            cross(normalMatrix[1], normalMatrix[2]),
+            cross(normalMatrix[2], normalMatrix[0]),
+            cross(normalMatrix[0], normalMatrix[1]));
+        vec3 coneApex = (worldMatrix * vec4(meshlet.ConeApexCutoff.xyz, 1.0)).xyz;
+        vec3 coneAxis = normalize(cofactorMatrix * meshlet.ConeAxis.xyz);
+        if (IsConeBackfacing(coneApex, coneAxis, meshlet.ConeApexCutoff.w)) {
+            return;
+        }
+    }
+
+    // meshlets are compacted into the range and count of the draw bucket of their object
+    uint drawBucketIndex = uint(object.InstanceParameter.y);
+    uint firstDrawIndex = uint(object.InstanceParameter.z);
+    uint drawIndex = firstDrawIndex + atomicAdd(DrawCounts[drawBucketIndex], 1);
+    DrawCommands[drawIndex] = SDrawElementsIndirectCommand(meshlet.IndexCount, 1, meshlet.FirstIndex, meshlet.BaseVertex, meshlet.ObjectIndex);
+}
@@ -0,0 +1,173 @@
+#version 450 core
+
+// nothing here needs 4.6, at 4.5 the culling test also runs on llvmpipe
+
+layout (local_size_x = 64) in;
+
+layout (location = 0) uniform uint u_object_count;
+layout (location = 1) uniform float u_projection_scale;
+layout (location = 2) uniform float u_lod_error_threshold;
+layout (location = 3) uniform bool u_is_lod_selection_enabled;
+layout (location = 4) uniform bool u_is_frustum_culling_enabled;
+layout (location = 5) uniform bool u_is_meshlet_culling_enabled;
+// the bits of the models follow the bits of the materials in SeenBits
+layout (location = 6) uniform uint u_seen_model_first_word;
+
+layout (binding = 0, std140) uniform CameraInformation
+{
+    mat4 ProjectionMatrix;
+    mat4 ViewMatrix;
+    vec4 CameraPosition;
+    vec4 FrustumPlanes[6];
+} u_camera_information;
+
+#include "Include/Object.glsl"
+
+// bounds and lod range of the primitive of an object, in object space
+struct SCullObject
+{
+    vec4 CenterRadius;
+    vec3 Extent;
+    uint FirstLod;
+    uint LodCount;
+    int BaseVertex;
+    uint HasMeshlets;
+    uint ModelIndex;
+};
+
+struct SPrimitiveLod
+{
+    uint IndexOffset;
+    uint IndexCount;
+    float Error;
+};
+
+struct SDrawElementsIndirectCommand
+{
+    uint IndexCount;
+    uint InstanceCount;
+    uint FirstIndex;
+    int BaseVertex;
+    uint BaseInstance;
+};
+
+layout (binding = 3, std430) restrict readonly buffer ObjectsBuffer
+{
+    SObject Objects[];
+};
+
+layout (binding = 9, std430) restrict writeonly buffer ObjectLodBuffer
+{
+    // 0xFFFFFFFF when out of view
+    uint ObjectLods[];
+};
+
+layout (binding = 10, std430) restrict readonly buffer CullObjectBuffer
+{
+    SCullObject CullObjects[];
+};
+
+layout (binding = 11, std430) restrict readonly buffer PrimitiveLodBuffer
+{
+    SPrimitiveLod PrimitiveLods[];
+};
+
+layout (binding = 12, std430) restrict writeonly buffer ObjectIndirectBuffer
+{
+    SDrawElementsIndirectCommand DrawCommands[];
+};
+
+layout (binding = 13, std430) restrict buffer ObjectIndirectCountBuffer
+{
+    // one per draw bucket
+    uint DrawCounts[];
+};
+
+layout (binding = 14, std430) restrict buffer SeenBuffer
+{
+    // one bit per material and one per model of the scene, set when an object using it is in view
+    uint SeenBits[];
+};
+
+// the box is outside when it lies entirely behind one of the planes, the same test as CullBounds on the cpu
+bool IsBoxVisible(vec3 center, vec3 extent)
+{
+    for (int i = 0; i < 6; i++) {
+        vec4 plane = u_camera_information.FrustumPlanes[i];
+        if (dot(plane.xyz, center) + plane.w + dot(abs(plane.xyz), extent) < 0.0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// the coarsest lod whose error projects to less than the threshold, the same as SelectLod on the cpu
+uint SelectLod(SCullObject cullObject, mat4 worldMatrix)
+{
+    vec3 center = (worldMatrix * vec4(cullObject.CenterRadius.xyz, 1.0)).xyz;
+    float scale = max(length(worldMatrix[0].xyz), max(length(worldMatrix[1].xyz), length(worldMatrix[2].xyz)));
+    float cameraDistance = max(distance(center, u_camera_information.CameraPosition.xyz) - cullObject.CenterRadius.w * scale, 0.1);
+
+    uint lodIndex = 0;
+    for (uint i = 1; i < cullObject.LodCount; i++) {
+        float projectedError = PrimitiveLods[cullObject.FirstLod + i].Error * scale / cameraDistance * u_projection_scale;
+        if (projectedError > u_lod_error_threshold) {
+            break;
+        }
+        lodIndex = i;
+    }
+
+    return lodIndex;
+}
+
+void main()
+{
+    uint objectIndex = gl_GlobalInvocationID.x;
+    if (objectIndex >= u_object_count) {
+        return;
+    }
+
+    SObject object = Objects[objectIndex];
+    SCullObject cullObject = CullObjects[objectIndex];
+    mat4 worldMatrix = object.WorldMatrix;
+
+    if (u_is_frustum_culling_enabled) {
+        vec3 center = (worldMatrix * vec4(cullObject.CenterRadius.xyz, 1.0)).xyz;
+        vec3 extent =
+            abs(worldMatrix[0].xyz) * cullObject.Extent.x +
+            abs(worldMatrix[1].xyz) * cullObject.Extent.y +
+            abs(worldMatrix[2].xyz) * cullObject.Extent.z;
+        if (!IsBoxVisible(center, extent)) {
+            ObjectLods[objectIndex] = 0xFFFFFFFF;
+            return;
+        }
+    }
+
+    // most objects share their material with others in view already, reading first saves most of the atomics
+    uint materialIndex = uint(object.InstanceParameter.x);
+    uint materialBit = 1u << (materialIndex % 32);
+    if ((SeenBits[materialIndex / 32] & materialBit) == 0) {
+        atomicOr(SeenBits[materialIndex / 32], materialBit);
+    }
+    uint modelWord = u_seen_model_first_word + cullObject.ModelIndex / 32;
+    uint modelBit = 1u << (cullObject.ModelIndex % 32);
+    if ((SeenBits[modelWord] & modelBit) == 0) {
+        atomicOr(SeenBits[modelWord], modelBit);
+    }
+
+    uint lodIndex = u_is_lod_selection_enabled ? SelectLod(cullObject, worldMatrix) : 0;
+    ObjectLods[objectIndex] = lodIndex;
+
+    // lod 0 goes through the meshlet culling pass
+    if (u_is_meshlet_culling_enabled && lodIndex == 0 && cullObject.HasMeshlets != 0) {
+        return;
+    }
+
+    // commands are compacted into the range and count of the draw bucket of the object
+    SPrimitiveLod lod = PrimitiveLods[cullObject.FirstLod + lodIndex];
+    uint drawBucketIndex = uint(object.InstanceParameter.y);
+    uint firstDrawIndex = uint(object.InstanceParameter.w);
+    uint drawIndex = firstDrawIndex + atomicAdd(DrawCounts[drawBucketIndex], 1);
+    DrawCommands[drawIndex] = SDrawElementsIndirectCommand(lod.IndexCount, 1, lod.IndexOffset, cullObject.BaseVertex, objectIndex);
+}
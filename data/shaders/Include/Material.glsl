@@ -0,0 +1,13 @@
+// needs GL_ARB_bindless_texture and GL_ARB_gpu_shader_int64, the extensions have to be enabled before any code
+struct SGpuMaterial
+{
+    vec4 base_color;
+
+    uint64_t base_texture_handle;
+    uint64_t normal_texture_handle;
+    uint64_t occlusion_texture_handle;
+    uint64_t metallic_roughness_texture_handle;
+
+    uint64_t emissive_texture_handle;
+    uint64_t _padding1;
+};
@@ -0,0 +1,8 @@
+struct SObject
+{
+    mat4 WorldMatrix;
+    // material index, draw bucket index, first meshlet of the draw bucket, first object of the draw bucket
+    ivec4 InstanceParameter;
+    vec4 PositionScale;
+    vec4 PositionOffset;
+};
@@ -20,11 +20,7 @@ layout (binding = 2, std430) readonly buffer GpuGlobalLights
     SGpuGlobalLight Lights[];
 } globalLights;
 
-struct SObject
-{
-    mat4 WorldMatrix;
-    ivec4 InstanceParameter;
-};
+#include "Include/Object.glsl"
 
 layout (binding = 3, std430) restrict readonly buffer ObjectsBuffer
 {
@@ -11,18 +11,7 @@ layout (location = 2) flat in uint v_material_id;
 layout (location = 0) out vec4 o_color;
 layout (location = 1) out vec4 o_normal;
 
-struct SGpuMaterial
-{
-    vec4 base_color;
-
-    uint64_t base_texture_handle;
-    uint64_t normal_texture_handle;
-    uint64_t occlusion_texture_handle;
-    uint64_t metallic_roughness_texture_handle;
-
-    uint64_t emissive_texture_handle;
-    uint64_t _padding1;
-};
+#include "Include/Material.glsl"
 
 layout (binding = 3, std430) readonly buffer GpuMaterialBuffer
 {
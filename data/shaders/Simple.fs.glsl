@@ -4,25 +4,27 @@
 #extension GL_NV_gpu_shader5 : require
 #extension GL_ARB_gpu_shader_int64 : require
 
+// specialized per combination of texture slots a material uses, HAS_BASE_TEXTURE, HAS_NORMAL_TEXTURE,
+// HAS_OCCLUSION_TEXTURE, HAS_METALLIC_ROUGHNESS_TEXTURE and HAS_EMISSIVE_TEXTURE are defined by the renderer.
+// handles of slots a permutation leaves out are never touched
+
 layout (location = 0) in vec3 v_normal;
 layout (location = 1) in vec2 v_uv;
 layout (location = 2) flat in uint v_material_id;
+layout (location = 3) in vec3 v_position;
 
 layout (location = 0) out vec4 o_color;
 layout (location = 1) out vec4 o_normal;
 
-struct SGpuMaterial
+layout (binding = 0, std140) uniform CameraInformation
 {
-    vec4 base_color;
-
-    uint64_t base_texture_handle;
-    uint64_t normal_texture_handle;
-    uint64_t occlusion_texture_handle;
-    uint64_t metallic_roughness_texture_handle;
+    mat4 ProjectionMatrix;
+    mat4 ViewMatrix;
+    vec4 CameraPosition;
+    vec4 FrustumPlanes[6];
+} u_camera_information;
 
-    uint64_t emissive_texture_handle;
-    uint64_t _padding1;
-};
+#include "Include/Material.glsl"
 
 layout (binding = 4, std430) readonly buffer GpuMaterialBuffer
 {
@@ -35,12 +37,76 @@ layout (binding = 5, std140) uniform ShadingBuffer
     vec4 SunStrength;
 };
 
+// light reaching everything from everywhere, what occlusion textures darken
+const float k_ambient_strength = 0.05;
+
+#ifdef HAS_NORMAL_TEXTURE
+// there are no tangents in the vertex format, the tangent frame comes from screen space derivatives of position and uv
+mat3 GetCotangentFrame(vec3 normal, vec3 position, vec2 uv)
+{
+    vec3 dp1 = dFdx(position);
+    vec3 dp2 = dFdy(position);
+    vec2 duv1 = dFdx(uv);
+    vec2 duv2 = dFdy(uv);
+
+    vec3 dp2perp = cross(dp2, normal);
+    vec3 dp1perp = cross(normal, dp1);
+    vec3 tangent = dp2perp * duv1.x + dp1perp * duv2.x;
+    vec3 bitangent = dp2perp * duv1.y + dp1perp * duv2.y;
+
+    float inverse_scale = inversesqrt(max(max(dot(tangent, tangent), dot(bitangent, bitangent)), 1e-12));
+    return mat3(tangent * inverse_scale, bitangent * inverse_scale, normal);
+}
+#endif
+
 void main()
 {
     SGpuMaterial material = GpuMaterials[v_material_id];
-    
-    float sun_n_dot_l = clamp(dot(v_normal, -SunDirection.xyz), 0.0, 1.0);
 
-    o_color = texture(sampler2D(material.base_texture_handle), v_uv) * vec4(SunStrength.rgb * sun_n_dot_l, 1.0);
-    o_normal = vec4(v_normal * 0.5 + 0.5, 1.0);
-}
\ No newline at end of file
+    vec4 base_color = material.base_color;
+#ifdef HAS_BASE_TEXTURE
+    base_color *= texture(sampler2D(material.base_texture_handle), v_uv);
+#endif
+
+    vec3 normal = normalize(v_normal);
+#ifdef HAS_NORMAL_TEXTURE
+    vec3 tangent_normal = texture(sampler2D(material.normal_texture_handle), v_uv).xyz * 2.0 - 1.0;
+    normal = normalize(GetCotangentFrame(normal, v_position, v_uv) * tangent_normal);
+#endif
+
+    float occlusion = 1.0;
+#ifdef HAS_OCCLUSION_TEXTURE
+    occlusion = texture(sampler2D(material.occlusion_texture_handle), v_uv).r;
+#endif
+
+    vec3 light_direction = -SunDirection.xyz;
+    float sun_n_dot_l = clamp(dot(normal, light_direction), 0.0, 1.0);
+
+    vec3 diffuse_color = base_color.rgb;
+    vec3 specular = vec3(0.0);
+#ifdef HAS_METALLIC_ROUGHNESS_TEXTURE
+    // roughness lives in green, metalness in blue
+    vec2 roughness_metallic = texture(sampler2D(material.metallic_roughness_texture_handle), v_uv).gb;
+    float alpha = max(roughness_metallic.x * roughness_metallic.x, 0.02);
+    float metallic = roughness_metallic.y;
+
+    // normalized blinn-phong with the exponent matching the ggx alpha
+    vec3 view_direction = normalize(u_camera_information.CameraPosition.xyz - v_position);
+    vec3 half_direction = normalize(light_direction + view_direction);
+    float shininess = 2.0 / (alpha * alpha) - 2.0;
+    float n_dot_h = clamp(dot(normal, half_direction), 0.0, 1.0);
+
+    vec3 f0 = mix(vec3(0.04), base_color.rgb, metallic);
+    specular = f0 * pow(n_dot_h, shininess) * (shininess + 8.0) / 8.0 * sun_n_dot_l;
+    diffuse_color *= 1.0 - metallic;
+#endif
+
+    vec3 color = (diffuse_color * (sun_n_dot_l + k_ambient_strength * occlusion) + specular) * SunStrength.rgb;
+
+#ifdef HAS_EMISSIVE_TEXTURE
+    color += texture(sampler2D(material.emissive_texture_handle), v_uv).rgb;
+#endif
+
+    o_color = vec4(color, base_color.a);
+    o_normal = vec4(normal * 0.5 + 0.5, 1.0);
+}
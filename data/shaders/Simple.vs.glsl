@@ -7,6 +7,7 @@ layout (location = 0) out gl_PerVertex
 layout (location = 0) out vec3 v_normal;
 layout (location = 1) out vec2 v_uv;
 layout (location = 2) flat out uint v_material_id;
+layout (location = 3) out vec3 v_position;
 
 layout (location = 0, std140) uniform CameraInformation
 {
@@ -17,71 +18,13 @@ layout (location = 0, std140) uniform CameraInformation
     mat4 ViewMatrix;
     //mat4 view_projection_matrix;
     vec4 CameraPosition;
-    //vec4 frustum_planes[6];
+    vec4 FrustumPlanes[6];
     //vec4 viewport;
 } u_camera_information;
 
-struct SPackedVec2
-{
-    float x;
-    float y;
-};
-
-struct SPackedVec3
-{
-    float x;
-    float y;
-    float z;
-};
-
-struct SPackedVec4
-{
-    float x;
-    float y;
-    float z;
-    float w;
-};
-
-vec2 PackedToVec2(in SPackedVec2 v)
-{
-    return vec2(v.x, v.y);
-}
-
-SPackedVec2 Vec2ToPacked(in vec2 v)
-{
-    return SPackedVec2(v.x, v.y);
-}
-
-vec3 PackedToVec3(in SPackedVec3 v)
-{
-    return vec3(v.x, v.y, v.z);
-}
+#include "Include/PackedTypes.glsl"
 
-SPackedVec3 Vec3ToPacked(in vec3 v)
-{
-    return SPackedVec3(v.x, v.y, v.z);
-}
-
-vec4 PackedToVec4(in SPackedVec4 v)
-{
-    return vec4(v.x, v.y, v.z, v.w);
-}
-
-SPackedVec4 Vec4ToPacked(in vec4 v)
-{
-    return SPackedVec4(v.x, v.y, v.z, v.w);
-}
-
-struct SVertexPosition
-{
-    SPackedVec3 Position;
-};
-
-struct SVertexNormalUv
-{
-    uint Normal;
-    SPackedVec2 Uv;
-};
+#pragma vertex_format
 
 layout(binding = 1, std430) restrict readonly buffer VertexPositionBuffer
 {
@@ -93,11 +36,7 @@ layout(binding = 2, std430) restrict readonly buffer VertexNormalUvBuffer
     SVertexNormalUv VertexNormalUvs[];
 };
 
-struct SObject
-{
-    mat4 WorldMatrix;
-    ivec4 InstanceParameter;
-};
+#include "Include/Object.glsl"
 
 layout (binding = 3, std430) restrict readonly buffer ObjectsBuffer
 {
@@ -123,14 +62,24 @@ void main()
 {
     SVertexPosition vertex_position = VertexPositions[gl_VertexID];
     SVertexNormalUv vertex_normal_uv = VertexNormalUvs[gl_VertexID];
-    SObject object = Objects[gl_DrawID];
-
-    v_normal = DecodeNormal(unpackSnorm2x16(vertex_normal_uv.Normal));
-    v_uv = PackedToVec2(vertex_normal_uv.Uv);
+    SObject object = Objects[gl_BaseInstance];
+
+    vec4 world_position = object.WorldMatrix * vec4(DecodePosition(vertex_position, object.PositionScale.xyz, object.PositionOffset.xyz), 1.0);
+
+    // normals and positions are shaded in world space. normals transform with the inverse-transpose, here the
+    // cofactor matrix with the sign of the determinant taken out, it holds up under non-uniform scale and shear
+    mat3 world_matrix = mat3(object.WorldMatrix);
+    mat3 cofactor_matrix = mat3(
+        cross(world_matrix[1], world_matrix[2]),
+        cross(world_matrix[2], world_matrix[0]),
+        cross(world_matrix[0], world_matrix[1]));
+    float determinant_sign = dot(world_matrix[0], cofactor_matrix[0]) < 0.0 ? -1.0 : 1.0;
+    v_normal = normalize(cofactor_matrix * DecodeNormal(unpackSnorm2x16(vertex_normal_uv.Normal)) * determinant_sign);
+    v_uv = DecodeUv(vertex_normal_uv);
     v_material_id = object.InstanceParameter.x;
+    v_position = world_position.xyz;
 
     gl_Position = u_camera_information.ProjectionMatrix *
                   u_camera_information.ViewMatrix *
-                  object.WorldMatrix * 
-                  vec4(PackedToVec3(vertex_position.Position), 1.0);
+                  world_position;
 }
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+// Lock-free queue for many producers and a single consumer. Producers push with a compare exchange on the head
+// of a singly linked list, the consumer takes the whole list in one exchange and restores the order of the pushes
+template <typename T>
+struct SCompletionQueue {
+
+    struct SNode {
+        T Value;
+        SNode* Next = nullptr;
+    };
+
+    std::atomic<SNode*> Head = nullptr;
+
+    SCompletionQueue() = default;
+    SCompletionQueue(const SCompletionQueue&) = delete;
+    auto operator=(const SCompletionQueue&) -> SCompletionQueue& = delete;
+
+    ~SCompletionQueue() {
+        PopAll();
+    }
+
+    auto Push(T&& value) -> void {
+        auto* node = new SNode{ .Value = std::move(value), .Next = Head.load(std::memory_order_relaxed) };
+        while (!Head.compare_exchange_weak(node->Next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    auto PopAll() -> std::vector<T> {
+
+        auto* node = Head.exchange(nullptr, std::memory_order_acquire);
+
+        std::vector<T> values;
+        while (node != nullptr) {
+            auto* nextNode = node->Next;
+            values.push_back(std::move(node->Value));
+            delete node;
+            node = nextNode;
+        }
+
+        std::reverse(values.begin(), values.end());
+        return values;
+    }
+};
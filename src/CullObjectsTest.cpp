@@ -0,0 +1,453 @@
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "FrustumCulling.hpp"
+#include "Model.hpp"
+#include "ShaderCompiler.hpp"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <glad/gl.h>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Runs CullObjects.cs over a seeded scene in a headless context and checks its lods, draw counts and draw commands
+// against CullBounds and SelectLod, the cpu path of the renderer, and the seen bits against the materials and models
+// of the objects in view. Objects close enough to a plane or a lod threshold
+// for rounding to decide are left out of the scene, everything else has to match exactly.
+// Runs on llvmpipe with LIBGL_ALWAYS_SOFTWARE=1, from the directory data was copied to
+
+// layouts as Main.cpp uploads them
+struct SGlobalUniforms {
+    glm::mat4 ProjectionMatrix;
+    glm::mat4 ViewMatrix;
+    glm::vec4 CameraPosition;
+    glm::vec4 FrustumPlanes[6];
+};
+
+struct SObject {
+    glm::mat4 WorldMatrix;
+    glm::ivec4 InstanceParameter;
+    glm::vec4 PositionScale;
+    glm::vec4 PositionOffset;
+};
+
+struct SGpuCullObject {
+    glm::vec4 CenterRadius;
+    glm::vec3 Extent;
+    uint32_t FirstLod;
+    uint32_t LodCount;
+    int32_t BaseVertex;
+    uint32_t HasMeshlets;
+    uint32_t ModelIndex;
+};
+
+struct SGpuPooledPrimitive {
+    uint32_t IndexCount;
+    uint32_t InstanceCount;
+    uint32_t FirstIndex;
+    int32_t BaseVertex;
+    uint32_t BaseInstance;
+};
+
+struct SCullingScene {
+    SGlobalUniforms GlobalUniforms;
+    std::array<glm::vec4, 6> FrustumPlanes;
+    float ProjectionScale;
+    std::vector<SObject> Objects;
+    std::vector<SGpuCullObject> CullObjects;
+    std::vector<SPrimitiveLod> Lods;
+    // first object of every draw bucket, the last entry is the object count
+    std::vector<uint32_t> DrawBucketOffsets;
+};
+
+struct SCullingOptions {
+    bool IsFrustumCullingEnabled;
+    bool IsLodSelectionEnabled;
+    bool IsMeshletCullingEnabled;
+};
+
+constexpr uint32_t g_objectCount = 2000;
+constexpr uint32_t g_drawBucketCount = 5;
+constexpr uint32_t g_materialCount = 1000;
+constexpr uint32_t g_modelCount = 300;
+constexpr uint32_t g_seenModelFirstWord = (g_materialCount + 31) / 32;
+constexpr uint32_t g_seenWordCount = g_seenModelFirstWord + (g_modelCount + 31) / 32;
+constexpr float g_lodErrorThreshold = 1.0f;
+constexpr uint32_t g_objectLodCulled = 0xFFFFFFFF;
+// relative distance to a plane or lod threshold below which the gpu may round the other way
+constexpr float g_decisionMargin = 1e-3f;
+
+auto CreateHeadlessContext() -> bool {
+
+    auto eglGetPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    auto display = eglGetPlatformDisplay != nullptr
+        ? eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+        : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr) || !eglBindAPI(EGL_OPENGL_API)) {
+        std::printf("EGL: no display\n");
+        return false;
+    }
+
+    // llvmpipe stops at 4.5
+    auto context = EGL_NO_CONTEXT;
+    for (const auto minorVersion : { 6, 5 }) {
+        const std::array<EGLint, 7> contextAttributes = {
+            EGL_CONTEXT_MAJOR_VERSION, 4,
+            EGL_CONTEXT_MINOR_VERSION, minorVersion,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttributes.data());
+        if (context != EGL_NO_CONTEXT) {
+            break;
+        }
+    }
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::printf("EGL: no 4.5 core context without a surface\n");
+        return false;
+    }
+
+    if (!gladLoadGL(reinterpret_cast<GLADloadfunc>(eglGetProcAddress))) {
+        std::printf("glad: failed to load GL\n");
+        return false;
+    }
+
+    std::printf("%s, %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+    return true;
+}
+
+auto CreateCullObjectsProgram() -> uint32_t {
+
+    auto preprocessedShader = PreprocessShader("data/shaders/CullObjects.cs.glsl", {});
+    if (!preprocessedShader) {
+        std::printf("%s\n", preprocessedShader.error().c_str());
+        return 0;
+    }
+
+    const auto* source = preprocessedShader->Source.c_str();
+    const auto program = glCreateShaderProgramv(GL_COMPUTE_SHADER, 1, &source);
+
+    auto linkStatus = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE) {
+        std::array<char, 4096> log = {};
+        glGetProgramInfoLog(program, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        std::printf("CullObjects.cs.glsl: %s\n", MapShaderLog(log.data(), preprocessedShader->FilePaths).c_str());
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+// whether the object is close enough to a plane or a lod threshold for float rounding to decide which side it
+// ends up on, the gpu and the cpu may round differently there so such objects are left out of the scene
+auto IsNearDecision(
+    const SCullingScene& scene,
+    const SObject& object,
+    const SGpuCullObject& cullObject,
+    std::span<const SPrimitiveLod> lods) -> bool {
+
+    const auto& worldMatrix = object.WorldMatrix;
+    const auto center = glm::vec3(worldMatrix * glm::vec4(glm::vec3(cullObject.CenterRadius), 1.0f));
+    const auto extent =
+        glm::abs(glm::vec3(worldMatrix[0])) * cullObject.Extent.x +
+        glm::abs(glm::vec3(worldMatrix[1])) * cullObject.Extent.y +
+        glm::abs(glm::vec3(worldMatrix[2])) * cullObject.Extent.z;
+    for (const auto& frustumPlane : scene.FrustumPlanes) {
+        const auto distance = glm::dot(glm::vec3(frustumPlane), center) + frustumPlane.w;
+        const auto radius = glm::dot(glm::abs(glm::vec3(frustumPlane)), extent);
+        if (glm::abs(distance + radius) < g_decisionMargin * (glm::abs(distance) + radius + 1.0f)) {
+            return true;
+        }
+    }
+
+    const auto worldScale = glm::max(
+        glm::length(glm::vec3(worldMatrix[0])),
+        glm::max(glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2]))));
+    const auto cameraDistance = glm::distance(center, glm::vec3(scene.GlobalUniforms.CameraPosition)) - cullObject.CenterRadius.w * worldScale;
+    if (cameraDistance < 0.2f) {
+        return true;
+    }
+    for (const auto& lod : lods) {
+        const auto projectedError = lod.Error * worldScale / cameraDistance * scene.ProjectionScale;
+        if (glm::abs(projectedError - g_lodErrorThreshold) < g_decisionMargin * g_lodErrorThreshold) {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto CreateCullingScene() -> SCullingScene {
+
+    SCullingScene scene = {};
+
+    const auto cameraPosition = glm::vec3(0.0f, 2.0f, 0.0f);
+    scene.GlobalUniforms.ProjectionMatrix = glm::perspectiveFovRH_ZO(glm::radians(60.0f), 1280.0f, 720.0f, 0.1f, 1024.0f);
+    scene.GlobalUniforms.ViewMatrix = glm::lookAt(cameraPosition, glm::vec3(10.0f, 0.0f, -40.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    scene.GlobalUniforms.CameraPosition = glm::vec4(cameraPosition, 0.0f);
+    scene.FrustumPlanes = GetFrustumPlanes(scene.GlobalUniforms.ProjectionMatrix * scene.GlobalUniforms.ViewMatrix);
+    std::copy(scene.FrustumPlanes.begin(), scene.FrustumPlanes.end(), scene.GlobalUniforms.FrustumPlanes);
+    scene.ProjectionScale = 720.0f / (2.0f * glm::tan(glm::radians(60.0f) * 0.5f));
+
+    auto random = std::mt19937(1337);
+    auto uniform = [&](float minimum, float maximum) {
+        return std::uniform_real_distribution<float>(minimum, maximum)(random);
+    };
+
+    std::vector<SPrimitiveLod> lods;
+    while (scene.Objects.size() < g_objectCount) {
+
+        const auto drawBucketIndex = static_cast<uint32_t>(scene.Objects.size() * g_drawBucketCount / g_objectCount);
+        if (drawBucketIndex == scene.DrawBucketOffsets.size()) {
+            scene.DrawBucketOffsets.push_back(static_cast<uint32_t>(scene.Objects.size()));
+        }
+
+        // scaled unevenly and turned, so boxes and spheres grow in world space
+        const auto rotationAxis = glm::normalize(glm::vec3(uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(0.1f, 1.0f)));
+        auto worldMatrix = glm::translate(glm::mat4(1.0f), glm::vec3(uniform(-80.0f, 80.0f), uniform(-20.0f, 20.0f), uniform(-160.0f, 40.0f)));
+        worldMatrix = glm::rotate(worldMatrix, uniform(0.0f, 6.28f), rotationAxis);
+        worldMatrix = glm::scale(worldMatrix, glm::vec3(uniform(0.25f, 3.0f), uniform(0.25f, 3.0f), uniform(0.25f, 3.0f)));
+
+        const auto extent = glm::vec3(uniform(0.1f, 2.0f), uniform(0.1f, 2.0f), uniform(0.1f, 2.0f));
+        const auto lodCount = static_cast<uint32_t>(random() % 5) + 1;
+        lods.clear();
+        auto indexCount = 3u * (static_cast<uint32_t>(random() % 4096) + 64);
+        auto error = 0.0f;
+        for (auto lodIndex = 0u; lodIndex < lodCount; lodIndex++) {
+            lods.push_back(SPrimitiveLod{
+                .IndexOffset = static_cast<uint32_t>(random() % 1000000),
+                .IndexCount = indexCount,
+                .Error = error
+            });
+            indexCount = std::max(indexCount / 6 * 3, 3u);
+            error += uniform(0.001f, 0.1f);
+        }
+
+        const auto object = SObject{
+            .WorldMatrix = worldMatrix,
+            .InstanceParameter = glm::ivec4(random() % g_materialCount, drawBucketIndex, 0, scene.DrawBucketOffsets[drawBucketIndex]),
+            .PositionScale = glm::vec4(1.0f),
+            .PositionOffset = glm::vec4(0.0f)
+        };
+        const auto cullObject = SGpuCullObject{
+            .CenterRadius = glm::vec4(uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), glm::length(extent)),
+            .Extent = extent,
+            .FirstLod = static_cast<uint32_t>(scene.Lods.size()),
+            .LodCount = lodCount,
+            .BaseVertex = static_cast<int32_t>(random() % 100000),
+            .HasMeshlets = static_cast<uint32_t>(random() % 2),
+            .ModelIndex = static_cast<uint32_t>(random() % g_modelCount)
+        };
+        if (IsNearDecision(scene, object, cullObject, lods)) {
+            continue;
+        }
+
+        scene.Objects.push_back(object);
+        scene.CullObjects.push_back(cullObject);
+        scene.Lods.insert(scene.Lods.end(), lods.begin(), lods.end());
+    }
+    scene.DrawBucketOffsets.push_back(g_objectCount);
+
+    return scene;
+}
+
+auto CreateBuffer(std::span<const std::byte> data) -> uint32_t {
+
+    uint32_t buffer = 0;
+    glCreateBuffers(1, &buffer);
+    glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(data.size()), data.data(), GL_DYNAMIC_STORAGE_BIT);
+    return buffer;
+}
+
+// returns the number of mismatches
+auto TestCullObjects(
+    const uint32_t program,
+    const SCullingScene& scene,
+    const SCullingOptions& options) -> uint32_t {
+
+    std::printf("frustum culling %d, lod selection %d, meshlet culling %d: ",
+        options.IsFrustumCullingEnabled, options.IsLodSelectionEnabled, options.IsMeshletCullingEnabled);
+
+    // cpu path
+    SCullingBounds cullingBounds;
+    ResizeCullingBounds(cullingBounds, g_objectCount);
+    for (auto objectIndex = 0u; objectIndex < g_objectCount; objectIndex++) {
+        const auto& cullObject = scene.CullObjects[objectIndex];
+        SetCullingBounds(cullingBounds, objectIndex, scene.Objects[objectIndex].WorldMatrix, glm::vec3(cullObject.CenterRadius), cullObject.Extent);
+    }
+    std::vector<uint8_t> objectVisibilities(g_objectCount, 1);
+    if (options.IsFrustumCullingEnabled) {
+        CullBounds(cullingBounds, scene.FrustumPlanes, objectVisibilities);
+    }
+
+    std::vector<uint32_t> expectedObjectLods(g_objectCount);
+    std::array<uint32_t, g_seenWordCount> expectedSeenBits = {};
+    std::vector<std::vector<SGpuPooledPrimitive>> expectedDrawCommands(g_drawBucketCount);
+    for (auto drawBucketIndex = 0u; drawBucketIndex < g_drawBucketCount; drawBucketIndex++) {
+        for (auto objectIndex = scene.DrawBucketOffsets[drawBucketIndex]; objectIndex < scene.DrawBucketOffsets[drawBucketIndex + 1]; objectIndex++) {
+
+            if (objectVisibilities[objectIndex] == 0) {
+                expectedObjectLods[objectIndex] = g_objectLodCulled;
+                continue;
+            }
+
+            const auto& cullObject = scene.CullObjects[objectIndex];
+            const auto materialIndex = static_cast<uint32_t>(scene.Objects[objectIndex].InstanceParameter.x);
+            expectedSeenBits[materialIndex / 32] |= 1u << (materialIndex % 32);
+            expectedSeenBits[g_seenModelFirstWord + cullObject.ModelIndex / 32] |= 1u << (cullObject.ModelIndex % 32);
+
+            const auto lods = std::span(scene.Lods).subspan(cullObject.FirstLod, cullObject.LodCount);
+            const auto lodIndex = options.IsLodSelectionEnabled
+                ? SelectLod(lods, glm::vec3(cullObject.CenterRadius), cullObject.CenterRadius.w, scene.Objects[objectIndex].WorldMatrix,
+                    glm::vec3(scene.GlobalUniforms.CameraPosition), scene.ProjectionScale, g_lodErrorThreshold)
+                : 0u;
+            expectedObjectLods[objectIndex] = lodIndex;
+            if (options.IsMeshletCullingEnabled && lodIndex == 0 && cullObject.HasMeshlets != 0) {
+                continue;
+            }
+
+            expectedDrawCommands[drawBucketIndex].push_back(SGpuPooledPrimitive{
+                .IndexCount = lods[lodIndex].IndexCount,
+                .InstanceCount = 1,
+                .FirstIndex = lods[lodIndex].IndexOffset,
+                .BaseVertex = cullObject.BaseVertex,
+                .BaseInstance = objectIndex
+            });
+        }
+    }
+
+    // gpu path
+    const auto globalUniformsBuffer = CreateBuffer(std::as_bytes(std::span(&scene.GlobalUniforms, 1)));
+    const auto objectBuffer = CreateBuffer(std::as_bytes(std::span(scene.Objects)));
+    const auto cullObjectBuffer = CreateBuffer(std::as_bytes(std::span(scene.CullObjects)));
+    const auto primitiveLodBuffer = CreateBuffer(std::as_bytes(std::span(scene.Lods)));
+    const std::vector<uint32_t> initialObjectLods(g_objectCount, 0xDEADBEEF);
+    const auto objectLodBuffer = CreateBuffer(std::as_bytes(std::span(initialObjectLods)));
+    const std::vector<SGpuPooledPrimitive> initialDrawCommands(g_objectCount);
+    const auto objectIndirectBuffer = CreateBuffer(std::as_bytes(std::span(initialDrawCommands)));
+    const std::array<uint32_t, g_drawBucketCount> initialDrawCounts = {};
+    const auto objectIndirectCountBuffer = CreateBuffer(std::as_bytes(std::span(initialDrawCounts)));
+    const std::array<uint32_t, g_seenWordCount> initialSeenBits = {};
+    const auto seenBuffer = CreateBuffer(std::as_bytes(std::span(initialSeenBits)));
+
+    glUseProgram(program);
+    glProgramUniform1ui(program, 0, g_objectCount);
+    glProgramUniform1f(program, 1, scene.ProjectionScale);
+    glProgramUniform1f(program, 2, g_lodErrorThreshold);
+    glProgramUniform1i(program, 3, options.IsLodSelectionEnabled ? 1 : 0);
+    glProgramUniform1i(program, 4, options.IsFrustumCullingEnabled ? 1 : 0);
+    glProgramUniform1i(program, 5, options.IsMeshletCullingEnabled ? 1 : 0);
+    glProgramUniform1ui(program, 6, g_seenModelFirstWord);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, globalUniformsBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, objectBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, objectLodBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, cullObjectBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, primitiveLodBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 12, objectIndirectBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, objectIndirectCountBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 14, seenBuffer);
+    glDispatchCompute((g_objectCount + 63) / 64, 1, 1);
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    std::vector<uint32_t> objectLods(g_objectCount);
+    glGetNamedBufferSubData(objectLodBuffer, 0, sizeof(uint32_t) * objectLods.size(), objectLods.data());
+    std::vector<SGpuPooledPrimitive> drawCommands(g_objectCount);
+    glGetNamedBufferSubData(objectIndirectBuffer, 0, sizeof(SGpuPooledPrimitive) * drawCommands.size(), drawCommands.data());
+    std::array<uint32_t, g_drawBucketCount> drawCounts = {};
+    glGetNamedBufferSubData(objectIndirectCountBuffer, 0, sizeof(uint32_t) * drawCounts.size(), drawCounts.data());
+    std::array<uint32_t, g_seenWordCount> seenBits = {};
+    glGetNamedBufferSubData(seenBuffer, 0, sizeof(uint32_t) * seenBits.size(), seenBits.data());
+
+    for (const auto buffer : { globalUniformsBuffer, objectBuffer, cullObjectBuffer, primitiveLodBuffer, objectLodBuffer, objectIndirectBuffer, objectIndirectCountBuffer, seenBuffer }) {
+        glDeleteBuffers(1, &buffer);
+    }
+
+    auto mismatchCount = 0u;
+    auto visibleCount = 0u;
+    for (auto objectIndex = 0u; objectIndex < g_objectCount; objectIndex++) {
+        visibleCount += expectedObjectLods[objectIndex] != g_objectLodCulled ? 1 : 0;
+        if (objectLods[objectIndex] != expectedObjectLods[objectIndex]) {
+            if (mismatchCount++ < 8) {
+                std::printf("\n  object %u: lod %u, expected %u", objectIndex, objectLods[objectIndex], expectedObjectLods[objectIndex]);
+            }
+        }
+    }
+
+    for (auto wordIndex = 0u; wordIndex < g_seenWordCount; wordIndex++) {
+        if (seenBits[wordIndex] != expectedSeenBits[wordIndex]) {
+            std::printf("\n  seen bits %u: %08x, expected %08x", wordIndex, seenBits[wordIndex], expectedSeenBits[wordIndex]);
+            mismatchCount++;
+        }
+    }
+
+    // the order within a bucket depends on the atomics, commands are compared by object
+    auto drawCommandCount = 0u;
+    for (auto drawBucketIndex = 0u; drawBucketIndex < g_drawBucketCount; drawBucketIndex++) {
+
+        const auto& expectedBucketDrawCommands = expectedDrawCommands[drawBucketIndex];
+        drawCommandCount += static_cast<uint32_t>(expectedBucketDrawCommands.size());
+        if (drawCounts[drawBucketIndex] != expectedBucketDrawCommands.size()) {
+            std::printf("\n  draw bucket %u: %u commands, expected %zu", drawBucketIndex, drawCounts[drawBucketIndex], expectedBucketDrawCommands.size());
+            mismatchCount++;
+            continue;
+        }
+
+        auto bucketDrawCommands = std::span(drawCommands).subspan(scene.DrawBucketOffsets[drawBucketIndex], drawCounts[drawBucketIndex]);
+        std::ranges::sort(bucketDrawCommands, {}, &SGpuPooledPrimitive::BaseInstance);
+        for (auto drawIndex = 0u; drawIndex < bucketDrawCommands.size(); drawIndex++) {
+            const auto& drawCommand = bucketDrawCommands[drawIndex];
+            const auto& expectedDrawCommand = expectedBucketDrawCommands[drawIndex];
+            if (drawCommand.IndexCount != expectedDrawCommand.IndexCount ||
+                drawCommand.InstanceCount != expectedDrawCommand.InstanceCount ||
+                drawCommand.FirstIndex != expectedDrawCommand.FirstIndex ||
+                drawCommand.BaseVertex != expectedDrawCommand.BaseVertex ||
+                drawCommand.BaseInstance != expectedDrawCommand.BaseInstance) {
+                if (mismatchCount++ < 8) {
+                    std::printf("\n  draw bucket %u: command of object %u differs from the one of object %u",
+                        drawBucketIndex, drawCommand.BaseInstance, expectedDrawCommand.BaseInstance);
+                }
+            }
+        }
+    }
+
+    if (mismatchCount == 0) {
+        std::printf("%u of %u visible, %u draw commands, ok\n", visibleCount, g_objectCount, drawCommandCount);
+    } else {
+        std::printf("\n  %u mismatches\n", mismatchCount);
+    }
+    return mismatchCount;
+}
+
+auto main() -> int {
+
+    if (!CreateHeadlessContext()) {
+        return 1;
+    }
+
+    const auto program = CreateCullObjectsProgram();
+    if (program == 0) {
+        return 1;
+    }
+
+    const auto scene = CreateCullingScene();
+
+    auto mismatchCount = 0u;
+    for (const auto& options : {
+        SCullingOptions{ .IsFrustumCullingEnabled = true, .IsLodSelectionEnabled = true, .IsMeshletCullingEnabled = true },
+        SCullingOptions{ .IsFrustumCullingEnabled = true, .IsLodSelectionEnabled = true, .IsMeshletCullingEnabled = false },
+        SCullingOptions{ .IsFrustumCullingEnabled = true, .IsLodSelectionEnabled = false, .IsMeshletCullingEnabled = false },
+        SCullingOptions{ .IsFrustumCullingEnabled = false, .IsLodSelectionEnabled = true, .IsMeshletCullingEnabled = false } }) {
+        mismatchCount += TestCullObjects(program, scene, options);
+    }
+
+    glDeleteProgram(program);
+    return mismatchCount == 0 ? 0 : 1;
+}
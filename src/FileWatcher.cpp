@@ -0,0 +1,185 @@
+#include "FileWatcher.hpp"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__linux__)
+  #include <cerrno>
+  #include <poll.h>
+  #include <sys/inotify.h>
+  #include <unistd.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
+using SClock = std::chrono::steady_clock;
+
+struct SWatchedFile {
+    // compared by the polling fallback only
+    std::filesystem::file_time_type LastWriteTime;
+};
+
+std::mutex g_fileWatcherMutex;
+// keyed by path strings, std::hash of paths is not there everywhere yet
+std::unordered_map<std::string, SWatchedFile> g_watchedFiles;
+// last time a change of the file was seen
+std::unordered_map<std::string, SClock::time_point> g_changedFiles;
+std::atomic<bool> g_isFileWatcherRunning = false;
+std::thread g_fileWatcherThread;
+
+#if defined(__linux__)
+int32_t g_inotify = -1;
+std::unordered_map<int32_t, std::filesystem::path> g_watchDescriptorToDirectoryMap;
+std::unordered_map<std::string, int32_t> g_directoryToWatchDescriptorMap;
+#endif
+
+auto GetWatchedFilePath(const std::filesystem::path& filePath) -> std::filesystem::path {
+
+    std::error_code errorCode;
+    auto watchedFilePath = std::filesystem::weakly_canonical(filePath, errorCode);
+    return errorCode ? filePath.lexically_normal() : watchedFilePath;
+}
+
+#if defined(__linux__)
+auto ReadFileWatcherEvents() -> void {
+
+    // events are variable in size, the buffer is aligned for the header of the first one
+    alignas(inotify_event) std::array<char, 16 * 1024> eventBuffer;
+
+    while (g_isFileWatcherRunning) {
+
+        pollfd pollDescriptor = { .fd = g_inotify, .events = POLLIN, .revents = 0 };
+        if (poll(&pollDescriptor, 1, 100) <= 0) {
+            continue;
+        }
+
+        const auto readSize = read(g_inotify, eventBuffer.data(), eventBuffer.size());
+        if (readSize <= 0) {
+            continue;
+        }
+
+        const auto now = SClock::now();
+        std::scoped_lock lock(g_fileWatcherMutex);
+        for (auto eventOffset = ssize_t{0}; eventOffset < readSize;) {
+
+            const auto* event = reinterpret_cast<const inotify_event*>(eventBuffer.data() + eventOffset);
+            eventOffset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            auto directory = g_watchDescriptorToDirectoryMap.find(event->wd);
+            if (directory == g_watchDescriptorToDirectoryMap.end() || event->len == 0) {
+                continue;
+            }
+
+            auto filePath = (directory->second / event->name).string();
+            if (g_watchedFiles.contains(filePath)) {
+                g_changedFiles[std::move(filePath)] = now;
+            }
+        }
+    }
+}
+#else
+auto ReadFileWatcherEvents() -> void {
+
+    while (g_isFileWatcherRunning) {
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+        const auto now = SClock::now();
+        std::scoped_lock lock(g_fileWatcherMutex);
+        for (auto& [filePath, watchedFile] : g_watchedFiles) {
+            std::error_code errorCode;
+            const auto lastWriteTime = std::filesystem::last_write_time(filePath, errorCode);
+            if (!errorCode && lastWriteTime != watchedFile.LastWriteTime) {
+                watchedFile.LastWriteTime = lastWriteTime;
+                g_changedFiles[filePath] = now;
+            }
+        }
+    }
+}
+#endif
+
+auto CreateFileWatcher() -> bool {
+
+#if defined(__linux__)
+    g_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (g_inotify < 0) {
+        spdlog::error("FileWatcher: unable to initialize inotify ({})", errno);
+        return false;
+    }
+#endif
+
+    g_isFileWatcherRunning = true;
+    g_fileWatcherThread = std::thread(ReadFileWatcherEvents);
+    return true;
+}
+
+auto DestroyFileWatcher() -> void {
+
+    if (!g_isFileWatcherRunning) {
+        return;
+    }
+
+    g_isFileWatcherRunning = false;
+    g_fileWatcherThread.join();
+
+#if defined(__linux__)
+    close(g_inotify);
+    g_inotify = -1;
+    g_watchDescriptorToDirectoryMap.clear();
+    g_directoryToWatchDescriptorMap.clear();
+#endif
+
+    g_watchedFiles.clear();
+    g_changedFiles.clear();
+}
+
+auto WatchFile(const std::filesystem::path& filePath) -> void {
+
+    const auto watchedFilePath = GetWatchedFilePath(filePath);
+
+    std::scoped_lock lock(g_fileWatcherMutex);
+    if (g_watchedFiles.contains(watchedFilePath.string())) {
+        return;
+    }
+
+    std::error_code errorCode;
+    auto lastWriteTime = std::filesystem::last_write_time(watchedFilePath, errorCode);
+
+#if defined(__linux__)
+    auto directory = watchedFilePath.parent_path();
+    if (g_inotify >= 0 && !g_directoryToWatchDescriptorMap.contains(directory.string())) {
+        const auto watchDescriptor = inotify_add_watch(g_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (watchDescriptor < 0) {
+            spdlog::warn("FileWatcher: unable to watch {} ({})", directory.string(), errno);
+        } else {
+            g_watchDescriptorToDirectoryMap[watchDescriptor] = directory;
+            g_directoryToWatchDescriptorMap[directory.string()] = watchDescriptor;
+        }
+    }
+#endif
+
+    g_watchedFiles[watchedFilePath.string()] = SWatchedFile{
+        .LastWriteTime = errorCode ? std::filesystem::file_time_type{} : lastWriteTime
+    };
+}
+
+auto PopChangedFiles(std::chrono::milliseconds settleTime) -> std::vector<std::filesystem::path> {
+
+    const auto now = SClock::now();
+    std::vector<std::filesystem::path> changedFilePaths;
+
+    std::scoped_lock lock(g_fileWatcherMutex);
+    std::erase_if(g_changedFiles, [&](const auto& changedFile) {
+        if (now - changedFile.second < settleTime) {
+            return false;
+        }
+        changedFilePaths.push_back(changedFile.first);
+        return true;
+    });
+
+    return changedFilePaths;
+}
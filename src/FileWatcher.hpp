@@ -0,0 +1,21 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+// Tells which of the watched files were written. On Linux a thread reads inotify events of the directories the
+// files are in, editors tend to replace a file (write a temporary, rename it over) rather than write it in place.
+// Other platforms compare write times of the watched files a few times a second instead
+
+auto CreateFileWatcher() -> bool;
+auto DestroyFileWatcher() -> void;
+
+auto WatchFile(const std::filesystem::path& filePath) -> void;
+
+// watched files written since the last call and left alone for at least settleTime, which is when editors
+// writing in several steps are done. paths are canonical
+auto PopChangedFiles(std::chrono::milliseconds settleTime) -> std::vector<std::filesystem::path>;
+
+// the form paths are compared in, for files which don't exist (yet) as well
+auto GetWatchedFilePath(const std::filesystem::path& filePath) -> std::filesystem::path;
@@ -0,0 +1,265 @@
+#include "FrustumCulling.hpp"
+#include "Model.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <numeric>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_access.hpp>
+
+#include <poolstl/poolstl.hpp>
+
+// the build doesn't ask for AVX2 everywhere, the culling loop is compiled for it on its own and used when the CPU has it
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #include <immintrin.h>
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+  #endif
+  #if defined(__GNUC__) || defined(__clang__)
+    #define TOADWART_TARGET_AVX2 __attribute__((target("avx2")))
+  #else
+    #define TOADWART_TARGET_AVX2
+  #endif
+  #define TOADWART_CULLING_AVX2
+#endif
+
+// boxes culled per task, a multiple of 8
+constexpr uint32_t g_cullingChunkSize = 4096;
+
+auto ResizeCullingBounds(
+    SCullingBounds& cullingBounds,
+    const uint32_t count) -> void {
+
+    const auto paddedCount = (count + 7) & ~7u;
+    for (auto* component : { &cullingBounds.CenterX, &cullingBounds.CenterY, &cullingBounds.CenterZ,
+                             &cullingBounds.ExtentX, &cullingBounds.ExtentY, &cullingBounds.ExtentZ }) {
+        component->resize(paddedCount, 0.0f);
+    }
+}
+
+auto SetCullingBounds(
+    SCullingBounds& cullingBounds,
+    const uint32_t index,
+    const glm::mat4& worldMatrix,
+    const glm::vec3& center,
+    const glm::vec3& extent) -> void {
+
+    // the extent along a world axis is the extents along the object axes projected onto it
+    const auto worldCenter = glm::vec3(worldMatrix * glm::vec4(center, 1.0f));
+    const auto worldExtent =
+        glm::abs(glm::vec3(worldMatrix[0])) * extent.x +
+        glm::abs(glm::vec3(worldMatrix[1])) * extent.y +
+        glm::abs(glm::vec3(worldMatrix[2])) * extent.z;
+
+    cullingBounds.CenterX[index] = worldCenter.x;
+    cullingBounds.CenterY[index] = worldCenter.y;
+    cullingBounds.CenterZ[index] = worldCenter.z;
+    cullingBounds.ExtentX[index] = worldExtent.x;
+    cullingBounds.ExtentY[index] = worldExtent.y;
+    cullingBounds.ExtentZ[index] = worldExtent.z;
+}
+
+auto IsAvx2CullingSupported() -> bool {
+
+#if defined(TOADWART_CULLING_AVX2) && defined(_MSC_VER)
+    static const auto isSupported = []() {
+        std::array<int32_t, 4> cpuInfo = {};
+        __cpuid(cpuInfo.data(), 0);
+        if (cpuInfo[0] < 7) {
+            return false;
+        }
+        __cpuid(cpuInfo.data(), 1);
+        const auto isXsaveEnabled = (cpuInfo[2] & (1 << 27)) != 0;
+        __cpuidex(cpuInfo.data(), 7, 0);
+        const auto hasAvx2 = (cpuInfo[1] & (1 << 5)) != 0;
+        // the OS has to save the ymm registers as well
+        return hasAvx2 && isXsaveEnabled && (_xgetbv(0) & 0x6) == 0x6;
+    }();
+    return isSupported;
+#elif defined(TOADWART_CULLING_AVX2)
+    static const auto isSupported = __builtin_cpu_supports("avx2") != 0;
+    return isSupported;
+#else
+    return false;
+#endif
+}
+
+// a box is outside when it lies entirely behind one of the planes, its center further behind than the box reaches
+auto CullBoundsScalar(
+    const SCullingBounds& cullingBounds,
+    const std::array<glm::vec4, 6>& frustumPlanes,
+    const uint32_t first,
+    std::span<uint8_t> isVisible) -> uint32_t {
+
+    auto visibleCount = 0u;
+    for (auto index = first; index < first + isVisible.size(); index++) {
+
+        auto isInside = true;
+        for (const auto& frustumPlane : frustumPlanes) {
+            const auto distance =
+                frustumPlane.x * cullingBounds.CenterX[index] +
+                frustumPlane.y * cullingBounds.CenterY[index] +
+                frustumPlane.z * cullingBounds.CenterZ[index] +
+                frustumPlane.w;
+            const auto radius =
+                glm::abs(frustumPlane.x) * cullingBounds.ExtentX[index] +
+                glm::abs(frustumPlane.y) * cullingBounds.ExtentY[index] +
+                glm::abs(frustumPlane.z) * cullingBounds.ExtentZ[index];
+            isInside &= distance + radius >= 0.0f;
+        }
+
+        isVisible[index - first] = isInside ? 1 : 0;
+        visibleCount += isInside ? 1 : 0;
+    }
+    return visibleCount;
+}
+
+#if defined(TOADWART_CULLING_AVX2)
+// the scalar test for 8 boxes at once, first is a multiple of 8 and the bounds are padded
+TOADWART_TARGET_AVX2 auto CullBoundsAvx2(
+    const SCullingBounds& cullingBounds,
+    const std::array<glm::vec4, 6>& frustumPlanes,
+    const uint32_t first,
+    std::span<uint8_t> isVisible) -> uint32_t {
+
+    __m256 planeX[6];
+    __m256 planeY[6];
+    __m256 planeZ[6];
+    __m256 planeW[6];
+    __m256 planeAbsX[6];
+    __m256 planeAbsY[6];
+    __m256 planeAbsZ[6];
+    for (auto planeIndex = 0; planeIndex < 6; planeIndex++) {
+        const auto& frustumPlane = frustumPlanes[planeIndex];
+        planeX[planeIndex] = _mm256_set1_ps(frustumPlane.x);
+        planeY[planeIndex] = _mm256_set1_ps(frustumPlane.y);
+        planeZ[planeIndex] = _mm256_set1_ps(frustumPlane.z);
+        planeW[planeIndex] = _mm256_set1_ps(frustumPlane.w);
+        planeAbsX[planeIndex] = _mm256_set1_ps(glm::abs(frustumPlane.x));
+        planeAbsY[planeIndex] = _mm256_set1_ps(glm::abs(frustumPlane.y));
+        planeAbsZ[planeIndex] = _mm256_set1_ps(glm::abs(frustumPlane.z));
+    }
+    const auto zero = _mm256_setzero_ps();
+
+    const auto count = static_cast<uint32_t>(isVisible.size());
+    auto visibleCount = 0u;
+    for (auto offset = 0u; offset < count; offset += 8) {
+
+        const auto index = first + offset;
+        const auto centerX = _mm256_loadu_ps(&cullingBounds.CenterX[index]);
+        const auto centerY = _mm256_loadu_ps(&cullingBounds.CenterY[index]);
+        const auto centerZ = _mm256_loadu_ps(&cullingBounds.CenterZ[index]);
+        const auto extentX = _mm256_loadu_ps(&cullingBounds.ExtentX[index]);
+        const auto extentY = _mm256_loadu_ps(&cullingBounds.ExtentY[index]);
+        const auto extentZ = _mm256_loadu_ps(&cullingBounds.ExtentZ[index]);
+
+        auto isInside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (auto planeIndex = 0; planeIndex < 6; planeIndex++) {
+            auto distance = _mm256_add_ps(_mm256_mul_ps(planeX[planeIndex], centerX), planeW[planeIndex]);
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(planeY[planeIndex], centerY));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(planeZ[planeIndex], centerZ));
+            auto radius = _mm256_mul_ps(planeAbsX[planeIndex], extentX);
+            radius = _mm256_add_ps(radius, _mm256_mul_ps(planeAbsY[planeIndex], extentY));
+            radius = _mm256_add_ps(radius, _mm256_mul_ps(planeAbsZ[planeIndex], extentZ));
+            isInside = _mm256_and_ps(isInside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+        }
+
+        const auto insideMask = static_cast<uint32_t>(_mm256_movemask_ps(isInside));
+        const auto laneCount = std::min(8u, count - offset);
+        for (auto lane = 0u; lane < laneCount; lane++) {
+            isVisible[offset + lane] = static_cast<uint8_t>((insideMask >> lane) & 1u);
+        }
+        visibleCount += static_cast<uint32_t>(std::popcount(insideMask & ((1u << laneCount) - 1u)));
+    }
+    return visibleCount;
+}
+#endif
+
+auto CullBoundsChunk(
+    const SCullingBounds& cullingBounds,
+    const std::array<glm::vec4, 6>& frustumPlanes,
+    const uint32_t first,
+    std::span<uint8_t> isVisible) -> uint32_t {
+
+#if defined(TOADWART_CULLING_AVX2)
+    if (IsAvx2CullingSupported()) {
+        return CullBoundsAvx2(cullingBounds, frustumPlanes, first, isVisible);
+    }
+#endif
+    return CullBoundsScalar(cullingBounds, frustumPlanes, first, isVisible);
+}
+
+auto CullBounds(
+    const SCullingBounds& cullingBounds,
+    const std::array<glm::vec4, 6>& frustumPlanes,
+    std::span<uint8_t> isVisible) -> uint32_t {
+
+    const auto count = static_cast<uint32_t>(isVisible.size());
+    if (count <= g_cullingChunkSize) {
+        return CullBoundsChunk(cullingBounds, frustumPlanes, 0, isVisible);
+    }
+
+    std::vector<uint32_t> chunkIndices((count + g_cullingChunkSize - 1) / g_cullingChunkSize);
+    std::iota(chunkIndices.begin(), chunkIndices.end(), 0u);
+
+    std::atomic<uint32_t> visibleCount = 0;
+    std::for_each(poolstl::execution::par, chunkIndices.begin(), chunkIndices.end(), [&](uint32_t chunkIndex) {
+        const auto first = chunkIndex * g_cullingChunkSize;
+        const auto chunkSize = std::min(g_cullingChunkSize, count - first);
+        visibleCount += CullBoundsChunk(cullingBounds, frustumPlanes, first, isVisible.subspan(first, chunkSize));
+    });
+    return visibleCount;
+}
+
+auto GetFrustumPlanes(const glm::mat4& viewProjectionMatrix) -> std::array<glm::vec4, 6> {
+
+    const auto row0 = glm::row(viewProjectionMatrix, 0);
+    const auto row1 = glm::row(viewProjectionMatrix, 1);
+    const auto row2 = glm::row(viewProjectionMatrix, 2);
+    const auto row3 = glm::row(viewProjectionMatrix, 3);
+
+    std::array<glm::vec4, 6> frustumPlanes = {
+        row3 + row0,
+        row3 - row0,
+        row3 + row1,
+        row3 - row1,
+        row2,
+        row3 - row2
+    };
+
+    for (auto& frustumPlane : frustumPlanes) {
+        frustumPlane /= glm::length(glm::vec3(frustumPlane));
+    }
+
+    return frustumPlanes;
+}
+
+auto SelectLod(
+    std::span<const SPrimitiveLod> lods,
+    const glm::vec3& center,
+    const float radius,
+    const glm::mat4& worldMatrix,
+    const glm::vec3& cameraPosition,
+    const float projectionScale,
+    const float errorThreshold) -> uint32_t {
+
+    const auto worldCenter = glm::vec3(worldMatrix * glm::vec4(center, 1.0f));
+    const auto worldScale = glm::max(
+        glm::length(glm::vec3(worldMatrix[0])),
+        glm::max(glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2]))));
+    const auto distance = glm::max(glm::distance(worldCenter, cameraPosition) - radius * worldScale, 0.1f);
+
+    auto lodIndex = 0u;
+    for (auto i = 1u; i < lods.size(); i++) {
+        const auto projectedError = lods[i].Error * worldScale / distance * projectionScale;
+        if (projectedError > errorThreshold) {
+            break;
+        }
+        lodIndex = i;
+    }
+
+    return lodIndex;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+struct SPrimitiveLod;
+
+// World space bounding boxes of the objects of the scene, one array per component and padded to a multiple of 8 so
+// the culling loop tests 8 boxes at once with AVX2. Boxes are recomputed when an object moves, not when it is culled
+struct SCullingBounds {
+    std::vector<float> CenterX;
+    std::vector<float> CenterY;
+    std::vector<float> CenterZ;
+    std::vector<float> ExtentX;
+    std::vector<float> ExtentY;
+    std::vector<float> ExtentZ;
+};
+
+auto ResizeCullingBounds(
+    SCullingBounds& cullingBounds,
+    uint32_t count) -> void;
+
+// center and extent (half size) are in object space, the world space box encloses the transformed one
+auto SetCullingBounds(
+    SCullingBounds& cullingBounds,
+    uint32_t index,
+    const glm::mat4& worldMatrix,
+    const glm::vec3& center,
+    const glm::vec3& extent) -> void;
+
+// writes 1 for every box touching the frustum and 0 for the others, one per entry of isVisible. planes point
+// inwards and are normalized. large scenes are culled in chunks on the thread pool. returns the visible count
+auto CullBounds(
+    const SCullingBounds& cullingBounds,
+    const std::array<glm::vec4, 6>& frustumPlanes,
+    std::span<uint8_t> isVisible) -> uint32_t;
+
+// CullBounds falls back to testing one box at a time on CPUs without it
+auto IsAvx2CullingSupported() -> bool;
+
+// normalized planes pointing inwards: left, right, bottom, top, near (zero to one depth), far
+auto GetFrustumPlanes(const glm::mat4& viewProjectionMatrix) -> std::array<glm::vec4, 6>;
+
+// index of the coarsest lod whose error, projected at the distance of the closest point of the bounding sphere,
+// stays below errorThreshold pixels. center and radius are in object space. projectionScale is
+// viewport height / (2 * tan(fov / 2)). CullObjects.cs does the same on the gpu
+auto SelectLod(
+    std::span<const SPrimitiveLod> lods,
+    const glm::vec3& center,
+    float radius,
+    const glm::mat4& worldMatrix,
+    const glm::vec3& cameraPosition,
+    float projectionScale,
+    float errorThreshold) -> uint32_t;
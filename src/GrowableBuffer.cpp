@@ -0,0 +1,70 @@
+#include "GrowableBuffer.hpp"
+#include "DebugLabel.hpp"
+#include "Macros.hpp"
+#include "UploadQueue.hpp"
+
+#include <glad/gl.h>
+#include <spdlog/spdlog.h>
+
+std::size_t g_growableBufferMemorySize = 0;
+
+auto CreateBufferStorage(
+    std::string_view label,
+    std::size_t size) -> uint32_t {
+
+    uint32_t buffer = 0;
+    glCreateBuffers(1, &buffer);
+    SetDebugLabel(buffer, GL_BUFFER, label);
+    glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_STORAGE_BIT);
+    g_growableBufferMemorySize += size;
+    return buffer;
+}
+
+auto CreateGrowableBuffer(
+    std::string_view label,
+    uint32_t elementSize,
+    uint32_t capacity) -> SGrowableBuffer {
+
+    return SGrowableBuffer{
+        .Id = CreateBufferStorage(label, static_cast<std::size_t>(elementSize) * capacity),
+        .ElementSize = elementSize,
+        .Capacity = capacity,
+        .Label = std::string(label)
+    };
+}
+
+auto DeleteGrowableBuffer(SGrowableBuffer& buffer) -> void {
+
+    glDeleteBuffers(1, &buffer.Id);
+    g_growableBufferMemorySize -= static_cast<std::size_t>(buffer.ElementSize) * buffer.Capacity;
+    buffer.Id = 0;
+    buffer.Capacity = 0;
+}
+
+auto GetGrowableBufferMemorySize() -> std::size_t {
+    return g_growableBufferMemorySize;
+}
+
+auto GrowBuffer(
+    SGrowableBuffer& buffer,
+    uint32_t capacity) -> void {
+
+    TOADWART_PROFILE_SCOPED();
+    if (capacity <= buffer.Capacity) {
+        return;
+    }
+
+    const auto newBuffer = CreateBufferStorage(buffer.Label, static_cast<std::size_t>(buffer.ElementSize) * capacity);
+
+    // uploads already submitted land in the old buffer before the copy below reads it, the ones still queued go
+    // straight to the new buffer
+    RetargetBufferUploads(buffer.Id, newBuffer);
+    glCopyNamedBufferSubData(buffer.Id, newBuffer, 0, 0, static_cast<GLsizeiptr>(static_cast<std::size_t>(buffer.ElementSize) * buffer.Capacity));
+    glDeleteBuffers(1, &buffer.Id);
+    g_growableBufferMemorySize -= static_cast<std::size_t>(buffer.ElementSize) * buffer.Capacity;
+
+    spdlog::info("Grew {} from {} to {} elements", buffer.Label, buffer.Capacity, capacity);
+
+    buffer.Id = newBuffer;
+    buffer.Capacity = capacity;
+}
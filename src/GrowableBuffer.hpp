@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// GPU buffer which can be replaced by a bigger one, the old contents are copied over on the GPU.
+// Capacity is in elements, the id changes whenever the buffer grows so it has to be read again after growing
+struct SGrowableBuffer {
+    uint32_t Id = 0;
+    uint32_t ElementSize = 0;
+    uint32_t Capacity = 0;
+    std::string Label;
+};
+
+auto CreateGrowableBuffer(
+    std::string_view label,
+    uint32_t elementSize,
+    uint32_t capacity) -> SGrowableBuffer;
+auto DeleteGrowableBuffer(SGrowableBuffer& buffer) -> void;
+
+// bytes held by all growable buffers together
+auto GetGrowableBufferMemorySize() -> std::size_t;
+
+// queued uploads into the buffer follow it into the new one
+auto GrowBuffer(
+    SGrowableBuffer& buffer,
+    uint32_t capacity) -> void;
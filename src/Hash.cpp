@@ -0,0 +1,109 @@
+#include "Hash.hpp"
+
+#include <bit>
+#include <cstring>
+
+// xxHash64, see https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+
+constexpr uint64_t g_prime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t g_prime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t g_prime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t g_prime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t g_prime5 = 0x27D4EB2F165667C5ull;
+
+inline auto Read64(const uint8_t* data) -> uint64_t {
+    uint64_t value = 0;
+    std::memcpy(&value, data, sizeof(uint64_t));
+    return value;
+}
+
+inline auto Read32(const uint8_t* data) -> uint32_t {
+    uint32_t value = 0;
+    std::memcpy(&value, data, sizeof(uint32_t));
+    return value;
+}
+
+inline auto Round(uint64_t accumulator, uint64_t lane) -> uint64_t {
+    accumulator += lane * g_prime2;
+    accumulator = std::rotl(accumulator, 31);
+    return accumulator * g_prime1;
+}
+
+inline auto MergeRound(uint64_t accumulator, uint64_t value) -> uint64_t {
+    accumulator ^= Round(0, value);
+    return accumulator * g_prime1 + g_prime4;
+}
+
+auto Hash64(
+    const void* data,
+    std::size_t dataSize,
+    uint64_t seed) -> uint64_t {
+
+    auto* bytes = static_cast<const uint8_t*>(data);
+    const auto* end = bytes + dataSize;
+    uint64_t hash = 0;
+
+    if (dataSize >= 32) {
+        uint64_t v1 = seed + g_prime1 + g_prime2;
+        uint64_t v2 = seed + g_prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - g_prime1;
+
+        const auto* limit = end - 32;
+        do {
+            v1 = Round(v1, Read64(bytes));
+            v2 = Round(v2, Read64(bytes + 8));
+            v3 = Round(v3, Read64(bytes + 16));
+            v4 = Round(v4, Read64(bytes + 24));
+            bytes += 32;
+        } while (bytes <= limit);
+
+        hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+        hash = MergeRound(hash, v1);
+        hash = MergeRound(hash, v2);
+        hash = MergeRound(hash, v3);
+        hash = MergeRound(hash, v4);
+    } else {
+        hash = seed + g_prime5;
+    }
+
+    hash += static_cast<uint64_t>(dataSize);
+
+    while (bytes + 8 <= end) {
+        hash ^= Round(0, Read64(bytes));
+        hash = std::rotl(hash, 27) * g_prime1 + g_prime4;
+        bytes += 8;
+    }
+
+    if (bytes + 4 <= end) {
+        hash ^= static_cast<uint64_t>(Read32(bytes)) * g_prime1;
+        hash = std::rotl(hash, 23) * g_prime2 + g_prime3;
+        bytes += 4;
+    }
+
+    while (bytes < end) {
+        hash ^= static_cast<uint64_t>(*bytes) * g_prime5;
+        hash = std::rotl(hash, 11) * g_prime1;
+        bytes++;
+    }
+
+    hash ^= hash >> 33;
+    hash *= g_prime2;
+    hash ^= hash >> 29;
+    hash *= g_prime3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+auto Hash64(std::span<const std::byte> data, uint64_t seed) -> uint64_t {
+    return Hash64(data.data(), data.size(), seed);
+}
+
+auto Hash64(std::string_view text, uint64_t seed) -> uint64_t {
+    return Hash64(text.data(), text.size(), seed);
+}
+
+auto HashCombine(uint64_t hash, uint64_t value) -> uint64_t {
+    return MergeRound(hash ^ g_prime5, value);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+auto Hash64(
+    const void* data,
+    std::size_t dataSize,
+    uint64_t seed = 0) -> uint64_t;
+auto Hash64(std::span<const std::byte> data, uint64_t seed = 0) -> uint64_t;
+auto Hash64(std::string_view text, uint64_t seed = 0) -> uint64_t;
+auto HashCombine(uint64_t hash, uint64_t value) -> uint64_t;
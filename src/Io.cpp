@@ -1,17 +1,573 @@
 #include "Io.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fstream>
+#include <thread>
+
+#if defined(_WIN32)
+  #define WIN32_LEAN_AND_MEAN
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <cerrno>
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <sys/uio.h>
+  #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+  #include <linux/io_uring.h>
+  #include <sys/syscall.h>
+#endif
+
+using SFileData = std::pair<std::unique_ptr<std::byte[]>, std::size_t>;
+
+constexpr std::size_t g_maxReadThreadCount = 8;
 
 auto ReadTextFromFile(const std::filesystem::path& filePath) -> std::string {
 
-    std::ifstream fileStream{filePath};
-    return {std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>()};
+    std::ifstream fileStream{filePath, std::ifstream::binary | std::ifstream::ate};
+    if (!fileStream) {
+        return {};
+    }
+
+    std::string text(static_cast<std::size_t>(fileStream.tellg()), '\0');
+    fileStream.seekg(0);
+    fileStream.read(text.data(), static_cast<std::streamsize>(text.size()));
+    text.resize(static_cast<std::size_t>(fileStream.gcount()));
+    return text;
 }
 
 auto ReadBinaryFromFile(const std::filesystem::path& filePath) -> std::pair<std::unique_ptr<std::byte[]>, std::size_t> {
-    std::size_t fileSize = std::filesystem::file_size(filePath);
-    auto memory = std::make_unique<std::byte[]>(fileSize);
+
+    std::error_code errorCode;
+    const auto fileSize = std::filesystem::file_size(filePath, errorCode);
+    if (errorCode) {
+        return {nullptr, 0};
+    }
+
+    auto memory = std::make_unique_for_overwrite<std::byte[]>(fileSize);
     std::ifstream file{filePath, std::ifstream::binary};
-    std::copy(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), reinterpret_cast<char*>(memory.get()));
+    file.read(reinterpret_cast<char*>(memory.get()), static_cast<std::streamsize>(fileSize));
+    if (static_cast<std::size_t>(file.gcount()) != fileSize) {
+        return {nullptr, 0};
+    }
+
     return {std::move(memory), fileSize};
-}
\ No newline at end of file
+}
+
+// every file of a batch is opened and sized up front, the buffers are filled by whichever backend reads them
+struct SFileRead {
+#if defined(_WIN32)
+    HANDLE File = INVALID_HANDLE_VALUE;
+#else
+    int32_t File = -1;
+#endif
+    std::unique_ptr<std::byte[]> Data;
+    std::size_t Size = 0;
+    bool IsFailed = false;
+};
+
+auto OpenFileRead(const std::filesystem::path& filePath) -> SFileRead {
+
+    SFileRead fileRead = {};
+
+#if defined(_WIN32)
+    fileRead.File = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    LARGE_INTEGER fileSize = {};
+    if (fileRead.File == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileRead.File, &fileSize)) {
+        fileRead.IsFailed = true;
+        return fileRead;
+    }
+    fileRead.Size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+    fileRead.File = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat fileStat = {};
+    if (fileRead.File < 0 || fstat(fileRead.File, &fileStat) != 0) {
+        fileRead.IsFailed = true;
+        return fileRead;
+    }
+    fileRead.Size = static_cast<std::size_t>(fileStat.st_size);
+#endif
+
+    fileRead.Data = std::make_unique_for_overwrite<std::byte[]>(fileRead.Size);
+    return fileRead;
+}
+
+auto CloseFileRead(SFileRead& fileRead) -> void {
+
+#if defined(_WIN32)
+    if (fileRead.File != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileRead.File);
+        fileRead.File = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (fileRead.File >= 0) {
+        close(fileRead.File);
+        fileRead.File = -1;
+    }
+#endif
+}
+
+auto ReadWholeFile(SFileRead& fileRead) -> void {
+
+    std::size_t bytesRead = 0;
+    while (bytesRead < fileRead.Size) {
+#if defined(_WIN32)
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(bytesRead);
+        overlapped.OffsetHigh = static_cast<DWORD>(static_cast<uint64_t>(bytesRead) >> 32);
+        DWORD chunkBytesRead = 0;
+        const auto chunkSize = static_cast<DWORD>(std::min<std::size_t>(fileRead.Size - bytesRead, 1u << 30));
+        if (!ReadFile(fileRead.File, fileRead.Data.get() + bytesRead, chunkSize, &chunkBytesRead, &overlapped) || chunkBytesRead == 0) {
+            fileRead.IsFailed = true;
+            return;
+        }
+#else
+        const auto chunkBytesRead = pread(fileRead.File, fileRead.Data.get() + bytesRead, fileRead.Size - bytesRead, static_cast<off_t>(bytesRead));
+        if (chunkBytesRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (chunkBytesRead <= 0) {
+            fileRead.IsFailed = true;
+            return;
+        }
+#endif
+        bytesRead += static_cast<std::size_t>(chunkBytesRead);
+    }
+}
+
+// fallback for platforms without io_uring, or kernels which don't allow it. workers pick the next file until none are left
+auto ReadFilesWithThreads(std::span<SFileRead> fileReads) -> void {
+
+    std::atomic<std::size_t> nextFileReadIndex = 0;
+    auto readFiles = [&]() {
+        for (auto fileReadIndex = nextFileReadIndex++; fileReadIndex < fileReads.size(); fileReadIndex = nextFileReadIndex++) {
+            if (!fileReads[fileReadIndex].IsFailed) {
+                ReadWholeFile(fileReads[fileReadIndex]);
+            }
+        }
+    };
+
+    const auto threadCount = std::min({fileReads.size(), static_cast<std::size_t>(std::max(std::thread::hardware_concurrency(), 1u)), g_maxReadThreadCount});
+    std::vector<std::jthread> threads;
+    for (std::size_t threadIndex = 1; threadIndex < threadCount; threadIndex++) {
+        threads.emplace_back(readFiles);
+    }
+    readFiles();
+}
+
+#if defined(__linux__)
+
+// io_uring driven through the raw syscalls, one ring per batch so batches never share state
+constexpr uint32_t g_ioUringEntryCount = 64;
+constexpr std::size_t g_ioUringMaxReadSize = 8 * 1024 * 1024;
+
+struct SIoUring {
+    int32_t Fd = -1;
+
+    void* SqRing = nullptr;
+    std::size_t SqRingSize = 0;
+    void* CqRing = nullptr;
+    std::size_t CqRingSize = 0;
+    io_uring_sqe* Sqes = nullptr;
+    std::size_t SqesSize = 0;
+
+    uint32_t* SqHead = nullptr;
+    uint32_t* SqTail = nullptr;
+    uint32_t SqRingMask = 0;
+    uint32_t* SqArray = nullptr;
+
+    uint32_t* CqHead = nullptr;
+    uint32_t* CqTail = nullptr;
+    uint32_t CqRingMask = 0;
+    io_uring_cqe* Cqes = nullptr;
+};
+
+// a read in flight, partial reads are queued again for the remainder
+struct SIoUringRead {
+    std::size_t FileReadIndex = 0;
+    std::size_t Offset = 0;
+    iovec Buffer = {};
+};
+
+std::atomic<bool> g_isIoUringUnavailable = false;
+
+auto DestroyIoUring(SIoUring& ioUring) -> void {
+
+    if (ioUring.Sqes != nullptr) {
+        munmap(ioUring.Sqes, ioUring.SqesSize);
+    }
+    if (ioUring.CqRing != nullptr && ioUring.CqRing != ioUring.SqRing) {
+        munmap(ioUring.CqRing, ioUring.CqRingSize);
+    }
+    if (ioUring.SqRing != nullptr) {
+        munmap(ioUring.SqRing, ioUring.SqRingSize);
+    }
+    if (ioUring.Fd >= 0) {
+        close(ioUring.Fd);
+    }
+    ioUring = {};
+}
+
+auto CreateIoUring(uint32_t entryCount) -> std::optional<SIoUring> {
+
+    SIoUring ioUring = {};
+
+    io_uring_params parameters = {};
+    ioUring.Fd = static_cast<int32_t>(syscall(__NR_io_uring_setup, entryCount, &parameters));
+    if (ioUring.Fd < 0) {
+        return std::nullopt;
+    }
+
+    ioUring.SqRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(uint32_t);
+    ioUring.CqRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+    const auto isSingleMapping = (parameters.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (isSingleMapping) {
+        ioUring.SqRingSize = std::max(ioUring.SqRingSize, ioUring.CqRingSize);
+        ioUring.CqRingSize = ioUring.SqRingSize;
+    }
+
+    ioUring.SqRing = mmap(nullptr, ioUring.SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ioUring.Fd, IORING_OFF_SQ_RING);
+    if (ioUring.SqRing == MAP_FAILED) {
+        ioUring.SqRing = nullptr;
+        DestroyIoUring(ioUring);
+        return std::nullopt;
+    }
+
+    ioUring.CqRing = isSingleMapping
+        ? ioUring.SqRing
+        : mmap(nullptr, ioUring.CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ioUring.Fd, IORING_OFF_CQ_RING);
+    if (ioUring.CqRing == MAP_FAILED) {
+        ioUring.CqRing = nullptr;
+        DestroyIoUring(ioUring);
+        return std::nullopt;
+    }
+
+    ioUring.SqesSize = parameters.sq_entries * sizeof(io_uring_sqe);
+    auto* sqes = mmap(nullptr, ioUring.SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ioUring.Fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        DestroyIoUring(ioUring);
+        return std::nullopt;
+    }
+    ioUring.Sqes = static_cast<io_uring_sqe*>(sqes);
+
+    auto* sqRing = static_cast<std::byte*>(ioUring.SqRing);
+    ioUring.SqHead = reinterpret_cast<uint32_t*>(sqRing + parameters.sq_off.head);
+    ioUring.SqTail = reinterpret_cast<uint32_t*>(sqRing + parameters.sq_off.tail);
+    ioUring.SqRingMask = *reinterpret_cast<uint32_t*>(sqRing + parameters.sq_off.ring_mask);
+    ioUring.SqArray = reinterpret_cast<uint32_t*>(sqRing + parameters.sq_off.array);
+
+    auto* cqRing = static_cast<std::byte*>(ioUring.CqRing);
+    ioUring.CqHead = reinterpret_cast<uint32_t*>(cqRing + parameters.cq_off.head);
+    ioUring.CqTail = reinterpret_cast<uint32_t*>(cqRing + parameters.cq_off.tail);
+    ioUring.CqRingMask = *reinterpret_cast<uint32_t*>(cqRing + parameters.cq_off.ring_mask);
+    ioUring.Cqes = reinterpret_cast<io_uring_cqe*>(cqRing + parameters.cq_off.cqes);
+
+    return ioUring;
+}
+
+auto QueueIoUringRead(
+    SIoUring& ioUring,
+    int32_t file,
+    SIoUringRead& ioUringRead,
+    uint64_t userData) -> void {
+
+    const auto sqTail = std::atomic_ref(*ioUring.SqTail).load(std::memory_order_relaxed);
+    const auto sqIndex = sqTail & ioUring.SqRingMask;
+
+    auto& sqe = ioUring.Sqes[sqIndex];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = IORING_OP_READV;
+    sqe.fd = file;
+    sqe.addr = reinterpret_cast<uint64_t>(&ioUringRead.Buffer);
+    sqe.len = 1;
+    sqe.off = ioUringRead.Offset;
+    sqe.user_data = userData;
+
+    ioUring.SqArray[sqIndex] = sqIndex;
+    std::atomic_ref(*ioUring.SqTail).store(sqTail + 1, std::memory_order_release);
+}
+
+// waits for the completions of reads the kernel still holds and drops them, false when even waiting fails
+auto DrainIoUring(
+    SIoUring& ioUring,
+    uint32_t submittedCount) -> bool {
+
+    while (submittedCount > 0) {
+
+        if (syscall(__NR_io_uring_enter, ioUring.Fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+            return false;
+        }
+
+        auto cqHead = std::atomic_ref(*ioUring.CqHead).load(std::memory_order_relaxed);
+        const auto cqTail = std::atomic_ref(*ioUring.CqTail).load(std::memory_order_acquire);
+        for (; cqHead != cqTail && submittedCount > 0; cqHead++) {
+            submittedCount--;
+        }
+        std::atomic_ref(*ioUring.CqHead).store(cqHead, std::memory_order_release);
+    }
+    return true;
+}
+
+// keeps up to g_ioUringEntryCount reads of at most g_ioUringMaxReadSize in flight, across all files of the batch
+auto ReadFilesWithIoUring(std::span<SFileRead> fileReads) -> bool {
+
+    if (g_isIoUringUnavailable.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    auto ioUringResult = CreateIoUring(g_ioUringEntryCount);
+    if (!ioUringResult.has_value()) {
+        g_isIoUringUnavailable.store(true, std::memory_order_relaxed);
+        return false;
+    }
+    auto& ioUring = *ioUringResult;
+
+    std::vector<SIoUringRead> ioUringReads(g_ioUringEntryCount);
+    std::vector<uint32_t> freeIoUringReads(g_ioUringEntryCount);
+    for (uint32_t i = 0; i < g_ioUringEntryCount; i++) {
+        freeIoUringReads[i] = g_ioUringEntryCount - 1 - i;
+    }
+
+    std::size_t nextFileReadIndex = 0;
+    std::size_t nextFileReadOffset = 0;
+    uint32_t queuedCount = 0;
+    uint32_t inFlightCount = 0;
+    auto isFailed = false;
+
+    while (!isFailed) {
+
+        while (!freeIoUringReads.empty() && nextFileReadIndex < fileReads.size()) {
+
+            auto& fileRead = fileReads[nextFileReadIndex];
+            if (fileRead.IsFailed || nextFileReadOffset >= fileRead.Size) {
+                nextFileReadIndex++;
+                nextFileReadOffset = 0;
+                continue;
+            }
+
+            const auto readSize = std::min(fileRead.Size - nextFileReadOffset, g_ioUringMaxReadSize);
+            const auto ioUringReadIndex = freeIoUringReads.back();
+            freeIoUringReads.pop_back();
+
+            ioUringReads[ioUringReadIndex] = SIoUringRead{
+                .FileReadIndex = nextFileReadIndex,
+                .Offset = nextFileReadOffset,
+                .Buffer = iovec{ .iov_base = fileRead.Data.get() + nextFileReadOffset, .iov_len = readSize }
+            };
+            QueueIoUringRead(ioUring, fileRead.File, ioUringReads[ioUringReadIndex], ioUringReadIndex);
+            queuedCount++;
+            inFlightCount++;
+            nextFileReadOffset += readSize;
+        }
+
+        if (inFlightCount == 0) {
+            break;
+        }
+
+        const auto submittedCount = syscall(__NR_io_uring_enter, ioUring.Fd, queuedCount, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (submittedCount < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+            isFailed = true;
+            // the queued reads never reached the kernel, the others still write into the buffers
+            if (!DrainIoUring(ioUring, inFlightCount - queuedCount)) {
+                // no telling when the kernel is done with them, the buffers are given up and their files count as failed
+                for (auto ioUringReadIndex = 0u; ioUringReadIndex < g_ioUringEntryCount; ioUringReadIndex++) {
+                    if (std::ranges::find(freeIoUringReads, ioUringReadIndex) == freeIoUringReads.end()) {
+                        auto& fileRead = fileReads[ioUringReads[ioUringReadIndex].FileReadIndex];
+                        static_cast<void>(fileRead.Data.release());
+                        fileRead.IsFailed = true;
+                    }
+                }
+            }
+            break;
+        }
+        queuedCount -= static_cast<uint32_t>(submittedCount);
+
+        auto cqHead = std::atomic_ref(*ioUring.CqHead).load(std::memory_order_relaxed);
+        const auto cqTail = std::atomic_ref(*ioUring.CqTail).load(std::memory_order_acquire);
+        for (; cqHead != cqTail; cqHead++) {
+
+            const auto& cqe = ioUring.Cqes[cqHead & ioUring.CqRingMask];
+            const auto ioUringReadIndex = static_cast<uint32_t>(cqe.user_data);
+            auto& ioUringRead = ioUringReads[ioUringReadIndex];
+            auto& fileRead = fileReads[ioUringRead.FileReadIndex];
+
+            if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                QueueIoUringRead(ioUring, fileRead.File, ioUringRead, ioUringReadIndex);
+                queuedCount++;
+                continue;
+            }
+
+            const auto bytesRead = cqe.res > 0 ? static_cast<std::size_t>(cqe.res) : 0;
+            if (cqe.res <= 0) {
+                fileRead.IsFailed = true;
+            } else if (bytesRead < ioUringRead.Buffer.iov_len) {
+                ioUringRead.Offset += bytesRead;
+                ioUringRead.Buffer.iov_base = static_cast<std::byte*>(ioUringRead.Buffer.iov_base) + bytesRead;
+                ioUringRead.Buffer.iov_len -= bytesRead;
+                QueueIoUringRead(ioUring, fileRead.File, ioUringRead, ioUringReadIndex);
+                queuedCount++;
+                continue;
+            }
+
+            freeIoUringReads.push_back(ioUringReadIndex);
+            inFlightCount--;
+        }
+        std::atomic_ref(*ioUring.CqHead).store(cqHead, std::memory_order_release);
+    }
+
+    // every read was reaped, after a failed submit the caller reads the whole batch again the slow way
+    DestroyIoUring(ioUring);
+    return !isFailed;
+}
+
+#endif
+
+auto ReadBinaryFromFiles(
+    std::span<const std::filesystem::path> filePaths,
+    const EFileBatchReadMethod readMethod) -> std::vector<std::pair<std::unique_ptr<std::byte[]>, std::size_t>> {
+
+    std::vector<SFileRead> fileReads;
+    fileReads.reserve(filePaths.size());
+    for (const auto& filePath : filePaths) {
+        fileReads.push_back(OpenFileRead(filePath));
+    }
+
+#if defined(__linux__)
+    if (readMethod == EFileBatchReadMethod::Threads || !ReadFilesWithIoUring(fileReads)) {
+        ReadFilesWithThreads(fileReads);
+    }
+#else
+    ReadFilesWithThreads(fileReads);
+#endif
+
+    std::vector<SFileData> fileDatas;
+    fileDatas.reserve(fileReads.size());
+    for (auto& fileRead : fileReads) {
+        CloseFileRead(fileRead);
+        if (fileRead.IsFailed) {
+            fileDatas.emplace_back(nullptr, 0);
+        } else {
+            fileDatas.emplace_back(std::move(fileRead.Data), fileRead.Size);
+        }
+    }
+
+    return fileDatas;
+}
+
+auto ReadBinaryFromFilesAsync(std::vector<std::filesystem::path> filePaths) -> std::future<std::vector<std::pair<std::unique_ptr<std::byte[]>, std::size_t>>> {
+
+    return std::async(std::launch::async, [filePaths = std::move(filePaths)]() {
+        return ReadBinaryFromFiles(filePaths);
+    });
+}
+
+auto MapFile(
+    const std::filesystem::path& filePath,
+    EFileAccessPattern accessPattern) -> std::optional<SMappedFile> {
+
+#if defined(_WIN32)
+    auto file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return std::nullopt;
+    }
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return std::nullopt;
+    }
+
+    auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return std::nullopt;
+    }
+
+    // the view keeps the mapping alive
+    auto* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (data == nullptr) {
+        return std::nullopt;
+    }
+
+    // windows has no equivalent for the other patterns on mapped views
+    if (accessPattern == EFileAccessPattern::WillNeed) {
+        WIN32_MEMORY_RANGE_ENTRY memoryRange = {
+            .VirtualAddress = data,
+            .NumberOfBytes = static_cast<SIZE_T>(fileSize.QuadPart)
+        };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &memoryRange, 0);
+    }
+
+    return SMappedFile{
+        .Data = static_cast<const std::byte*>(data),
+        .Size = static_cast<std::size_t>(fileSize.QuadPart)
+    };
+#else
+    auto file = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+        return std::nullopt;
+    }
+
+    struct stat fileStat = {};
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+        close(file);
+        return std::nullopt;
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    auto* data = mmap(nullptr, static_cast<std::size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    // only a hint, a failing madvise leaves the mapping as usable as before
+    switch (accessPattern) {
+        case EFileAccessPattern::Sequential:
+            madvise(data, static_cast<std::size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+            break;
+        case EFileAccessPattern::Random:
+            madvise(data, static_cast<std::size_t>(fileStat.st_size), MADV_RANDOM);
+            break;
+        case EFileAccessPattern::WillNeed:
+            madvise(data, static_cast<std::size_t>(fileStat.st_size), MADV_WILLNEED);
+            break;
+        default:
+            break;
+    }
+
+    return SMappedFile{
+        .Data = static_cast<const std::byte*>(data),
+        .Size = static_cast<std::size_t>(fileStat.st_size)
+    };
+#endif
+}
+
+auto UnmapFile(SMappedFile& mappedFile) -> void {
+
+    if (mappedFile.Data == nullptr) {
+        return;
+    }
+
+#if defined(_WIN32)
+    UnmapViewOfFile(mappedFile.Data);
+#else
+    munmap(const_cast<std::byte*>(mappedFile.Data), mappedFile.Size);
+#endif
+
+    mappedFile.Data = nullptr;
+    mappedFile.Size = 0;
+}
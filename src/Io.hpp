@@ -2,8 +2,44 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+#include <span>
 #include <utility>
 #include <string>
+#include <vector>
+
+struct SMappedFile {
+    const std::byte* Data = nullptr;
+    std::size_t Size = 0;
+};
+
+// how a mapped file is going to be read, passed on to the kernel (madvise) so it can read ahead or not
+enum class EFileAccessPattern : uint32_t {
+    Normal,
+    Sequential,
+    Random,
+    WillNeed
+};
+
+// how a batch of files is read. Threads skips io_uring, for comparing the two
+enum class EFileBatchReadMethod : uint32_t {
+    Default,
+    Threads
+};
 
 auto ReadTextFromFile(const std::filesystem::path& filePath) -> std::string;
-auto ReadBinaryFromFile(const std::filesystem::path& filePath) -> std::pair<std::unique_ptr<std::byte[]>, std::size_t>;
\ No newline at end of file
+auto ReadBinaryFromFile(const std::filesystem::path& filePath) -> std::pair<std::unique_ptr<std::byte[]>, std::size_t>;
+
+// reads a batch of files at once, through io_uring where available and a small pool of threads otherwise.
+// any number of threads can read batches at the same time, files which can't be read come back empty
+auto ReadBinaryFromFiles(
+    std::span<const std::filesystem::path> filePaths,
+    EFileBatchReadMethod readMethod = EFileBatchReadMethod::Default) -> std::vector<std::pair<std::unique_ptr<std::byte[]>, std::size_t>>;
+auto ReadBinaryFromFilesAsync(std::vector<std::filesystem::path> filePaths) -> std::future<std::vector<std::pair<std::unique_ptr<std::byte[]>, std::size_t>>>;
+
+auto MapFile(
+    const std::filesystem::path& filePath,
+    EFileAccessPattern accessPattern = EFileAccessPattern::Normal) -> std::optional<SMappedFile>;
+auto UnmapFile(SMappedFile& mappedFile) -> void;
@@ -0,0 +1,123 @@
+#include "Io.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string_view>
+
+// Reads every file below a directory (data by default) with each of the ways Io offers and prints the throughput.
+// Files are read once up front, so the numbers compare the read paths on a warm page cache, drop the caches
+// between runs to compare cold reads. usage: IoBenchmark [directory] [iterations]
+
+// ReadBinaryFromFile as it was before the bulk read
+auto ReadBinaryFromFileWithStreamIterator(const std::filesystem::path& filePath) -> std::pair<std::unique_ptr<std::byte[]>, std::size_t> {
+    std::size_t fileSize = std::filesystem::file_size(filePath);
+    auto memory = std::make_unique<std::byte[]>(fileSize);
+    std::ifstream file{filePath, std::ifstream::binary};
+    std::copy(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>(), reinterpret_cast<char*>(memory.get()));
+    return {std::move(memory), fileSize};
+}
+
+// a mapping reads nothing until it is touched, every page is read once
+auto ReadMappedFile(const std::filesystem::path& filePath) -> std::size_t {
+
+    auto mappedFile = MapFile(filePath, EFileAccessPattern::Sequential);
+    if (!mappedFile.has_value()) {
+        return 0;
+    }
+
+    volatile uint8_t checksum = 0;
+    for (std::size_t offset = 0; offset < mappedFile->Size; offset += 4096) {
+        checksum = checksum ^ static_cast<uint8_t>(mappedFile->Data[offset]);
+    }
+    const auto size = mappedFile->Size;
+    UnmapFile(*mappedFile);
+    return size;
+}
+
+auto RunBenchmark(
+    const std::string_view name,
+    const uint32_t iterationCount,
+    const std::function<std::size_t()>& readFiles) -> void {
+
+    auto bytesRead = std::size_t{0};
+    const auto startTime = std::chrono::steady_clock::now();
+    for (auto iteration = 0u; iteration < iterationCount; iteration++) {
+        bytesRead += readFiles();
+    }
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    const auto megaBytes = static_cast<double>(bytesRead) / (1024.0 * 1024.0);
+    std::printf("%-32s %10.2f MB in %8.3f ms, %10.2f MB/s\n", name.data(), megaBytes, seconds * 1000.0, megaBytes / std::max(seconds, 1e-9));
+}
+
+auto main(int argc, char* argv[]) -> int {
+
+    const auto directory = std::filesystem::path(argc > 1 ? argv[1] : "data");
+    const auto iterationCount = argc > 2 ? static_cast<uint32_t>(std::max(std::atoi(argv[2]), 1)) : 4u;
+
+    std::vector<std::filesystem::path> filePaths;
+    std::error_code directoryErrorCode;
+    for (const auto& directoryEntry : std::filesystem::recursive_directory_iterator(directory, directoryErrorCode)) {
+        if (directoryEntry.is_regular_file()) {
+            filePaths.push_back(directoryEntry.path());
+        }
+    }
+    if (filePaths.empty()) {
+        std::fprintf(stderr, "no files found below %s\n", directory.string().c_str());
+        return 1;
+    }
+
+    auto totalSize = std::size_t{0};
+    for (const auto& filePath : filePaths) {
+        totalSize += ReadBinaryFromFile(filePath).second;
+    }
+    std::printf("%zu files, %.2f MB, %u iterations\n", filePaths.size(), static_cast<double>(totalSize) / (1024.0 * 1024.0), iterationCount);
+
+    RunBenchmark("istreambuf_iterator", iterationCount, [&]() {
+        auto bytesRead = std::size_t{0};
+        for (const auto& filePath : filePaths) {
+            bytesRead += ReadBinaryFromFileWithStreamIterator(filePath).second;
+        }
+        return bytesRead;
+    });
+
+    RunBenchmark("ReadBinaryFromFile", iterationCount, [&]() {
+        auto bytesRead = std::size_t{0};
+        for (const auto& filePath : filePaths) {
+            bytesRead += ReadBinaryFromFile(filePath).second;
+        }
+        return bytesRead;
+    });
+
+    RunBenchmark("MapFile", iterationCount, [&]() {
+        auto bytesRead = std::size_t{0};
+        for (const auto& filePath : filePaths) {
+            bytesRead += ReadMappedFile(filePath);
+        }
+        return bytesRead;
+    });
+
+    // io_uring on linux, the threads when the kernel refuses it
+    RunBenchmark("ReadBinaryFromFiles", iterationCount, [&]() {
+        auto bytesRead = std::size_t{0};
+        for (const auto& [data, size] : ReadBinaryFromFiles(filePaths)) {
+            bytesRead += size;
+        }
+        return bytesRead;
+    });
+
+    RunBenchmark("ReadBinaryFromFiles (threads)", iterationCount, [&]() {
+        auto bytesRead = std::size_t{0};
+        for (const auto& [data, size] : ReadBinaryFromFiles(filePaths, EFileBatchReadMethod::Threads)) {
+            bytesRead += size;
+        }
+        return bytesRead;
+    });
+
+    return 0;
+}
@@ -1,14 +1,21 @@
 #include <algorithm>
+#include <bit>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
 #include <execution>
 #include <expected>
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
 #include <ranges>
 #include <span>
 #include <sstream>
@@ -16,6 +23,7 @@
 #include <string_view>
 #include <thread>
 #include <tuple>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <variant>
@@ -26,6 +34,20 @@
 #include "Format.hpp"
 #include "Framebuffer.hpp"
 #include "DebugLabel.hpp"
+#include "Model.hpp"
+#include "ModelCache.hpp"
+#include "TextureCache.hpp"
+#include "Mipmap.hpp"
+#include "Hash.hpp"
+#include "UploadQueue.hpp"
+#include "TransformHierarchy.hpp"
+#include "FrustumCulling.hpp"
+#include "CompletionQueue.hpp"
+#include "ResourceRegistry.hpp"
+#include "OffsetAllocator.hpp"
+#include "GrowableBuffer.hpp"
+#include "FileWatcher.hpp"
+#include "ShaderCompiler.hpp"
 
 #include <spdlog/spdlog.h>
 #include <glad/gl.h>
@@ -50,6 +72,8 @@
 #include <fastgltf/tools.hpp>
 #include <fastgltf/types.hpp>
 
+#include <meshoptimizer.h>
+
 #include <debugbreak.h>
 #if defined(TOADWART_ENABLE_LILYPAD)
 #include "Lilypad.hpp"
@@ -77,15 +101,6 @@ struct SWindowSettings {
     bool IsDebug;
 };
 
-struct SVertexPosition {
-    glm::vec3 Position;
-};
-
-struct SVertexNormalUv {
-    uint32_t Normal;
-    glm::vec2 Uv;
-};
-
 struct SVertexPositionUv {
     glm::vec3 Position;
     glm::vec2 Uv;
@@ -114,8 +129,8 @@ struct SGlobalUniforms {
     glm::mat4 ViewProjectionMatrix;
     */
     glm::vec4 CameraPosition;
-    /*
     glm::vec4 FrustumPlanes[6];
+    /*
     glm::vec4 Viewport;
 */
 };
@@ -127,20 +142,10 @@ struct SShadingUniforms {
 
 struct SObject {
     glm::mat4x4 WorldMatrix;
+    // material index, draw bucket index, first meshlet of the draw bucket, first object of the draw bucket
     glm::ivec4 InstanceParameter;
-};
-
-struct SCpuMaterial {
-    std::string Name;
-    std::optional<size_t> BaseTextureIndex;
-    std::optional<size_t> NormalTextureIndex;
-    std::optional<size_t> OcclusionTextureIndex;
-    std::optional<size_t> MetallicRoughnessTextureIndex;
-    std::optional<size_t> EmissiveTextureIndex;
-
-    size_t _padding1;
-
-    glm::vec4 BaseColor;
+    glm::vec4 PositionScale;
+    glm::vec4 PositionOffset;
 };
 
 struct SGpuMaterial {
@@ -167,6 +172,81 @@ struct SGpuPooledPrimitive {
     uint32_t BaseInstance;
 };
 
+// bounds and lod range of the primitive of an object, what the object culling pass reads next to SObject
+struct SGpuCullObject {
+    glm::vec4 CenterRadius;
+    glm::vec3 Extent;
+    uint32_t FirstLod;
+    uint32_t LodCount;
+    int32_t BaseVertex;
+    uint32_t HasMeshlets;
+    // index into the models of the scene, for the seen bits
+    uint32_t ModelIndex;
+};
+
+struct SBounds {
+    glm::vec3 Center;
+    // half size of the box
+    glm::vec3 Extent;
+    float Radius;
+};
+
+struct SGpuMeshlet {
+    glm::vec4 CenterRadius;
+    glm::vec4 ConeApexCutoff;
+    glm::vec4 ConeAxis;
+    uint32_t FirstIndex;
+    uint32_t IndexCount;
+    int32_t BaseVertex;
+    uint32_t ObjectIndex;
+};
+
+// texture slots of a material its shader samples, every combination in use gets its own specialization of
+// Simple.fs which leaves out the work of the slots the material doesn't have
+constexpr uint32_t g_materialFeatureBaseTexture = 1u << 0;
+constexpr uint32_t g_materialFeatureNormalTexture = 1u << 1;
+constexpr uint32_t g_materialFeatureOcclusionTexture = 1u << 2;
+constexpr uint32_t g_materialFeatureMetallicRoughnessTexture = 1u << 3;
+constexpr uint32_t g_materialFeatureEmissiveTexture = 1u << 4;
+constexpr uint32_t g_materialFeatureCombinationCount = 1u << 5;
+
+// primitives sharing an index type and a material permutation, drawn by one multi draw. buckets are sorted by
+// index type, then by material features
+struct SDrawBucket {
+    EIndexType IndexType;
+    // the id of a pool buffer changes when it grows
+    const SGrowableBuffer* IndexBuffer;
+    uint32_t ElementType;
+    uint32_t MaterialFeatures;
+    uint32_t FirstPrimitive;
+    uint32_t PrimitiveCount;
+    // draw commands of the visible primitives are packed at the start of the bucket's range
+    uint32_t VisiblePrimitiveCount;
+    uint32_t FirstMeshlet;
+    uint32_t MeshletCount;
+};
+
+// every bucket has its own meshlet draw count, there are never more buckets than this
+constexpr uint32_t g_drawBucketCapacity = 2 * g_materialFeatureCombinationCount;
+
+struct SPrimitiveInstance {
+    SModel* Model;
+    uint32_t ModelIndex;
+    const SPrimitive* Primitive;
+    uint32_t TransformNode;
+    glm::mat4 WorldMatrix;
+};
+
+// materials and models the object culling pass found in view during one frame, one bit each
+struct SSeenBuffer {
+    uint32_t Buffer = 0;
+    uint32_t WordCount = 0;
+    uint32_t ModelFirstWord = 0;
+    // bits of an older scene point at models which may be gone
+    uint64_t SceneVersion = 0;
+    GLsync Fence = nullptr;
+};
+
 struct SCamera {
 
     glm::vec3 Position = {0.0f, 0.0f, 5.0f};
@@ -195,44 +275,60 @@ struct SImageData {
     std::unique_ptr<std::byte[]> EncodedData = {};
     std::size_t EncodedDataSize = 0;
 
-    std::unique_ptr<unsigned char[]> Data = {};
+    std::shared_ptr<const SMipmapChain> MipmapChain;
+    std::shared_ptr<const SCookedTexture> CookedTexture;
+
+    // hash of the encoded bytes, together with IsSrgb it identifies the image across models
+    uint64_t ContentHash = 0;
+    bool IsSrgb = false;
 
     uint32_t Index = 0;
 };
 
-struct SSamplerData {
-    uint64_t Name;
-    uint32_t MinFilter;
-    uint32_t MagFilter;
-    uint32_t WrapS;
-    uint32_t WrapT;
+struct SPreparedModel {
+    std::shared_ptr<SModelData> ModelData;
+    std::vector<SImageData> Images;
 };
 
-struct SCpuPooledMaterial {
-    size_t MaterialIndex;
+// mega buffers the geometry of all models lives in. positions and normals/uvs share their offsets, one allocator
+// serves both vertex streams. capacities and offsets are in elements
+struct SGeometryPool {
+    SGrowableBuffer VertexPositions;
+    SGrowableBuffer VertexNormalUvs;
+    SGrowableBuffer Indices;
+    SGrowableBuffer Indices16;
+    SOffsetAllocator VertexAllocator;
+    SOffsetAllocator IndexAllocator;
+    SOffsetAllocator Index16Allocator;
 };
 
-struct SCpuPooledPrimitive {
-    size_t VertexCount;
-    size_t VertexOffset;
-    size_t IndexCount;
-    size_t IndexOffset;
+enum class EGeometryStream : uint32_t {
+    Vertices,
+    Indices,
+    Indices16
 };
 
-struct SPrimitive {
-    SCpuPooledPrimitive Primitive;
-    SCpuPooledMaterial Material;
+// a model's range on its way further down in a pool buffer. it is copied in slices over several frames, the model
+// switches over to the destination once the last slice was issued
+struct SGeometryMove {
+    std::string ModelName;
+    EGeometryStream Stream;
+    SOffsetAllocation Source;
+    SOffsetAllocation Destination;
+    uint32_t ElementCount;
+    uint32_t CopiedElementCount;
 };
 
-struct SModelMesh {
-    std::string Name;
-    glm::mat4 WorldMatrix;
-    std::vector<SPrimitive> Primitives;
+struct SDefragmentationStatistics {
+    std::array<float, 3> Fragmentation;
+    std::size_t FrameBytesMoved;
+    std::size_t TotalBytesMoved;
+    uint32_t TotalMoves;
 };
 
-struct SModel {
-    std::string Name;
-    std::vector<SModelMesh> Meshes;
+struct SModelLoadCompletion {
+    std::string ModelName;
+    std::expected<SPreparedModel, std::string> PreparedModel;
 };
 
 constexpr ImVec2 g_imvec2UnitX = ImVec2(1, 0);
@@ -261,14 +357,53 @@ float g_cameraSpeed = 4.0f;
 bool g_cursorIsActive = true;
 bool g_cursorJustEntered = false;
 
-uint32_t g_lastVertexPositionOffset = 0;
-uint32_t g_lastVertexNormalUvOffset = 0;
-uint32_t g_lastIndexOffset = 0;
+constexpr uint32_t g_geometryPoolInitialVertexCount = 256 * 1024;
+constexpr uint32_t g_geometryPoolInitialIndexCount = 4 * 1024 * 1024;
+constexpr uint32_t g_geometryPoolMaxAllocations = 64 * 1024;
+// vertex buffers are bound as storage buffers, drivers don't go beyond 2GB for those
+constexpr std::size_t g_geometryBufferMaxSize = 2ull * 1024 * 1024 * 1024;
+constexpr uint32_t g_objectBufferInitialCapacity = 4096;
+constexpr uint32_t g_materialBufferInitialCapacity = 512;
+// allocations at the end of a pool looked at for a move, per stream and frame
+constexpr std::size_t g_defragmentationCandidateCount = 8;
+
+bool g_isDefragmentationEnabled = true;
+int32_t g_defragmentationBudgetInKiB = 1024;
+bool g_isDefragmentationStressEnabled = false;
+std::optional<SGeometryMove> g_geometryMove;
+SDefragmentationStatistics g_defragmentationStatistics = {};
+
+// every model and every mesh of a model has a node in here, the world matrices of objects come from it
+STransformHierarchy g_transformHierarchy;
+// spins the meshes of all models, keeps every node of the hierarchy moving
+bool g_isTransformAnimationEnabled = false;
+float g_transformAnimationSpeed = 0.5f;
+// objects whose node moved go up in runs of neighbors, more runs than this become one write from the first to the last
+constexpr std::size_t g_maxObjectWriteRanges = 64;
+
+// lod of an object outside of the frustum, nothing of it is drawn
+constexpr uint32_t g_objectLodCulled = 0xFFFFFFFF;
+// frames between the object culling pass setting seen bits and the cpu reading them
+constexpr uint32_t g_seenBufferCount = 2;
 
 SDebugOptions g_debugOptions = {};
 bool g_debugShowMaterialId = false;
+bool g_useFrustumCulling = true;
+// culls objects and picks their lods in a compute pass, the cpu only clears the counts and dispatches
+bool g_useGpuCulling = false;
+// reads back what the gpu pass wrote and compares it with the cpu path every frame, stalls the frame
+bool g_isGpuCullingValidationEnabled = false;
+bool g_useMeshletCulling = true;
+bool g_useLods = true;
+float g_lodErrorThreshold = 1.0f;
+float g_uploadBudgetInMilliseconds = 2.0f;
 
 std::unordered_map<std::string, SModel> g_modelNameToModelMap;
+std::vector<std::future<void>> g_modelLoadTasks;
+SCompletionQueue<SModelLoadCompletion> g_modelLoadCompletions;
+// models placed in the scene, by name. a model shows up once it is ready
+std::vector<std::string> g_sceneModelNames;
+bool g_sceneNeedsUpdate = false;
 std::unordered_map<std::string, SCpuPooledPrimitive> g_primitiveToMeshMap;
 std::unordered_map<std::string, glm::mat4x4> g_primitiveToInitialTransformMap;
 
@@ -279,9 +414,86 @@ std::vector<SGpuMaterial> g_gpuMaterials;
 std::vector<SCpuMaterial> g_cpuMaterials;
 std::vector<uint32_t> g_textures;
 std::vector<uint64_t> g_textureHandles;
-std::unordered_map<uint32_t, size_t> g_samplerNameToSamplerIndexMap;
+std::unordered_map<uint64_t, size_t> g_samplerNameToSamplerIndexMap;
 std::vector<uint32_t> g_samplers;
 
+// textures and materials are shared between models by content. images map to GL textures, textures (image and
+// sampler) to slots in g_textures/g_textureHandles and materials to slots in g_cpuMaterials
+struct STextureResource {
+    size_t TextureIndex;
+    uint64_t ImageKey;
+};
+
+// an image is evicted by deleting its texture and comes back from the texture cache, which only works for cooked
+// images. while reloading, the old texture (if any) stays in use until the uploads of the new one went through
+enum class EImageResidency : uint32_t {
+    Resident,
+    Evicted,
+    Reloading
+};
+
+struct SImageResource {
+    uint32_t Texture = 0;
+    uint64_t ContentHash = 0;
+    bool IsSrgb = false;
+    bool IsReloadable = false;
+    uint32_t LevelCount = 0;
+    // levels dropped from the top of the chain to stay within the budget
+    uint32_t FirstLevel = 0;
+    std::size_t MemorySize = 0;
+    uint64_t LastUsedFrame = 0;
+    EImageResidency Residency = EImageResidency::Resident;
+    uint32_t ReloadTexture = 0;
+    uint32_t ReloadFirstLevel = 0;
+    std::size_t ReloadMemorySize = 0;
+    uint64_t ReloadUploadId = 0;
+    // texture slots sampling the image
+    std::vector<size_t> TextureIndices;
+};
+
+SResourceRegistry<SImageResource> g_imageRegistry;
+SResourceRegistry<STextureResource> g_textureRegistry;
+SResourceRegistry<size_t> g_materialRegistry;
+
+// residency of the bindless handle of every texture slot, parallel to g_textures. materials get the fallback
+// texture for slots whose handle is not resident, nothing ever samples a non-resident handle
+struct STextureResidency {
+    uint64_t ImageKey = 0;
+    uint32_t Sampler = 0;
+    uint64_t LastUsedFrame = 0;
+    bool IsHandleResident = false;
+};
+
+struct STextureReloadCompletion {
+    uint64_t ImageKey;
+    std::shared_ptr<const SCookedTexture> CookedTexture;
+};
+
+struct SResidencyStatistics {
+    std::size_t TextureBytes;
+    std::size_t BufferBytes;
+    uint32_t ResidentHandles;
+    uint32_t EvictedImages;
+    uint32_t TotalEvictions;
+    uint32_t TotalMipDrops;
+    uint32_t TotalReloads;
+};
+
+// handles of slots unused for this many frames are made non-resident, images unused for this many frames may be
+// evicted as a whole instead of losing their top level
+constexpr uint64_t g_residencyHandleIdleFrameCount = 120;
+constexpr uint64_t g_residencyEvictionFrameCount = 600;
+
+std::vector<STextureResidency> g_textureResidencies;
+uint32_t g_fallbackTexture = 0;
+uint64_t g_fallbackTextureHandle = 0;
+// hard ceiling for textures and growable buffers together, TOADWART_GPU_MEMORY_BUDGET_MIB overrides it
+int32_t g_gpuMemoryBudgetInMiB = 4096;
+uint64_t g_residencyFrameIndex = 1;
+std::vector<std::future<void>> g_textureReloadTasks;
+SCompletionQueue<STextureReloadCompletion> g_textureReloadCompletions;
+SResidencyStatistics g_residencyStatistics = {};
+
 float g_sunElevation = 3.0f;
 float g_sunAzimuth = 0.3f;
 glm::vec3 g_sunColor = glm::vec3{1.0f, 1.0f, 1.0f};
@@ -292,61 +504,250 @@ uint32_t g_iconPackageGreen = 0;
 
 bool g_gpuMaterialsNeedUpdate = true;
 
-auto CreateProgram(
+SModelImportSettings g_modelImportSettings = {};
+
+// separable program built from one shader file, together with the pipeline stages using it. the program id
+// changes when the file is reloaded, the pipelines are pointed at the new one
+struct SShaderProgram {
+    uint32_t ShaderType;
+    std::filesystem::path FilePath;
+    std::string Label;
+    std::vector<SShaderDefine> Defines;
+    // the shader file and everything it includes
+    std::vector<std::filesystem::path> FilePaths;
+    uint32_t Program;
+    // pipeline and the stage bits the program is used for in it
+    std::vector<std::pair<uint32_t, uint32_t>> PipelineStages;
+    // the next version of the program while the driver works on it
+    std::optional<SProgramCompile> Compile;
+};
+
+// Simple.fs specialized for one combination of material features
+struct SMaterialPermutation {
+    SShaderProgram* FragmentShader;
+    uint32_t ProgramPipeline;
+};
+
+// a model whose files changed is loaded again under another name next to the old one and takes its place
+// once it is ready. IsStale asks for another reload after this one, the files changed again in the meantime
+struct SModelReload {
+    std::string ReloadModelName;
+    bool IsStale = false;
+};
+
+// by label
+std::unordered_map<std::string, SShaderProgram> g_shaderPrograms;
+// by name of the model being reloaded
+std::unordered_map<std::string, SModelReload> g_modelReloads;
+// files are picked up once they were left alone for this long, editors save in more than one write
+constexpr auto g_hotReloadSettleTime = std::chrono::milliseconds(100);
+constexpr std::string_view g_reloadModelNameSuffix = "@Reload";
+
+// submits the program to the driver, it is usable once FinishShaderPrograms or ProcessShaderProgramCompiles
+// finished it. the program is built again whenever its file or one of the files it includes changes
+auto CreateShaderProgram(
     const uint32_t shaderType,
     const std::string_view filePath,
-    const std::string_view label) -> std::expected<uint32_t, std::string> {
+    const std::string_view label,
+    std::vector<SShaderDefine> defines = {}) -> std::expected<SShaderProgram*, std::string> {
 
-    const auto shaderSource = ReadTextFromFile(filePath);
-    if (shaderSource.empty()) {
-        return std::unexpected(std::format("Either file {} was not found or is empty", filePath));
+    auto programCompile = BeginProgramCompile(shaderType, filePath, label, defines);
+    if (!programCompile) {
+        return std::unexpected(programCompile.error());
     }
-    const auto shaderSourcePtr = shaderSource.data();
-    auto program = glCreateShaderProgramv(shaderType, 1, &shaderSourcePtr);
-    SetDebugLabel(program, GL_PROGRAM, label);
-    glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
 
-    int32_t linkStatus = 0;
-    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
-    if (linkStatus == GL_FALSE)
-    {
-        std::string errorLog;
-        int32_t length = 512;
-        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
-        errorLog.resize(length + 1, '\0');
-        glGetProgramInfoLog(program, length, nullptr, errorLog.data());
-        return std::unexpected(errorLog);
+    auto& shaderProgram = g_shaderPrograms[std::string(label)];
+    shaderProgram = SShaderProgram{
+        .ShaderType = shaderType,
+        .FilePath = GetWatchedFilePath(filePath),
+        .Label = std::string(label),
+        .Defines = std::move(defines),
+        .FilePaths = programCompile->PreprocessedShader.FilePaths,
+        .Program = 0
+    };
+    shaderProgram.Compile = std::move(*programCompile);
+
+    for (const auto& shaderFilePath : shaderProgram.FilePaths) {
+        WatchFile(shaderFilePath);
+    }
+
+    return &shaderProgram;
+}
+
+// takes the finished program of the pending compile and points the pipelines at it. a failed compile leaves
+// the previous program in place
+auto FinishShaderProgramCompile(SShaderProgram& shaderProgram) -> std::expected<void, std::string> {
+
+    auto program = FinishProgramCompile(*shaderProgram.Compile);
+    shaderProgram.Compile.reset();
+    if (!program) {
+        return std::unexpected(std::format("{}:\n{}", shaderProgram.Label, program.error()));
+    }
+
+    for (const auto& [programPipeline, stageBits] : shaderProgram.PipelineStages) {
+        glUseProgramStages(programPipeline, stageBits, *program);
+    }
+    glDeleteProgram(shaderProgram.Program);
+    shaderProgram.Program = *program;
+    return {};
+}
+
+// waits for every program still compiling, for startup
+auto FinishShaderPrograms() -> std::expected<void, std::string> {
+
+    for (auto& [shaderProgramLabel, shaderProgram] : g_shaderPrograms) {
+        if (!shaderProgram.Compile.has_value()) {
+            continue;
+        }
+        if (auto result = FinishShaderProgramCompile(shaderProgram); !result) {
+            return result;
+        }
     }
+    return {};
+}
 
-    return program;
+auto UseProgramStage(
+    const uint32_t programPipeline,
+    const uint32_t stageBits,
+    SShaderProgram& shaderProgram) -> void {
+
+    glUseProgramStages(programPipeline, stageBits, shaderProgram.Program);
+    shaderProgram.PipelineStages.emplace_back(programPipeline, stageBits);
 }
 
 auto CreateGraphicsProgramPipeline(
     const std::string_view label,
-    const uint32_t vertexShader,
-    const uint32_t fragmentShader) -> uint32_t {
+    SShaderProgram& vertexShader,
+    SShaderProgram& fragmentShader) -> uint32_t {
 
     uint32_t programPipeline = 0;
     glCreateProgramPipelines(1, &programPipeline);
     SetDebugLabel(programPipeline, GL_PROGRAM_PIPELINE, label);
-    glUseProgramStages(programPipeline, GL_VERTEX_SHADER_BIT, vertexShader);
-    glUseProgramStages(programPipeline, GL_FRAGMENT_SHADER_BIT, fragmentShader);
+    UseProgramStage(programPipeline, GL_VERTEX_SHADER_BIT, vertexShader);
+    UseProgramStage(programPipeline, GL_FRAGMENT_SHADER_BIT, fragmentShader);
 
     return programPipeline;
 }
 
 auto CreateComputeProgramPipeline(
     const std::string_view label,
-    const uint32_t computeShader) -> uint32_t {
+    SShaderProgram& computeShader) -> uint32_t {
 
     uint32_t programPipeline = 0;
     glCreateProgramPipelines(1, &programPipeline);
-    SetDebugLabel(GL_PROGRAM_PIPELINE, programPipeline, label);
-    glUseProgramStages(programPipeline, GL_COMPUTE_SHADER_BIT, computeShader);
+    SetDebugLabel(programPipeline, GL_PROGRAM_PIPELINE, label);
+    UseProgramStage(programPipeline, GL_COMPUTE_SHADER_BIT, computeShader);
 
     return programPipeline;
 }
 
+auto GetMaterialFeatures(const SCpuMaterial& cpuMaterial) -> uint32_t {
+
+    auto materialFeatures = 0u;
+    if (cpuMaterial.BaseTextureIndex.has_value()) {
+        materialFeatures |= g_materialFeatureBaseTexture;
+    }
+    if (cpuMaterial.NormalTextureIndex.has_value()) {
+        materialFeatures |= g_materialFeatureNormalTexture;
+    }
+    if (cpuMaterial.OcclusionTextureIndex.has_value()) {
+        materialFeatures |= g_materialFeatureOcclusionTexture;
+    }
+    if (cpuMaterial.MetallicRoughnessTextureIndex.has_value()) {
+        materialFeatures |= g_materialFeatureMetallicRoughnessTexture;
+    }
+    if (cpuMaterial.EmissiveTextureIndex.has_value()) {
+        materialFeatures |= g_materialFeatureEmissiveTexture;
+    }
+    return materialFeatures;
+}
+
+// the permutation is submitted to the driver and can't draw before ProcessShaderProgramCompiles finished it,
+// its pipeline has no fragment stage until then
+auto CreateMaterialPermutation(
+    SShaderProgram& vertexShader,
+    const uint32_t materialFeatures) -> std::expected<SMaterialPermutation, std::string> {
+
+    constexpr std::array<std::pair<uint32_t, std::string_view>, 5> materialFeatureDefines = {{
+        { g_materialFeatureBaseTexture, "HAS_BASE_TEXTURE" },
+        { g_materialFeatureNormalTexture, "HAS_NORMAL_TEXTURE" },
+        { g_materialFeatureOcclusionTexture, "HAS_OCCLUSION_TEXTURE" },
+        { g_materialFeatureMetallicRoughnessTexture, "HAS_METALLIC_ROUGHNESS_TEXTURE" },
+        { g_materialFeatureEmissiveTexture, "HAS_EMISSIVE_TEXTURE" }
+    }};
+
+    std::vector<SShaderDefine> defines;
+    for (const auto& [materialFeature, defineName] : materialFeatureDefines) {
+        if ((materialFeatures & materialFeature) != 0) {
+            defines.push_back(SShaderDefine{ .Name = std::string(defineName), .Value = "1" });
+        }
+    }
+
+    const auto label = std::format("Simple.fs.glsl#{:02x}", materialFeatures);
+    auto fragmentShader = CreateShaderProgram(GL_FRAGMENT_SHADER, "data/shaders/Simple.fs.glsl", label, std::move(defines));
+    if (!fragmentShader) {
+        return std::unexpected(fragmentShader.error());
+    }
+
+    return SMaterialPermutation{
+        .FragmentShader = *fragmentShader,
+        .ProgramPipeline = CreateGraphicsProgramPipeline(std::format("SimplePipeline#{:02x}", materialFeatures), vertexShader, **fragmentShader)
+    };
+}
+
+// programs built from a changed file are submitted again, ProcessShaderProgramCompiles swaps them in once the
+// driver is done. a change while a program is still compiling starts it over
+auto ReloadShaderPrograms(std::span<const std::filesystem::path> changedFilePaths) -> void {
+
+    for (auto& [shaderProgramLabel, shaderProgram] : g_shaderPrograms) {
+
+        const auto isChanged = std::ranges::any_of(shaderProgram.FilePaths, [&](const std::filesystem::path& shaderFilePath) {
+            return std::ranges::find(changedFilePaths, shaderFilePath) != changedFilePaths.end();
+        });
+        if (!isChanged) {
+            continue;
+        }
+
+        if (shaderProgram.Compile.has_value()) {
+            AbortProgramCompile(*shaderProgram.Compile);
+            shaderProgram.Compile.reset();
+        }
+
+        auto programCompile = BeginProgramCompile(shaderProgram.ShaderType, shaderProgram.FilePath, shaderProgram.Label, shaderProgram.Defines);
+        if (!programCompile) {
+            spdlog::error("Hot reload: {} failed, keeping the previous program\n{}", shaderProgram.Label, programCompile.error());
+            continue;
+        }
+
+        // the includes may have changed along with the file
+        shaderProgram.FilePaths = programCompile->PreprocessedShader.FilePaths;
+        for (const auto& shaderFilePath : shaderProgram.FilePaths) {
+            WatchFile(shaderFilePath);
+        }
+        shaderProgram.Compile = std::move(*programCompile);
+    }
+}
+
+auto ProcessShaderProgramCompiles() -> void {
+
+    for (auto& [shaderProgramLabel, shaderProgram] : g_shaderPrograms) {
+
+        if (!shaderProgram.Compile.has_value() || !IsProgramCompileComplete(*shaderProgram.Compile)) {
+            continue;
+        }
+
+        // programs created while running, material permutations, are finished here the first time as well
+        const auto isReload = shaderProgram.Program != 0;
+        if (auto result = FinishShaderProgramCompile(shaderProgram); !result) {
+            spdlog::error("{}{}", isReload ? "Hot reload: keeping the previous program of " : "", result.error());
+            continue;
+        }
+        if (isReload) {
+            spdlog::info("Hot reload: rebuilt {} for {} pipeline stages", shaderProgram.Label, shaderProgram.PipelineStages.size());
+        }
+    }
+}
+
 auto OnKey(
     GLFWwindow* window,
     const int32_t key,
@@ -414,6 +815,14 @@ auto OnOpenGLDebugMessage(
     }
 }
 
+// every field goes into the hash, the name of a sampler is what GetOrCreateSampler shares samplers by
+auto GetSamplerDataHash(const SSamplerData& samplerData) -> uint64_t {
+    auto hash = Hash64(&samplerData.MinFilter, sizeof(samplerData.MinFilter));
+    hash = HashCombine(hash, samplerData.MagFilter);
+    hash = HashCombine(hash, samplerData.WrapS);
+    return HashCombine(hash, samplerData.WrapT);
+}
+
 auto GetOrCreateSampler(SSamplerData samplerData) -> uint32_t {
     if (g_samplerNameToSamplerIndexMap.contains(samplerData.Name)) {
         return g_samplers[g_samplerNameToSamplerIndexMap[samplerData.Name]];
@@ -544,315 +953,1035 @@ auto EncodeNormal(glm::vec3 normal) -> glm::vec2 {
         : encodedNormal;
 }
 
+auto GetVertexCount(
+    const fastgltf::Asset& model,
+    const fastgltf::Primitive& primitive) -> size_t {
+
+    return model.accessors[primitive.findAttribute("POSITION")->second].count;
+}
+
+auto GetIndexCount(
+    const fastgltf::Asset& model,
+    const fastgltf::Primitive& primitive) -> size_t {
+
+    return primitive.indicesAccessor.has_value()
+        ? model.accessors[primitive.indicesAccessor.value()].count
+        : GetVertexCount(model, primitive);
+}
+
+// raw elements of an accessor inside its loaded buffer
+struct SAccessorView {
+    const std::byte* Data = nullptr;
+    std::size_t Stride = 0;
+    std::size_t Count = 0;
+    fastgltf::AccessorType Type = fastgltf::AccessorType::Invalid;
+    fastgltf::ComponentType ComponentType = fastgltf::ComponentType::Invalid;
+    bool IsNormalized = false;
+};
+
+// nullopt for sparse accessors and buffers fastgltf didn't load, those go through fastgltf's accessor tools instead
+auto GetAccessorView(
+    const fastgltf::Asset& model,
+    const fastgltf::Accessor& accessor) -> std::optional<SAccessorView> {
+
+    if (accessor.sparse.has_value() || !accessor.bufferViewIndex.has_value()) {
+        return std::nullopt;
+    }
+
+    const auto& bufferView = model.bufferViews[accessor.bufferViewIndex.value()];
+    const auto& buffer = model.buffers[bufferView.bufferIndex];
+
+    const std::byte* bufferData = nullptr;
+    std::size_t bufferSize = 0;
+    if (const auto* array = std::get_if<fastgltf::sources::Array>(&buffer.data)) {
+        bufferData = reinterpret_cast<const std::byte*>(array->bytes.data());
+        bufferSize = array->bytes.size();
+    } else if (const auto* vector = std::get_if<fastgltf::sources::Vector>(&buffer.data)) {
+        bufferData = reinterpret_cast<const std::byte*>(vector->bytes.data());
+        bufferSize = vector->bytes.size();
+    } else {
+        return std::nullopt;
+    }
+
+    const auto elementSize = fastgltf::getElementByteSize(accessor.type, accessor.componentType);
+    const auto stride = bufferView.byteStride.has_value()
+        ? bufferView.byteStride.value()
+        : elementSize;
+    const auto offset = bufferView.byteOffset + accessor.byteOffset;
+    if (accessor.count > 0 && offset + (accessor.count - 1) * stride + elementSize > bufferSize) {
+        return std::nullopt;
+    }
+
+    return SAccessorView{
+        .Data = bufferData + offset,
+        .Stride = stride,
+        .Count = accessor.count,
+        .Type = accessor.type,
+        .ComponentType = accessor.componentType,
+        .IsNormalized = accessor.normalized
+    };
+}
+
+// tightly packed elements of exactly the type we store are copied in one go
+template <typename TElement>
+auto IsAccessorBulkCopyable(
+    const SAccessorView& accessorView,
+    fastgltf::AccessorType type,
+    fastgltf::ComponentType componentType) -> bool {
+
+    return accessorView.Type == type &&
+        accessorView.ComponentType == componentType &&
+        accessorView.Stride == sizeof(TElement);
+}
+
+template <typename TComponent>
+inline auto ReadAccessorComponent(
+    const std::byte* element,
+    glm::length_t componentIndex,
+    bool isNormalized) -> float {
+
+    TComponent value;
+    std::memcpy(&value, element + componentIndex * sizeof(TComponent), sizeof(TComponent));
+    if constexpr (std::is_floating_point_v<TComponent>) {
+        return static_cast<float>(value);
+    } else {
+        return isNormalized
+            ? std::max(static_cast<float>(value) / static_cast<float>(std::numeric_limits<TComponent>::max()), -1.0f)
+            : static_cast<float>(value);
+    }
+}
+
+// the component type is resolved once per accessor, the loop body only sees fixed types and the inlined
+// convert call, which leaves the compiler free to vectorize it
+template <glm::length_t TComponentCount, typename TComponent, typename TConvert>
+auto ConvertAccessorElements(
+    const SAccessorView& accessorView,
+    TConvert&& convert) -> void {
+
+    for (std::size_t index = 0; index < accessorView.Count; index++) {
+        const auto* element = accessorView.Data + index * accessorView.Stride;
+        glm::vec<TComponentCount, float> value;
+        for (glm::length_t componentIndex = 0; componentIndex < TComponentCount; componentIndex++) {
+            value[componentIndex] = ReadAccessorComponent<TComponent>(element, componentIndex, accessorView.IsNormalized);
+        }
+        convert(value, index);
+    }
+}
+
+template <glm::length_t TComponentCount, typename TConvert>
+auto ConvertAccessor(
+    const SAccessorView& accessorView,
+    TConvert&& convert) -> bool {
+
+    if (fastgltf::getNumComponents(accessorView.Type) != TComponentCount) {
+        return false;
+    }
+
+    switch (accessorView.ComponentType) {
+        case fastgltf::ComponentType::Float: ConvertAccessorElements<TComponentCount, float>(accessorView, convert); return true;
+        case fastgltf::ComponentType::Byte: ConvertAccessorElements<TComponentCount, int8_t>(accessorView, convert); return true;
+        case fastgltf::ComponentType::UnsignedByte: ConvertAccessorElements<TComponentCount, uint8_t>(accessorView, convert); return true;
+        case fastgltf::ComponentType::Short: ConvertAccessorElements<TComponentCount, int16_t>(accessorView, convert); return true;
+        case fastgltf::ComponentType::UnsignedShort: ConvertAccessorElements<TComponentCount, uint16_t>(accessorView, convert); return true;
+        default: return false;
+    }
+}
+
+template <typename TIndex>
+auto WidenIndices(
+    const SAccessorView& accessorView,
+    std::span<uint32_t> indices) -> void {
+
+    for (std::size_t index = 0; index < accessorView.Count; index++) {
+        TIndex value;
+        std::memcpy(&value, accessorView.Data + index * accessorView.Stride, sizeof(TIndex));
+        indices[index] = value;
+    }
+}
+
+// every attribute is read straight from the glTF buffer into the model streams
 auto GetVertices(
     const fastgltf::Asset& model, 
-    const fastgltf::Primitive& primitive) -> std::pair<std::vector<SVertexPosition>, std::vector<SVertexNormalUv>> {
+    const fastgltf::Primitive& primitive,
+    std::span<glm::vec3> verticesPosition,
+    std::span<SVertexNormalUv> verticesNormalUv) -> void {
 
-    std::vector<glm::vec3> positions;
     auto& positionAccessor = model.accessors[primitive.findAttribute("POSITION")->second];
-    positions.resize(positionAccessor.count);
-    fastgltf::iterateAccessorWithIndex<glm::vec3>(model,
-                                                  positionAccessor,
-                                                  [&](glm::vec3 position, std::size_t index) { positions[index] = position; });
+    auto storePosition = [&](const glm::vec3& position, std::size_t index) { verticesPosition[index] = position; };
+    auto positionView = GetAccessorView(model, positionAccessor);
+    if (positionView.has_value() && IsAccessorBulkCopyable<glm::vec3>(*positionView, fastgltf::AccessorType::Vec3, fastgltf::ComponentType::Float)) {
+        std::memcpy(verticesPosition.data(), positionView->Data, positionView->Count * sizeof(glm::vec3));
+    } else if (!positionView.has_value() || !ConvertAccessor<3>(*positionView, storePosition)) {
+        fastgltf::iterateAccessorWithIndex<glm::vec3>(model, positionAccessor, storePosition);
+    }
 
-    std::vector<glm::vec3> normals;
+    // normals are octahedral encoded on the fly, there is nothing to bulk copy into
     auto& normalAccessor = model.accessors[primitive.findAttribute("NORMAL")->second];
-    normals.resize(normalAccessor.count);
-    fastgltf::iterateAccessorWithIndex<glm::vec3>(model,
-                                                  normalAccessor,
-                                                  [&](glm::vec3 normal, std::size_t index) { normals[index] = normal; });
+    auto storeNormal = [&](const glm::vec3& normal, std::size_t index) { verticesNormalUv[index].Normal = glm::packSnorm2x16(EncodeNormal(normal)); };
+    auto normalView = GetAccessorView(model, normalAccessor);
+    if (!normalView.has_value() || !ConvertAccessor<3>(*normalView, storeNormal)) {
+        fastgltf::iterateAccessorWithIndex<glm::vec3>(model, normalAccessor, storeNormal);
+    }
 
-    std::vector<glm::vec2> uvs;
     if (primitive.findAttribute("TEXCOORD_0") != primitive.attributes.end())
     {
         auto& uvAccessor = model.accessors[primitive.findAttribute("TEXCOORD_0")->second];
-        uvs.resize(uvAccessor.count);
-        fastgltf::iterateAccessorWithIndex<glm::vec2>(model,
-                                                    uvAccessor,
-                                                    [&](glm::vec2 uv, std::size_t index)
-                                                    { uvs[index] = uv; });
+        auto storeUv = [&](const glm::vec2& uv, std::size_t index) { verticesNormalUv[index].Uv = SVertexNormalUv::EncodeUv(uv); };
+        auto uvView = GetAccessorView(model, uvAccessor);
+        if (!uvView.has_value() || !ConvertAccessor<2>(*uvView, storeUv)) {
+            fastgltf::iterateAccessorWithIndex<glm::vec2>(model, uvAccessor, storeUv);
+        }
     }
     else
     {
-        uvs.resize(positions.size(), {});
-    }
-
-    std::vector<SVertexPosition> verticesPosition;
-    std::vector<SVertexNormalUv> verticesNormalUv;
-    verticesPosition.resize(positions.size());
-    verticesNormalUv.resize(positions.size());
-
-    for (size_t i = 0; i < positions.size(); i++) {
-        verticesPosition[i] = {
-            positions[i],
-        };        
-        verticesNormalUv[i] = {
-            glm::packSnorm2x16(EncodeNormal(normals[i])),
-            uvs[i]
-        };
+        for (auto& vertexNormalUv : verticesNormalUv) {
+            vertexNormalUv.Uv = SVertexNormalUv::EncodeUv(glm::vec2(0.0f));
+        }
     }
-
-    return {verticesPosition, verticesNormalUv};
 }
 
 auto GetIndices(
     const fastgltf::Asset& model,
-    const fastgltf::Primitive& primitive) -> std::vector<uint32_t> {
+    const fastgltf::Primitive& primitive,
+    std::span<uint32_t> indices) -> void {
+
+    if (!primitive.indicesAccessor.has_value()) {
+        std::iota(indices.begin(), indices.end(), 0u);
+        return;
+    }
 
-    auto indices = std::vector<uint32_t>();
     auto& accessor = model.accessors[primitive.indicesAccessor.value()];
-    indices.resize(accessor.count);
+    auto accessorView = GetAccessorView(model, accessor);
+    if (accessorView.has_value()) {
+        if (IsAccessorBulkCopyable<uint32_t>(*accessorView, fastgltf::AccessorType::Scalar, fastgltf::ComponentType::UnsignedInt)) {
+            std::memcpy(indices.data(), accessorView->Data, accessorView->Count * sizeof(uint32_t));
+            return;
+        }
+        switch (accessorView->ComponentType) {
+            case fastgltf::ComponentType::UnsignedByte: WidenIndices<uint8_t>(*accessorView, indices); return;
+            case fastgltf::ComponentType::UnsignedShort: WidenIndices<uint16_t>(*accessorView, indices); return;
+            case fastgltf::ComponentType::UnsignedInt: WidenIndices<uint32_t>(*accessorView, indices); return;
+            default: break;
+        }
+    }
+
     fastgltf::iterateAccessorWithIndex<uint32_t>(model, accessor, [&](uint32_t value, size_t index)
     {
         indices[index] = value;
     });
-    return indices;
-}
-
-auto CalculateMipmapLevels(int32_t width, int32_t height) -> int32_t {
-    return 1 + floor(log2(glm::max(width, height)));
 }
 
-auto CreateImageData(
-    const void* data, 
-    std::size_t dataSize, 
-    fastgltf::MimeType mimeType,
-    std::string_view name) -> SImageData {
+auto AnalyzeMesh(
+    std::span<const glm::vec3> verticesPosition,
+    std::span<const uint32_t> indices) -> SMeshStatistics {
 
-    auto dataCopy = std::make_unique<std::byte[]>(dataSize);
-    std::copy_n(static_cast<const std::byte*>(data), dataSize, dataCopy.get());
+    if (verticesPosition.empty() || indices.empty()) {
+        return SMeshStatistics{
+            .VertexCount = static_cast<uint32_t>(verticesPosition.size())
+        };
+    }
 
-    return SImageData {
-        .Name = std::string(name),
-        .EncodedData = std::move(dataCopy),
-        .EncodedDataSize = dataSize,
+    constexpr uint32_t vertexCacheSize = 16;
+    auto vertexCacheStatistics = meshopt_analyzeVertexCache(
+        indices.data(),
+        indices.size(),
+        verticesPosition.size(),
+        vertexCacheSize, 0, 0);
+    auto overdrawStatistics = meshopt_analyzeOverdraw(
+        indices.data(),
+        indices.size(),
+        &verticesPosition[0].x,
+        verticesPosition.size(),
+        sizeof(glm::vec3));
+
+    return SMeshStatistics{
+        .VertexCount = static_cast<uint32_t>(verticesPosition.size()),
+        .Acmr = vertexCacheStatistics.acmr,
+        .Atvr = vertexCacheStatistics.atvr,
+        .Overdraw = overdrawStatistics.overdraw
     };
 }
 
-auto BitfieldExtract(int32_t a, int32_t b, int32_t c) -> int32_t
-{
-  int mask = ~(0xffffffff << c);
-  if (b > 0)
-    return (a >> (b - 1)) & mask;
-  else
-    return a & mask;
-}
+// welds vertices which are identical in position and encoded normal and uv, plenty of exporters emit one vertex
+// per triangle corner. returns the number of unique vertices, they are moved to the front of the streams
+auto WeldVertices(
+    std::span<glm::vec3> verticesPosition,
+    std::span<SVertexNormalUv> verticesNormalUv,
+    std::span<uint32_t> indices) -> size_t {
 
-auto GetPooledMaterial(
-    uint32_t megaMaterialBuffer,
-    uint32_t materialIndex) -> SCpuPooledMaterial {
-    
-    SCpuPooledMaterial pooledMaterial {
-        .MaterialIndex = materialIndex
-    };
-    return std::move(pooledMaterial);
+    if (verticesPosition.empty() || indices.empty()) {
+        return verticesPosition.size();
+    }
+
+    const std::array<meshopt_Stream, 2> streams = {{
+        { verticesPosition.data(), sizeof(glm::vec3), sizeof(glm::vec3) },
+        { verticesNormalUv.data(), sizeof(SVertexNormalUv), sizeof(SVertexNormalUv) }
+    }};
+
+    std::vector<uint32_t> remap(verticesPosition.size());
+    auto vertexCount = meshopt_generateVertexRemapMulti(
+        remap.data(),
+        indices.data(),
+        indices.size(),
+        verticesPosition.size(),
+        streams.data(),
+        streams.size());
+    meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+    meshopt_remapVertexBuffer(verticesPosition.data(), verticesPosition.data(), verticesPosition.size(), sizeof(glm::vec3), remap.data());
+    meshopt_remapVertexBuffer(verticesNormalUv.data(), verticesNormalUv.data(), verticesNormalUv.size(), sizeof(SVertexNormalUv), remap.data());
+
+    return vertexCount;
 }
 
-auto GetPooledPrimitive(
-    uint32_t megaVertexBufferPosition,
-    uint32_t megaVertexBufferNormalUv,
-    uint32_t megaIndexBuffer,
-    const fastgltf::Asset& fgAsset,
-    const fastgltf::Primitive& fgPrimitive) -> SCpuPooledPrimitive {
+// reorders triangles for the post transform cache and overdraw, then vertices for fetch locality.
+// returns the number of vertices still referenced, unreferenced ones are dropped from the end
+auto OptimizeMesh(
+    std::span<glm::vec3> verticesPosition,
+    std::span<SVertexNormalUv> verticesNormalUv,
+    std::span<uint32_t> indices) -> size_t {
 
-    const auto& [verticesPosition, verticesNormalUv] = GetVertices(fgAsset, fgPrimitive);
-    auto indices = GetIndices(fgAsset, fgPrimitive);
+    if (verticesPosition.empty() || indices.empty()) {
+        return verticesPosition.size();
+    }
 
-    SCpuPooledPrimitive pooledPrimitive = {
-        .VertexCount = verticesPosition.size(),
-        .VertexOffset = g_lastVertexPositionOffset,
-        .IndexCount = indices.size(),
-        .IndexOffset = g_lastIndexOffset,
-    };
+    constexpr float overdrawThreshold = 1.05f;
+    meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), verticesPosition.size());
+    meshopt_optimizeOverdraw(
+        indices.data(),
+        indices.data(),
+        indices.size(),
+        &verticesPosition[0].x,
+        verticesPosition.size(),
+        sizeof(glm::vec3),
+        overdrawThreshold);
+
+    std::vector<uint32_t> remap(verticesPosition.size());
+    auto vertexCount = meshopt_optimizeVertexFetchRemap(remap.data(), indices.data(), indices.size(), verticesPosition.size());
+    meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+    meshopt_remapVertexBuffer(verticesPosition.data(), verticesPosition.data(), verticesPosition.size(), sizeof(glm::vec3), remap.data());
+    meshopt_remapVertexBuffer(verticesNormalUv.data(), verticesNormalUv.data(), verticesNormalUv.size(), sizeof(SVertexNormalUv), remap.data());
+
+    return vertexCount;
+}
 
-    auto verticesPositionSizeInBytes = sizeof(SVertexPosition) * verticesPosition.size();
-    auto verticesNormalUvSizeInBytes = sizeof(SVertexNormalUv) * verticesNormalUv.size();
-    auto indicesSizeInBytes = sizeof(uint32_t) * indices.size();
+// splits a primitive into meshlets and rewrites its indices in meshlet order, so every meshlet
+// is a contiguous index range of the primitive and the primitive itself still draws as a whole
+auto BuildMeshlets(
+    std::span<const glm::vec3> verticesPosition,
+    std::span<uint32_t> indices) -> std::vector<SMeshlet> {
 
-    glNamedBufferSubData(megaVertexBufferPosition, g_lastVertexPositionOffset * sizeof(SVertexPosition), verticesPositionSizeInBytes, verticesPosition.data());
-    glNamedBufferSubData(megaVertexBufferNormalUv, g_lastVertexNormalUvOffset * sizeof(SVertexNormalUv), verticesNormalUvSizeInBytes, verticesNormalUv.data());
-    glNamedBufferSubData(megaIndexBuffer, g_lastIndexOffset * sizeof(uint32_t), indicesSizeInBytes, indices.data());
+    if (verticesPosition.empty() || indices.empty()) {
+        return {};
+    }
 
-    g_lastVertexPositionOffset += verticesPosition.size();
-    g_lastVertexNormalUvOffset += verticesNormalUv.size();
-    g_lastIndexOffset += indices.size();
+    constexpr size_t maxVertices = 64;
+    constexpr size_t maxTriangles = 124;
+    constexpr float coneWeight = 0.25f;
+
+    const auto maxMeshletCount = meshopt_buildMeshletsBound(indices.size(), maxVertices, maxTriangles);
+    std::vector<meshopt_Meshlet> meshlets(maxMeshletCount);
+    std::vector<uint32_t> meshletVertices(maxMeshletCount * maxVertices);
+    std::vector<uint8_t> meshletTriangles(maxMeshletCount * maxTriangles * 3);
+
+    const auto meshletCount = meshopt_buildMeshlets(
+        meshlets.data(),
+        meshletVertices.data(),
+        meshletTriangles.data(),
+        indices.data(),
+        indices.size(),
+        &verticesPosition[0].x,
+        verticesPosition.size(),
+        sizeof(glm::vec3),
+        maxVertices,
+        maxTriangles,
+        coneWeight);
+
+    std::vector<SMeshlet> primitiveMeshlets;
+    primitiveMeshlets.reserve(meshletCount);
+
+    uint32_t indexOffset = 0;
+    for (const auto& meshlet : std::span(meshlets).first(meshletCount)) {
+
+        auto bounds = meshopt_computeMeshletBounds(
+            &meshletVertices[meshlet.vertex_offset],
+            &meshletTriangles[meshlet.triangle_offset],
+            meshlet.triangle_count,
+            &verticesPosition[0].x,
+            verticesPosition.size(),
+            sizeof(glm::vec3));
+
+        primitiveMeshlets.push_back(SMeshlet{
+            .Center = glm::make_vec3(bounds.center),
+            .Radius = bounds.radius,
+            .ConeApex = glm::make_vec3(bounds.cone_apex),
+            .ConeCutoff = bounds.cone_cutoff,
+            .ConeAxis = glm::make_vec3(bounds.cone_axis),
+            .IndexOffset = indexOffset,
+            .IndexCount = meshlet.triangle_count * 3
+        });
+
+        for (size_t index = 0; index < meshlet.triangle_count * 3; index++) {
+            indices[indexOffset++] = meshletVertices[meshlet.vertex_offset + meshletTriangles[meshlet.triangle_offset + index]];
+        }
+    }
 
-    return std::move(pooledPrimitive);
+    return primitiveMeshlets;
 }
 
-inline auto PolarToCartesian(float elevation, float azimuth) -> glm::vec3 {
-    return {
-        std::sin(elevation) * std::cos(azimuth), 
-        std::cos(elevation),
-        std::sin(elevation) * std::sin(azimuth)
-    };
-}
+// box around the vertices and the sphere around the center of the box, in object space
+auto GetBounds(std::span<const glm::vec3> verticesPosition) -> SBounds {
 
-auto AddModelFromFile(
-    const std::string& modelName,
-    std::filesystem::path filePath,
-    const uint32_t megaVertexBufferPosition,
-    const uint32_t megaVertexBufferNormalUv,
-    const uint32_t megaIndexBuffer,
-    const uint32_t megaMaterialBuffer) -> void {
+    if (verticesPosition.empty()) {
+        return SBounds{};
+    }
 
-    TOADWART_PROFILE_SCOPED();
-    if (g_modelNameToModelMap.contains(modelName))
-    {
-        return;
+    auto minimum = verticesPosition[0];
+    auto maximum = verticesPosition[0];
+    for (const auto& vertexPosition : verticesPosition) {
+        minimum = glm::min(minimum, vertexPosition);
+        maximum = glm::max(maximum, vertexPosition);
     }
 
-    SModel model = {};
-    
-    fastgltf::Parser parser(fastgltf::Extensions::KHR_mesh_quantization);
+    const auto center = (minimum + maximum) * 0.5f;
+    auto radius = 0.0f;
+    for (const auto& vertexPosition : verticesPosition) {
+        radius = glm::max(radius, glm::distance(center, vertexPosition));
+    }
 
-    constexpr auto gltfOptions =
-        fastgltf::Options::DontRequireValidAssetMember |
-        fastgltf::Options::AllowDouble |
-        fastgltf::Options::LoadGLBBuffers |
-        fastgltf::Options::LoadExternalBuffers
-        /*
-         |
-        fastgltf::Options::LoadExternalImages*/;
+    return SBounds{
+        .Center = center,
+        .Extent = (maximum - minimum) * 0.5f,
+        .Radius = radius
+    };
+}
 
-    fastgltf::GltfDataBuffer data;
-    data.loadFromFile(filePath);
+// simplifies a primitive into up to maxLodCount - 1 coarser index ranges, each one aiming for half the triangles of
+// the previous. lods are appended to lodIndices, lod 0 is not part of the result. stops early once the simplifier
+// can't make meaningful progress anymore (borders, seams) or the error gets too large to ever be useful
+auto BuildLods(
+    std::span<const glm::vec3> verticesPosition,
+    std::span<const uint32_t> indices,
+    std::vector<uint32_t>& lodIndices) -> std::vector<SPrimitiveLod> {
 
-    auto assetResult = parser.loadGltf(&data, filePath.parent_path(), gltfOptions);
-    if (assetResult.error() != fastgltf::Error::None)
-    {
-        spdlog::error("fastgltf: Failed to load glTF: {}", fastgltf::getErrorMessage(assetResult.error()));
-        return;
+    if (verticesPosition.empty() || indices.empty()) {
+        return {};
     }
 
-    auto& fgAsset = assetResult.get();
+    constexpr size_t maxLodCount = 5;
+    constexpr size_t minIndexCount = 3 * 32;
+    constexpr float maxRelativeError = 0.1f;
+    constexpr float minReduction = 0.85f;
 
-    auto imageDates = std::vector<SImageData>(fgAsset.images.size());
-    const auto imageIndices = std::ranges::iota_view{(std::size_t)0, fgAsset.images.size()};
+    const auto errorScale = meshopt_simplifyScale(&verticesPosition[0].x, verticesPosition.size(), sizeof(glm::vec3));
 
-    std::transform(poolstl::execution::par, imageIndices.begin(), imageIndices.end(), imageDates.begin(), [&](size_t imageIndex) {
+    std::vector<SPrimitiveLod> lods;
+    std::vector<uint32_t> simplifiedIndices(indices.size());
+    auto previousIndexCount = indices.size();
 
-        TOADWART_PROFILE_NAMED_SCOPE("Load Image");
-        const auto& fgImage = fgAsset.images[imageIndex];
-        TOADWART_PROFILE_NAMED_SIZED_SCOPE(fgImage.name.c_str(), fgImage.name.size());
+    for (size_t lodIndex = 1; lodIndex < maxLodCount; lodIndex++) {
 
-        auto imageData = [&] {
+        const auto targetIndexCount = (indices.size() >> lodIndex) / 3 * 3;
+        if (targetIndexCount < minIndexCount) {
+            break;
+        }
 
-            if (const auto* filePathUri = std::get_if<fastgltf::sources::URI>(&fgImage.data)) {
+        // always simplify from lod 0, chaining lods would accumulate the error of every step
+        auto relativeError = 0.0f;
+        const auto simplifiedIndexCount = meshopt_simplify(
+            simplifiedIndices.data(),
+            indices.data(),
+            indices.size(),
+            &verticesPosition[0].x,
+            verticesPosition.size(),
+            sizeof(glm::vec3),
+            targetIndexCount,
+            maxRelativeError,
+            0,
+            &relativeError);
+
+        if (simplifiedIndexCount == 0 || simplifiedIndexCount > previousIndexCount * minReduction) {
+            break;
+        }
 
-                auto filePathFixed = std::filesystem::path(filePathUri->uri.path());
-                auto filePathParent = filePath.parent_path();
-                if (filePathFixed.is_relative()) {
-                    filePathFixed = filePath.parent_path() / filePathFixed;
-                }
-                auto fileData = ReadBinaryFromFile(filePathFixed);
-                return CreateImageData(fileData.first.get(), fileData.second, filePathUri->mimeType, fgImage.name);
+        meshopt_optimizeVertexCache(simplifiedIndices.data(), simplifiedIndices.data(), simplifiedIndexCount, verticesPosition.size());
+
+        lods.push_back(SPrimitiveLod{
+            .IndexOffset = static_cast<uint32_t>(lodIndices.size()),
+            .IndexCount = static_cast<uint32_t>(simplifiedIndexCount),
+            .Error = relativeError * errorScale
+        });
+        lodIndices.insert(lodIndices.end(), simplifiedIndices.begin(), simplifiedIndices.begin() + simplifiedIndexCount);
+        previousIndexCount = simplifiedIndexCount;
+    }
+
+    return lods;
+}
+
+auto CreateImageData(
+    const void* data, 
+    std::size_t dataSize, 
+    std::string_view name) -> SImageData {
+
+    auto dataCopy = std::make_unique<std::byte[]>(dataSize);
+    std::copy_n(static_cast<const std::byte*>(data), dataSize, dataCopy.get());
+
+    return SImageData {
+        .Name = std::string(name),
+        .EncodedData = std::move(dataCopy),
+        .EncodedDataSize = dataSize,
+    };
+}
+
+// storage is allocated right away, the levels are streamed in by the upload queue
+// firstLevel skips the biggest levels of the chain, the texture starts at that level
+auto CreateTextureFromCookedTexture(
+    const std::shared_ptr<const SCookedTexture>& cookedTexturePtr,
+    uint32_t firstLevel = 0) -> uint32_t {
+
+    const auto& cookedTexture = *cookedTexturePtr;
+    const auto levels = std::span(cookedTexture.Levels).subspan(std::min<std::size_t>(firstLevel, cookedTexture.Levels.size() - 1));
+    const auto internalFormat = cookedTexture.Format == ECookedTextureFormat::Bc7
+        ? (cookedTexture.IsSrgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM)
+        : (cookedTexture.IsSrgb ? GL_SRGB8_ALPHA8 : GL_RGBA8);
+
+    uint32_t textureId = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &textureId);
+    SetDebugLabel(textureId, GL_TEXTURE, std::to_string(textureId));
+    glTextureStorage2D(textureId, static_cast<int32_t>(levels.size()), internalFormat, levels.front().Width, levels.front().Height);
+
+    for (auto level = 0; const auto& cookedTextureLevel : levels) {
+        EnqueueTextureUpload(
+            textureId,
+            level++,
+            cookedTextureLevel.Width,
+            cookedTextureLevel.Height,
+            cookedTexture.Format == ECookedTextureFormat::Bc7,
+            internalFormat,
+            std::span(cookedTexture.Data).subspan(cookedTextureLevel.Offset, cookedTextureLevel.Size),
+            cookedTexturePtr);
+    }
+
+    return textureId;
+}
+
+auto CreateTextureFromMipmapChain(const std::shared_ptr<const SMipmapChain>& mipmapChainPtr) -> uint32_t {
+
+    const auto& mipmapChain = *mipmapChainPtr;
+
+    uint32_t textureId = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &textureId);
+    SetDebugLabel(textureId, GL_TEXTURE, std::to_string(textureId));
+    glTextureStorage2D(
+        textureId,
+        static_cast<int32_t>(mipmapChain.Levels.size()),
+        mipmapChain.IsSrgb ? GL_SRGB8_ALPHA8 : GL_RGBA8,
+        mipmapChain.Width,
+        mipmapChain.Height);
+
+    for (auto level = 0; const auto& mipmapLevel : mipmapChain.Levels) {
+        EnqueueTextureUpload(
+            textureId,
+            level++,
+            mipmapLevel.Width,
+            mipmapLevel.Height,
+            false,
+            GL_RGBA8,
+            std::as_bytes(std::span(mipmapChain.Pixels)).subspan(mipmapLevel.Offset, mipmapLevel.Size),
+            mipmapChainPtr);
+    }
+
+    return textureId;
+}
+
+auto GetGpuMemoryBudgetInBytes() -> std::size_t {
+    return static_cast<std::size_t>(std::max(g_gpuMemoryBudgetInMiB, 1)) * 1024 * 1024;
+}
+
+auto GetCookedTextureMemorySize(
+    const SCookedTexture& cookedTexture,
+    uint32_t firstLevel) -> std::size_t {
+
+    std::size_t memorySize = 0;
+    for (auto level = firstLevel; level < cookedTexture.Levels.size(); level++) {
+        memorySize += cookedTexture.Levels[level].Size;
+    }
+    return memorySize;
+}
+
+auto GetTextureMemorySize() -> std::size_t {
+
+    std::size_t memorySize = 0;
+    for (const auto& [imageKey, imageEntry] : g_imageRegistry.Entries) {
+        const auto& imageResource = imageEntry.Resource;
+        if (imageResource.Texture != 0) {
+            memorySize += imageResource.MemorySize;
+        }
+        if (imageResource.ReloadTexture != 0) {
+            memorySize += imageResource.ReloadMemorySize;
+        }
+    }
+    return memorySize;
+}
+
+// the texture cache has the image, the texture comes back starting at firstLevel
+auto RequestImageReload(
+    uint64_t imageKey,
+    SImageResource& imageResource,
+    uint32_t firstLevel) -> void {
+
+    imageResource.Residency = EImageResidency::Reloading;
+    imageResource.ReloadFirstLevel = firstLevel;
+    g_textureReloadTasks.push_back(std::async(std::launch::async, [imageKey, contentHash = imageResource.ContentHash, isSrgb = imageResource.IsSrgb] {
+        std::shared_ptr<const SCookedTexture> cookedTexture;
+        if (auto loadedTexture = LoadCookedTexture(contentHash, isSrgb)) {
+            cookedTexture = std::make_shared<const SCookedTexture>(std::move(*loadedTexture));
+        }
+        g_textureReloadCompletions.Push(STextureReloadCompletion{
+            .ImageKey = imageKey,
+            .CookedTexture = std::move(cookedTexture)
+        });
+    }));
+}
+
+auto MakeTextureResident(size_t textureIndex) -> void {
+
+    auto& textureResidency = g_textureResidencies[textureIndex];
+    textureResidency.LastUsedFrame = g_residencyFrameIndex;
+    if (textureResidency.IsHandleResident || textureResidency.ImageKey == 0) {
+        return;
+    }
+
+    auto imageEntry = g_imageRegistry.Entries.find(textureResidency.ImageKey);
+    if (imageEntry == g_imageRegistry.Entries.end()) {
+        return;
+    }
+    auto& imageResource = imageEntry->second.Resource;
+    imageResource.LastUsedFrame = g_residencyFrameIndex;
+    if (imageResource.Texture == 0) {
+        // the handle follows once the reload is through
+        if (imageResource.Residency == EImageResidency::Evicted) {
+            RequestImageReload(textureResidency.ImageKey, imageResource, imageResource.FirstLevel);
+        }
+        return;
+    }
+
+    auto textureHandle = static_cast<uint64_t>(imageResource.Texture);
+    if (!g_isRunningInRenderDoc) {
+        textureHandle = glGetTextureSamplerHandleARB(imageResource.Texture, textureResidency.Sampler);
+        glMakeTextureHandleResidentARB(textureHandle);
+    }
+
+    g_textures[textureIndex] = imageResource.Texture;
+    g_textureHandles[textureIndex] = textureHandle;
+    textureResidency.IsHandleResident = true;
+    g_gpuMaterialsNeedUpdate = true;
+}
+
+auto MakeTextureNonResident(size_t textureIndex) -> void {
+
+    auto& textureResidency = g_textureResidencies[textureIndex];
+    if (!textureResidency.IsHandleResident) {
+        return;
+    }
+
+    if (!g_isRunningInRenderDoc) {
+        glMakeTextureHandleNonResidentARB(g_textureHandles[textureIndex]);
+    }
+    textureResidency.IsHandleResident = false;
+    g_gpuMaterialsNeedUpdate = true;
+}
+
+auto EvictImage(SImageResource& imageResource) -> void {
+
+    for (auto textureIndex : imageResource.TextureIndices) {
+        MakeTextureNonResident(textureIndex);
+        g_textures[textureIndex] = 0;
+        g_textureHandles[textureIndex] = 0;
+    }
+
+    glDeleteTextures(1, &imageResource.Texture);
+    imageResource.Texture = 0;
+    imageResource.MemorySize = 0;
+    imageResource.Residency = EImageResidency::Evicted;
+    g_residencyStatistics.TotalEvictions++;
+}
+
+auto TouchMaterial(size_t materialIndex) -> void {
+
+    const auto& cpuMaterial = g_cpuMaterials[materialIndex];
+    for (const auto& textureIndex : {
+        cpuMaterial.BaseTextureIndex,
+        cpuMaterial.NormalTextureIndex,
+        cpuMaterial.OcclusionTextureIndex,
+        cpuMaterial.MetallicRoughnessTextureIndex,
+        cpuMaterial.EmissiveTextureIndex }) {
+        if (textureIndex.has_value() && *textureIndex < g_textureResidencies.size()) {
+            MakeTextureResident(*textureIndex);
+        }
+    }
+}
+
+// swaps in reloaded textures, makes idle handles non-resident and sheds texture memory, least recently used first,
+// until textures and growable buffers fit the budget again
+auto UpdateResidency() -> void {
+
+    std::erase_if(g_textureReloadTasks, [](const std::future<void>& textureReloadTask) {
+        return textureReloadTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    });
+
+    for (auto& completion : g_textureReloadCompletions.PopAll()) {
+        auto imageEntry = g_imageRegistry.Entries.find(completion.ImageKey);
+        if (imageEntry == g_imageRegistry.Entries.end()) {
+            continue;
+        }
+        auto& imageResource = imageEntry->second.Resource;
+        if (completion.CookedTexture == nullptr) {
+            // the cache lost the image, whatever is left of it stays as it is
+            spdlog::warn("Residency: unable to reload image {:016x} from the texture cache", imageResource.ContentHash);
+            imageResource.IsReloadable = false;
+            imageResource.Residency = imageResource.Texture != 0 ? EImageResidency::Resident : EImageResidency::Evicted;
+            continue;
+        }
+
+        imageResource.ReloadFirstLevel = std::min<uint32_t>(imageResource.ReloadFirstLevel, completion.CookedTexture->Levels.size() - 1);
+        imageResource.ReloadTexture = CreateTextureFromCookedTexture(completion.CookedTexture, imageResource.ReloadFirstLevel);
+        imageResource.ReloadMemorySize = GetCookedTextureMemorySize(*completion.CookedTexture, imageResource.ReloadFirstLevel);
+        imageResource.ReloadUploadId = GetLastUploadId();
+        imageResource.LevelCount = static_cast<uint32_t>(completion.CookedTexture->Levels.size());
+        g_residencyStatistics.TotalReloads++;
+    }
+
+    for (auto& [imageKey, imageEntry] : g_imageRegistry.Entries) {
+        auto& imageResource = imageEntry.Resource;
+        if (imageResource.ReloadTexture == 0 || !IsUploadSubmitted(imageResource.ReloadUploadId)) {
+            continue;
+        }
+
+        // handles are bound to the texture they were made for, every slot which had one gets a new one
+        std::vector<size_t> textureIndicesToRestore;
+        for (auto textureIndex : imageResource.TextureIndices) {
+            const auto& textureResidency = g_textureResidencies[textureIndex];
+            if (textureResidency.IsHandleResident ||
+                g_residencyFrameIndex - textureResidency.LastUsedFrame < g_residencyHandleIdleFrameCount) {
+                textureIndicesToRestore.push_back(textureIndex);
             }
-            if (const auto* vector = std::get_if<fastgltf::sources::Array>(&fgImage.data)) {
+            MakeTextureNonResident(textureIndex);
+        }
+
+        glDeleteTextures(1, &imageResource.Texture);
+        imageResource.Texture = std::exchange(imageResource.ReloadTexture, 0);
+        imageResource.MemorySize = std::exchange(imageResource.ReloadMemorySize, 0);
+        imageResource.FirstLevel = imageResource.ReloadFirstLevel;
+        imageResource.Residency = EImageResidency::Resident;
+        for (auto textureIndex : imageResource.TextureIndices) {
+            g_textures[textureIndex] = imageResource.Texture;
+        }
+        for (auto textureIndex : textureIndicesToRestore) {
+            MakeTextureResident(textureIndex);
+        }
+    }
+
+    for (size_t textureIndex = 0; textureIndex < g_textureResidencies.size(); textureIndex++) {
+        const auto& textureResidency = g_textureResidencies[textureIndex];
+        if (textureResidency.IsHandleResident &&
+            g_residencyFrameIndex - textureResidency.LastUsedFrame >= g_residencyHandleIdleFrameCount) {
+            MakeTextureNonResident(textureIndex);
+        }
+    }
 
-                return CreateImageData(vector->bytes.data(), vector->bytes.size(), vector->mimeType, fgImage.name);
+    const auto budgetInBytes = GetGpuMemoryBudgetInBytes();
+    const auto bufferBytes = GetGrowableBufferMemorySize();
+    auto textureBytes = GetTextureMemorySize();
+
+    if (bufferBytes + textureBytes > budgetInBytes) {
+        std::vector<std::pair<uint64_t, SImageResource*>> candidates;
+        for (auto& [imageKey, imageEntry] : g_imageRegistry.Entries) {
+            auto& imageResource = imageEntry.Resource;
+            if (imageResource.Residency == EImageResidency::Resident && imageResource.IsReloadable && imageResource.Texture != 0) {
+                candidates.emplace_back(imageKey, &imageResource);
             }
-            if (const auto* vector = std::get_if<fastgltf::sources::Vector>(&fgImage.data)) {
+        }
+        std::ranges::sort(candidates, {}, [](const auto& candidate) { return candidate.second->LastUsedFrame; });
 
-                return CreateImageData(vector->bytes.data(), vector->bytes.size(), vector->mimeType, fgImage.name);
+        for (auto& [imageKey, imageResource] : candidates) {
+            if (bufferBytes + textureBytes <= budgetInBytes) {
+                break;
             }
-            if (const auto* view = std::get_if<fastgltf::sources::BufferView>(&fgImage.data)) {
-
-                auto& bufferView = fgAsset.bufferViews[view->bufferViewIndex];
-                auto& buffer = fgAsset.buffers[bufferView.bufferIndex];
-                if (const auto* vector = std::get_if<fastgltf::sources::Array>(&buffer.data)) {
-                    return CreateImageData(
-                        vector->bytes.data() + bufferView.byteOffset, 
-                        buffer.byteLength,
-                        view->mimeType,
-                        fgImage.name);
-                }
 
+            const auto isIdle = g_residencyFrameIndex - imageResource->LastUsedFrame >= g_residencyEvictionFrameCount;
+            if (isIdle) {
+                textureBytes -= imageResource->MemorySize;
+                EvictImage(*imageResource);
+            } else if (imageResource->FirstLevel + 1 < imageResource->LevelCount) {
+                // the next level is a quarter of the current top level, the chain below it shrinks the same way
+                textureBytes -= imageResource->MemorySize - imageResource->MemorySize / 4;
+                RequestImageReload(imageKey, *imageResource, imageResource->FirstLevel + 1);
+                g_residencyStatistics.TotalMipDrops++;
             }
-            
-            return SImageData{};
-        }();
+        }
+    } else if ((bufferBytes + textureBytes) * 10 < budgetInBytes * 9) {
+        // room to spare, one image in use gets a level back per frame
+        for (auto& [imageKey, imageEntry] : g_imageRegistry.Entries) {
+            auto& imageResource = imageEntry.Resource;
+            if (imageResource.Residency == EImageResidency::Resident &&
+                imageResource.FirstLevel > 0 &&
+                imageResource.IsReloadable &&
+                g_residencyFrameIndex - imageResource.LastUsedFrame < g_residencyHandleIdleFrameCount &&
+                bufferBytes + textureBytes + imageResource.MemorySize * 4 < budgetInBytes) {
+                RequestImageReload(imageKey, imageResource, imageResource.FirstLevel - 1);
+                break;
+            }
+        }
+    }
 
-        //spdlog::info("Trying to load image {}", fgImage.name);
+    g_residencyStatistics.TextureBytes = GetTextureMemorySize();
+    g_residencyStatistics.BufferBytes = bufferBytes;
+    g_residencyStatistics.ResidentHandles = static_cast<uint32_t>(std::ranges::count_if(g_textureResidencies, &STextureResidency::IsHandleResident));
+    g_residencyStatistics.EvictedImages = static_cast<uint32_t>(std::ranges::count_if(g_imageRegistry.Entries, [](const auto& imageEntry) {
+        return imageEntry.second.Resource.Residency == EImageResidency::Evicted;
+    }));
+}
 
-        int32_t width = 0;
-        int32_t height = 0;
-        int32_t components = 0;
-        auto* pixels = stbi_load_from_memory(
-            reinterpret_cast<const unsigned char*>(imageData.EncodedData.get()),
-            static_cast<int32_t>(imageData.EncodedDataSize),
-            &width,
-            &height,
-            &components, 4);
-        
-        imageData.Width = width;
-        imageData.Height = height;
-        imageData.Components = components;
-        imageData.Data.reset(pixels);
-        imageData.Index = static_cast<uint32_t>(imageIndex);
+auto BitfieldExtract(int32_t a, int32_t b, int32_t c) -> int32_t
+{
+  int mask = ~(0xffffffff << c);
+  if (b > 0)
+    return (a >> (b - 1)) & mask;
+  else
+    return a & mask;
+}
 
-        return imageData;
-    });
+auto GetPooledMaterial(
+    uint32_t megaMaterialBuffer,
+    uint32_t materialIndex) -> SCpuPooledMaterial {
+    
+    SCpuPooledMaterial pooledMaterial {
+        .MaterialIndex = materialIndex
+    };
+    return std::move(pooledMaterial);
+}
 
-    auto samplerDates = std::vector<SSamplerData>(fgAsset.samplers.size());
-    const auto samplerIndices = std::ranges::iota_view{(std::size_t)0, fgAsset.samplers.size()};
-    std::transform(poolstl::execution::par, samplerIndices.begin(), samplerIndices.end(), samplerDates.begin(), [&](size_t samplerIndex) {
+auto GetPooledPrimitive(
+    const SModelDataPrimitive& modelPrimitive,
+    uint32_t baseVertexOffset,
+    uint32_t baseIndexOffset) -> SCpuPooledPrimitive {
 
-        const fastgltf::Sampler& fgSampler = fgAsset.samplers[samplerIndex];
+    SCpuPooledPrimitive pooledPrimitive = {
+        .VertexCount = modelPrimitive.VertexCount,
+        .VertexOffset = baseVertexOffset + modelPrimitive.VertexOffset,
+        .IndexCount = modelPrimitive.IndexCount,
+        .IndexOffset = baseIndexOffset + modelPrimitive.IndexOffset,
+        .IndexType = modelPrimitive.IndexType
+    };
 
-        auto hash1 = std::hash<uint32_t>()(fgSampler.minFilter.has_value() ? static_cast<uint32_t>(fgSampler.minFilter.value()) : GL_NEAREST);
-        auto hash2 = std::hash<uint32_t>()(fgSampler.magFilter.has_value() ? static_cast<uint32_t>(fgSampler.magFilter.value()) : GL_NEAREST);
-        auto hash3 = std::hash<uint32_t>()(static_cast<uint32_t>(fgSampler.wrapS));
-        auto hash4 = std::hash<uint32_t>()(static_cast<uint32_t>(fgSampler.wrapT));
-        auto hash = hash1 ^ (hash2 << 1) ^ (hash3 << 2) ^ (hash4 << 3);
-        
-        return SSamplerData{
-            .Name = hash,
-            .MinFilter = fgSampler.minFilter.has_value() ? static_cast<uint32_t>(fgSampler.minFilter.value()) : GL_NEAREST,
-            .MagFilter = fgSampler.magFilter.has_value() ? static_cast<uint32_t>(fgSampler.magFilter.value()) : GL_NEAREST,
-            .WrapS = static_cast<uint32_t>(fgSampler.wrapS),
-            .WrapT = static_cast<uint32_t>(fgSampler.wrapT)
-        };
-    });    
+    return std::move(pooledPrimitive);
+}
+
+inline auto PolarToCartesian(float elevation, float azimuth) -> glm::vec3 {
+    return {
+        std::sin(elevation) * std::cos(azimuth), 
+        std::cos(elevation),
+        std::sin(elevation) * std::sin(azimuth)
+    };
+}
+
+// welding and optimizing leave unused vertices at the end of each primitive's slice, this closes the gaps.
+// indices are relative to the first vertex of their primitive and stay untouched
+auto CompactVertices(SModelData& modelData) -> void {
 
-    for (auto textureIndex = 0; auto& fgTexture : fgAsset.textures) {
+    TOADWART_PROFILE_SCOPED();
 
-        auto imageIndex = fgTexture.imageIndex.has_value() ? fgTexture.imageIndex.value() : 0;
-        auto& imageData = imageDates[imageIndex];
+    uint32_t vertexOffset = 0;
+    for (auto& modelPrimitive : modelData.Primitives) {
+
+        // slices only ever move towards the front, copying forward is safe
+        std::copy_n(
+            modelData.ImportedVertexPositions.begin() + modelPrimitive.VertexOffset,
+            modelPrimitive.VertexCount,
+            modelData.ImportedVertexPositions.begin() + vertexOffset);
+        std::copy_n(
+            modelData.ImportedVertexNormalUvs.begin() + modelPrimitive.VertexOffset,
+            modelPrimitive.VertexCount,
+            modelData.ImportedVertexNormalUvs.begin() + vertexOffset);
+
+        modelPrimitive.VertexOffset = vertexOffset;
+        vertexOffset += modelPrimitive.VertexCount;
+    }
 
-        TOADWART_PROFILE_NAMED_SCOPE("Create Textures");
-        TOADWART_PROFILE_NAMED_SIZED_SCOPE(imageData.Name.c_str(), imageData.Name.size());
+    modelData.ImportedVertexPositions.resize(vertexOffset);
+    modelData.ImportedVertexNormalUvs.resize(vertexOffset);
+}
+
+// moves the indices of every primitive with less than 64k vertices, lods included, into the 16 bit index stream.
+// indices are relative to the first vertex of their primitive, so the vertex count alone decides
+auto PackIndices(SModelData& modelData) -> void {
+
+    TOADWART_PROFILE_SCOPED();
+
+    constexpr size_t maxVertexCount16 = size_t{1} << 16;
+
+    std::vector<uint32_t> indices;
+    std::vector<uint16_t> indices16;
+    indices.reserve(modelData.ImportedIndices.size());
+
+    for (auto& modelPrimitive : modelData.Primitives) {
+
+        modelPrimitive.IndexType = modelPrimitive.VertexCount <= maxVertexCount16
+            ? EIndexType::UnsignedShort
+            : EIndexType::UnsignedInt;
+
+        for (auto& lod : std::span(modelData.Lods).subspan(modelPrimitive.LodOffset, modelPrimitive.LodCount)) {
+
+            const auto lodIndices = std::span(modelData.ImportedIndices).subspan(lod.IndexOffset, lod.IndexCount);
+            if (modelPrimitive.IndexType == EIndexType::UnsignedShort) {
+                lod.IndexOffset = static_cast<uint32_t>(indices16.size());
+                std::transform(lodIndices.begin(), lodIndices.end(), std::back_inserter(indices16), [](uint32_t index) {
+                    return static_cast<uint16_t>(index);
+                });
+            } else {
+                lod.IndexOffset = static_cast<uint32_t>(indices.size());
+                indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+            }
+        }
+
+        modelPrimitive.IndexOffset = modelData.Lods[modelPrimitive.LodOffset].IndexOffset;
+    }
+
+    spdlog::info("{}: {} indices stored as 16 bit, {} as 32 bit", modelData.Name, indices16.size(), indices.size());
+
+    modelData.ImportedIndices = std::move(indices);
+    modelData.ImportedIndices16 = std::move(indices16);
+}
+
+auto ImportModelFromGltf(
+    const std::filesystem::path& filePath,
+    const SModelImportSettings& importSettings) -> std::expected<SModelData, std::string> {
+
+    TOADWART_PROFILE_SCOPED();
+
+    if (!std::filesystem::exists(filePath)) {
+        return std::unexpected(std::format("File {} was not found", filePath.string()));
+    }
+
+    SModelData modelData = {};
+    modelData.Name = filePath.string();
+    modelData.ImportSettings = importSettings;
 
-        if (imageData.Data == nullptr) {
+    auto [fileData, fileDataSize] = ReadBinaryFromFile(filePath);
+    modelData.Dependencies.push_back(CreateModelDataDependency(filePath, {fileData.get(), fileDataSize}));
+
+    fastgltf::Parser parser(fastgltf::Extensions::KHR_mesh_quantization);
+
+    // external buffers are read below instead of by fastgltf, the model cache has to know which files we depend on
+    constexpr auto gltfOptions =
+        fastgltf::Options::DontRequireValidAssetMember |
+        fastgltf::Options::AllowDouble |
+        fastgltf::Options::LoadGLBBuffers
+        /*
+         |
+        fastgltf::Options::LoadExternalImages*/;
+
+    fastgltf::GltfDataBuffer data;
+    data.copyBytes(reinterpret_cast<const uint8_t*>(fileData.get()), fileDataSize);
+
+    auto assetResult = parser.loadGltf(&data, filePath.parent_path(), gltfOptions);
+    if (assetResult.error() != fastgltf::Error::None)
+    {
+        return std::unexpected(std::format("fastgltf: Failed to load glTF: {}", fastgltf::getErrorMessage(assetResult.error())));
+    }
+
+    auto& fgAsset = assetResult.get();
+
+    for (auto& fgBuffer : fgAsset.buffers) {
+
+        const auto* bufferUri = std::get_if<fastgltf::sources::URI>(&fgBuffer.data);
+        if (bufferUri == nullptr) {
             continue;
         }
 
-        auto samplerIndex = fgTexture.samplerIndex.has_value() ? fgTexture.samplerIndex.value() : 0;        
-        auto& samplerData = samplerDates[samplerIndex];
+        auto bufferFilePath = std::filesystem::path(bufferUri->uri.path());
+        if (bufferFilePath.is_relative()) {
+            bufferFilePath = filePath.parent_path() / bufferFilePath;
+        }
+        if (!std::filesystem::exists(bufferFilePath)) {
+            return std::unexpected(std::format("Buffer {} of {} was not found", bufferFilePath.string(), filePath.string()));
+        }
 
-        auto sampler = GetOrCreateSampler(samplerData);
+        fastgltf::sources::Vector bufferData = {};
+        bufferData.mimeType = fastgltf::MimeType::GltfBuffer;
+        bufferData.bytes.resize(std::filesystem::file_size(bufferFilePath));
 
-        uint32_t textureId = 0;
-        glCreateTextures(GL_TEXTURE_2D, 1, &textureId);
-        SetDebugLabel(textureId, GL_TEXTURE, std::to_string(textureId));
-        glTextureStorage2D(textureId, CalculateMipmapLevels(imageData.Width, imageData.Height), GL_SRGB8_ALPHA8, imageData.Width, imageData.Height);
-        glTextureSubImage2D(textureId, 0, 0, 0, imageData.Width, imageData.Height, GL_RGBA, imageData.PixelType, imageData.Data.get());
-        glGenerateTextureMipmap(textureId);
-        imageData.Data.release();
+        std::ifstream bufferFile{bufferFilePath, std::ifstream::binary};
+        bufferFile.read(reinterpret_cast<char*>(bufferData.bytes.data()), static_cast<std::streamsize>(bufferData.bytes.size()));
 
-        if (g_isRunningInRenderDoc) {
-            g_textures.push_back(textureId);
-            g_textureHandles.push_back(textureId);
+        modelData.Dependencies.push_back(CreateModelDataDependency(bufferFilePath, std::as_bytes(std::span(bufferData.bytes))));
+        fgBuffer.data = std::move(bufferData);
+    }
 
-        } else {
-            auto textureHandle = glGetTextureSamplerHandleARB(textureId, sampler);
-            glMakeTextureHandleResidentARB(textureHandle);
+    modelData.Images.resize(fgAsset.images.size());
+    for (auto imageIndex = 0; auto& fgImage : fgAsset.images) {
+
+        auto& modelImage = modelData.Images[imageIndex++];
+        modelImage.Name = fgImage.name;
+
+        auto copyEncodedData = [&](const void* encodedData, std::size_t encodedDataSize) {
+            const auto* encodedBytes = static_cast<const std::byte*>(encodedData);
+            modelImage.EncodedData.assign(encodedBytes, encodedBytes + encodedDataSize);
+        };
+
+        if (const auto* filePathUri = std::get_if<fastgltf::sources::URI>(&fgImage.data)) {
+
+            auto filePathFixed = std::filesystem::path(filePathUri->uri.path());
+            if (filePathFixed.is_relative()) {
+                filePathFixed = filePath.parent_path() / filePathFixed;
+            }
+            modelImage.FilePath = std::move(filePathFixed);
+        }
+        if (const auto* vector = std::get_if<fastgltf::sources::Array>(&fgImage.data)) {
+
+            copyEncodedData(vector->bytes.data(), vector->bytes.size());
+        }
+        if (const auto* vector = std::get_if<fastgltf::sources::Vector>(&fgImage.data)) {
+
+            copyEncodedData(vector->bytes.data(), vector->bytes.size());
+        }
+        if (const auto* view = std::get_if<fastgltf::sources::BufferView>(&fgImage.data)) {
 
-            g_textures.push_back(textureId);
-            g_textureHandles.push_back(textureHandle);
+            auto& bufferView = fgAsset.bufferViews[view->bufferViewIndex];
+            auto& buffer = fgAsset.buffers[bufferView.bufferIndex];
+            if (const auto* vector = std::get_if<fastgltf::sources::Array>(&buffer.data)) {
+                copyEncodedData(vector->bytes.data() + bufferView.byteOffset, bufferView.byteLength);
+            }
+            if (const auto* vector = std::get_if<fastgltf::sources::Vector>(&buffer.data)) {
+                copyEncodedData(vector->bytes.data() + bufferView.byteOffset, bufferView.byteLength);
+            }
         }
     }
 
+    modelData.Samplers.resize(fgAsset.samplers.size());
+    const auto samplerIndices = std::ranges::iota_view{(std::size_t)0, fgAsset.samplers.size()};
+    std::transform(poolstl::execution::par, samplerIndices.begin(), samplerIndices.end(), modelData.Samplers.begin(), [&](size_t samplerIndex) {
+
+        const fastgltf::Sampler& fgSampler = fgAsset.samplers[samplerIndex];
+
+        auto samplerData = SSamplerData{
+            .MinFilter = fgSampler.minFilter.has_value() ? static_cast<uint32_t>(fgSampler.minFilter.value()) : GL_NEAREST,
+            .MagFilter = fgSampler.magFilter.has_value() ? static_cast<uint32_t>(fgSampler.magFilter.value()) : GL_NEAREST,
+            .WrapS = static_cast<uint32_t>(fgSampler.wrapS),
+            .WrapT = static_cast<uint32_t>(fgSampler.wrapT)
+        };
+        samplerData.Name = GetSamplerDataHash(samplerData);
+        return samplerData;
+    });
+
+    for (auto& fgTexture : fgAsset.textures) {
+
+        modelData.Textures.push_back(SModelDataTexture{
+            .ImageIndex = static_cast<uint32_t>(fgTexture.imageIndex.has_value() ? fgTexture.imageIndex.value() : 0),
+            .SamplerIndex = static_cast<uint32_t>(fgTexture.samplerIndex.has_value() ? fgTexture.samplerIndex.value() : 0)
+        });
+    }
+
     for (auto& fgMaterial : fgAsset.materials) {
 
         SCpuMaterial cpuMaterial;
@@ -876,14 +2005,19 @@ auto AddModelFromFile(
             cpuMaterial.EmissiveTextureIndex = std::move(fgMaterial.emissiveTexture.value().textureIndex);
         }
 
-        g_cpuMaterials.push_back(cpuMaterial);
+        modelData.Materials.push_back(cpuMaterial);
     }
 
+    // flatten the node hierarchy first, vertex and index counts are known from the accessors so every primitive
+    // gets its slice of the model streams up front (prefix sum) and can be converted independently afterwards
+
+    std::vector<const fastgltf::Primitive*> fgPrimitives;
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+
     std::stack<std::pair<const fastgltf::Node*, glm::mat4>> nodeStack;
     glm::mat4 rootTransform = glm::mat4(1.0f);
 
-    model.Name = filePath.string();
-
     for (auto nodeIndex : fgAsset.scenes[0].nodeIndices)
     {
         nodeStack.emplace(&fgAsset.nodes[nodeIndex], rootTransform);
@@ -907,45 +2041,1036 @@ auto AddModelFromFile(
             continue;
         }
 
-        auto meshIndex = fgNode->meshIndex.value();
-        auto& fgMesh = fgAsset.meshes[meshIndex];
-        auto meshName = std::string(fgMesh.name);
+        auto meshIndex = fgNode->meshIndex.value();
+        auto& fgMesh = fgAsset.meshes[meshIndex];
+        auto meshName = std::string(fgMesh.name);
+
+        auto modelMesh = SModelDataMesh{
+            .Name = std::move(meshName),
+            .WorldMatrix = std::move(globalTransform),
+            .PrimitiveOffset = static_cast<uint32_t>(modelData.Primitives.size()),
+            .PrimitiveCount = static_cast<uint32_t>(fgMesh.primitives.size())
+        };
+
+        for (const auto& fgPrimitive : fgMesh.primitives)
+        {
+            const auto primitiveMaterialIndex = fgPrimitive.materialIndex.has_value()
+                ? fgPrimitive.materialIndex.value()
+                : 0;
+
+            const auto primitiveVertexCount = GetVertexCount(fgAsset, fgPrimitive);
+            const auto primitiveIndexCount = GetIndexCount(fgAsset, fgPrimitive);
+
+            modelData.Primitives.push_back(SModelDataPrimitive{
+                .VertexOffset = static_cast<uint32_t>(vertexCount),
+                .VertexCount = static_cast<uint32_t>(primitiveVertexCount),
+                .IndexOffset = static_cast<uint32_t>(indexCount),
+                .IndexCount = static_cast<uint32_t>(primitiveIndexCount),
+                .MaterialIndex = static_cast<uint32_t>(primitiveMaterialIndex)
+            });
+            fgPrimitives.push_back(&fgPrimitive);
+
+            vertexCount += primitiveVertexCount;
+            indexCount += primitiveIndexCount;
+        }
+
+        modelData.Meshes.push_back(std::move(modelMesh));
+    }
+
+    // positions stay float while meshoptimizer works on them, they are quantized into the model stream at the end
+    auto positions = std::vector<glm::vec3>(vertexCount);
+    modelData.ImportedVertexPositions.resize(vertexCount);
+    modelData.ImportedVertexNormalUvs.resize(vertexCount);
+    modelData.ImportedIndices.resize(indexCount);
+
+    auto primitiveMeshlets = std::vector<std::vector<SMeshlet>>(fgPrimitives.size());
+    auto primitiveLods = std::vector<std::vector<SPrimitiveLod>>(fgPrimitives.size());
+    auto primitiveLodIndices = std::vector<std::vector<uint32_t>>(fgPrimitives.size());
+
+    const auto primitiveIndices = std::ranges::iota_view{(std::size_t)0, fgPrimitives.size()};
+    std::for_each(poolstl::execution::par, primitiveIndices.begin(), primitiveIndices.end(), [&](size_t primitiveIndex) {
+
+        TOADWART_PROFILE_NAMED_SCOPE("LoadPrimitive");
+
+        auto& modelPrimitive = modelData.Primitives[primitiveIndex];
+        const auto& fgPrimitive = *fgPrimitives[primitiveIndex];
+
+        auto verticesPosition = std::span(positions).subspan(modelPrimitive.VertexOffset, modelPrimitive.VertexCount);
+        auto verticesNormalUv = std::span(modelData.ImportedVertexNormalUvs).subspan(modelPrimitive.VertexOffset, modelPrimitive.VertexCount);
+        auto indices = std::span(modelData.ImportedIndices).subspan(modelPrimitive.IndexOffset, modelPrimitive.IndexCount);
+
+        GetVertices(fgAsset, fgPrimitive, verticesPosition, verticesNormalUv);
+        GetIndices(fgAsset, fgPrimitive, indices);
+
+        modelPrimitive.Statistics.Imported = AnalyzeMesh(verticesPosition, indices);
+        if (importSettings.WeldVertices) {
+            TOADWART_PROFILE_NAMED_SCOPE("WeldVertices");
+            modelPrimitive.VertexCount = static_cast<uint32_t>(WeldVertices(verticesPosition, verticesNormalUv, indices));
+        }
+        if (importSettings.OptimizeMeshes) {
+            TOADWART_PROFILE_NAMED_SCOPE("OptimizePrimitive");
+            modelPrimitive.VertexCount = static_cast<uint32_t>(OptimizeMesh(
+                verticesPosition.first(modelPrimitive.VertexCount),
+                verticesNormalUv.first(modelPrimitive.VertexCount),
+                indices));
+        }
+        modelPrimitive.Statistics.Optimized = AnalyzeMesh(verticesPosition.first(modelPrimitive.VertexCount), indices);
+
+        const auto bounds = GetBounds(verticesPosition.first(modelPrimitive.VertexCount));
+        modelPrimitive.Center = bounds.Center;
+        modelPrimitive.Radius = bounds.Radius;
+        modelPrimitive.Extent = bounds.Extent;
+
+        // before the meshlets reorder lod 0, the simplifier works on the cache optimized triangle order
+        if (importSettings.GenerateLods) {
+            TOADWART_PROFILE_NAMED_SCOPE("BuildLods");
+            primitiveLods[primitiveIndex] = BuildLods(verticesPosition.first(modelPrimitive.VertexCount), indices, primitiveLodIndices[primitiveIndex]);
+        }
+
+        if (importSettings.GenerateMeshlets) {
+            TOADWART_PROFILE_NAMED_SCOPE("BuildMeshlets");
+            primitiveMeshlets[primitiveIndex] = BuildMeshlets(verticesPosition.first(modelPrimitive.VertexCount), indices);
+        }
+
+        modelPrimitive.Quantization = SVertexPosition::GetQuantization(verticesPosition.first(modelPrimitive.VertexCount));
+        auto encodedVerticesPosition = std::span(modelData.ImportedVertexPositions).subspan(modelPrimitive.VertexOffset, modelPrimitive.VertexCount);
+        std::transform(verticesPosition.begin(), verticesPosition.begin() + modelPrimitive.VertexCount, encodedVerticesPosition.begin(), [&](const glm::vec3& position) {
+            return SVertexPosition::Encode(position, modelPrimitive.Quantization);
+        });
+    });
+
+    for (auto primitiveIndex = 0; auto& modelPrimitive : modelData.Primitives) {
+        auto& meshlets = primitiveMeshlets[primitiveIndex++];
+        modelPrimitive.MeshletOffset = static_cast<uint32_t>(modelData.Meshlets.size());
+        modelPrimitive.MeshletCount = static_cast<uint32_t>(meshlets.size());
+        modelData.Meshlets.insert(modelData.Meshlets.end(), meshlets.begin(), meshlets.end());
+    }
+
+    // coarser lods live behind lod 0 of all primitives, at the end of the model's index stream
+    for (auto primitiveIndex = 0; auto& modelPrimitive : modelData.Primitives) {
+        auto& lods = primitiveLods[primitiveIndex];
+        auto& lodIndices = primitiveLodIndices[primitiveIndex++];
+
+        modelPrimitive.LodOffset = static_cast<uint32_t>(modelData.Lods.size());
+        modelPrimitive.LodCount = static_cast<uint32_t>(lods.size() + 1);
+        modelData.Lods.push_back(SPrimitiveLod{
+            .IndexOffset = modelPrimitive.IndexOffset,
+            .IndexCount = modelPrimitive.IndexCount,
+            .Error = 0.0f
+        });
+
+        const auto lodIndexOffset = static_cast<uint32_t>(modelData.ImportedIndices.size());
+        for (auto& lod : lods) {
+            lod.IndexOffset += lodIndexOffset;
+            modelData.Lods.push_back(lod);
+        }
+        modelData.ImportedIndices.insert(modelData.ImportedIndices.end(), lodIndices.begin(), lodIndices.end());
+    }
+
+    size_t importedVertexCount = 0;
+    size_t weldedVertexCount = 0;
+    for (const auto& modelPrimitive : modelData.Primitives) {
+        importedVertexCount += modelPrimitive.Statistics.Imported.VertexCount;
+        weldedVertexCount += modelPrimitive.VertexCount;
+    }
+    spdlog::info("{}: {} of {} vertices left after welding and optimizing ({:.1f}% removed)",
+        modelData.Name,
+        weldedVertexCount,
+        importedVertexCount,
+        importedVertexCount > 0 ? 100.0 * static_cast<double>(importedVertexCount - weldedVertexCount) / static_cast<double>(importedVertexCount) : 0.0);
+
+    CompactVertices(modelData);
+    PackIndices(modelData);
+
+    modelData.VertexPositions = modelData.ImportedVertexPositions;
+    modelData.VertexNormalUvs = modelData.ImportedVertexNormalUvs;
+    modelData.Indices = modelData.ImportedIndices;
+    modelData.Indices16 = modelData.ImportedIndices16;
+
+    return modelData;
+}
+
+auto LoadModelData(
+    const std::filesystem::path& filePath,
+    const SModelImportSettings& importSettings) -> std::expected<SModelData, std::string> {
+
+    TOADWART_PROFILE_SCOPED();
+
+    const auto loadStartTime = std::chrono::steady_clock::now();
+    auto getElapsedMilliseconds = [&]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStartTime).count();
+    };
+
+    if (auto cachedModelData = LoadModelDataFromCache(filePath, importSettings)) {
+        spdlog::info("Loaded {} from the model cache in {:.2f} ms", filePath.string(), getElapsedMilliseconds());
+        return std::move(*cachedModelData);
+    }
+
+    auto modelDataResult = ImportModelFromGltf(filePath, importSettings);
+    if (!modelDataResult) {
+        return modelDataResult;
+    }
+    spdlog::info("Imported {} in {:.2f} ms", filePath.string(), getElapsedMilliseconds());
+
+    if (!SaveModelDataToCache(filePath, *modelDataResult)) {
+        spdlog::warn("Unable to write the model cache for {}", filePath.string());
+    }
+
+    return modelDataResult;
+}
+
+// everything of a model load which doesn't need the GL context: reading the model cache or importing the model,
+// decoding, mipmapping and cooking its images. safe to run on any thread
+auto PrepareModel(
+    const std::filesystem::path& filePath,
+    const SModelImportSettings& importSettings) -> std::expected<SPreparedModel, std::string> {
+
+    TOADWART_PROFILE_SCOPED();
+
+    auto modelDataResult = LoadModelData(filePath, importSettings);
+    if (!modelDataResult) {
+        return std::unexpected(modelDataResult.error());
+    }
+
+    // the model data stays alive, and its cache file mapped, until the upload queue is done with its streams
+    auto modelDataPtr = std::shared_ptr<SModelData>(new SModelData(std::move(*modelDataResult)), [](SModelData* modelData) {
+        UnmapFile(modelData->MappedFile);
+        delete modelData;
+    });
+    auto& modelData = *modelDataPtr;
+
+    auto imageDates = std::vector<SImageData>(modelData.Images.size());
+    const auto imageIndices = std::ranges::iota_view{(std::size_t)0, modelData.Images.size()};
+
+    // base color and emissive are color and get filtered and sampled as sRGB, everything else is data
+    auto imageIsSrgb = std::vector<uint8_t>(modelData.Images.size(), 0);
+    for (const auto& material : modelData.Materials) {
+        for (const auto& colorTextureIndex : { material.BaseTextureIndex, material.EmissiveTextureIndex }) {
+            if (colorTextureIndex.has_value() && colorTextureIndex.value() < modelData.Textures.size()) {
+                const auto imageIndex = modelData.Textures[colorTextureIndex.value()].ImageIndex;
+                if (imageIndex < imageIsSrgb.size()) {
+                    imageIsSrgb[imageIndex] = 1;
+                }
+            }
+        }
+    }
+
+    // external images are read in one batch up front, the decode workers below only ever wait on the CPU
+    std::vector<std::filesystem::path> imageFilePaths;
+    std::vector<size_t> imageFileIndices(modelData.Images.size(), std::numeric_limits<size_t>::max());
+    for (auto imageIndex = 0; const auto& modelImage : modelData.Images) {
+        if (!modelImage.FilePath.empty()) {
+            imageFileIndices[imageIndex] = imageFilePaths.size();
+            imageFilePaths.push_back(modelImage.FilePath);
+        }
+        imageIndex++;
+    }
+    auto imageFileDates = ReadBinaryFromFiles(imageFilePaths);
+
+    std::transform(poolstl::execution::par, imageIndices.begin(), imageIndices.end(), imageDates.begin(), [&](size_t imageIndex) {
+
+        TOADWART_PROFILE_NAMED_SCOPE("Load Image");
+        const auto& modelImage = modelData.Images[imageIndex];
+        TOADWART_PROFILE_NAMED_SIZED_SCOPE(modelImage.Name.c_str(), modelImage.Name.size());
+
+        auto imageData = [&] {
+
+            if (!modelImage.FilePath.empty()) {
+
+                // every image owns its own entry of the batch, the buffer is taken over as is
+                auto& fileData = imageFileDates[imageFileIndices[imageIndex]];
+                return SImageData{
+                    .Name = modelImage.Name,
+                    .EncodedData = std::move(fileData.first),
+                    .EncodedDataSize = fileData.second
+                };
+            }
+
+            return CreateImageData(modelImage.EncodedData.data(), modelImage.EncodedData.size(), modelImage.Name);
+        }();
+
+        imageData.Index = static_cast<uint32_t>(imageIndex);
+
+        // cooked textures come with their mip chain and are already block compressed, no decode needed
+        const auto contentHash = Hash64(imageData.EncodedData.get(), imageData.EncodedDataSize);
+        const auto isSrgb = imageIsSrgb[imageIndex] != 0;
+        imageData.ContentHash = contentHash;
+        imageData.IsSrgb = isSrgb;
+        if (auto cookedTexture = LoadCookedTexture(contentHash, isSrgb)) {
+            imageData.CookedTexture = std::make_shared<const SCookedTexture>(std::move(*cookedTexture));
+            return imageData;
+        }
+
+        //spdlog::info("Trying to load image {}", modelImage.Name);
+
+        int32_t width = 0;
+        int32_t height = 0;
+        int32_t components = 0;
+        auto* pixels = stbi_load_from_memory(
+            reinterpret_cast<const unsigned char*>(imageData.EncodedData.get()),
+            static_cast<int32_t>(imageData.EncodedDataSize),
+            &width,
+            &height,
+            &components, 4);
+        
+        imageData.Width = width;
+        imageData.Height = height;
+        imageData.Components = components;
+
+        if (pixels == nullptr) {
+            return imageData;
+        }
+
+        // the mip chain is built right here on the worker, the GL thread only uploads levels
+        auto mipmapChain = GenerateMipmapChain(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height), isSrgb);
+        stbi_image_free(pixels);
+
+        if (auto cookedTexture = CookTexture(contentHash, mipmapChain)) {
+            imageData.CookedTexture = std::make_shared<const SCookedTexture>(std::move(*cookedTexture));
+        } else {
+            imageData.MipmapChain = std::make_shared<const SMipmapChain>(std::move(mipmapChain));
+        }
+
+        return imageData;
+    });
+
+    for (auto& imageData : imageDates) {
+        imageData.EncodedData.reset();
+    }
+
+    return SPreparedModel{
+        .ModelData = std::move(modelDataPtr),
+        .Images = std::move(imageDates)
+    };
+}
+
+// allocates elementCount elements from one of the geometry pool allocators. when the space is exhausted or too
+// fragmented the allocator and the buffers behind it grow, at least doubling so growing stays rare
+auto AllocateGeometry(
+    SOffsetAllocator& allocator,
+    std::initializer_list<SGrowableBuffer*> buffers,
+    uint32_t elementCount) -> std::optional<SOffsetAllocation> {
+
+    // an empty stream has nothing to place, its offset is never read
+    if (elementCount == 0) {
+        return SOffsetAllocation{ .Offset = 0 };
+    }
+
+    auto maxCapacity = static_cast<std::size_t>(std::numeric_limits<uint32_t>::max());
+    for (const auto* buffer : buffers) {
+        maxCapacity = std::min(maxCapacity, g_geometryBufferMaxSize / buffer->ElementSize);
+    }
+
+    while (true) {
+
+        if (auto allocation = Allocate(allocator, elementCount)) {
+            return allocation;
+        }
+
+        // requests are served from size classes rounded up, twice the request always fits into the appended range
+        const auto capacity = static_cast<std::size_t>(allocator.Size);
+        const auto newCapacity = std::min(std::max(capacity * 2, capacity + static_cast<std::size_t>(elementCount) * 2), maxCapacity);
+        if (newCapacity <= capacity) {
+            return std::nullopt;
+        }
+
+        // geometry is never evicted, growing past the budget is refused and the model fails to load
+        std::size_t growthSize = 0;
+        for (const auto* buffer : buffers) {
+            growthSize += (newCapacity - buffer->Capacity) * buffer->ElementSize;
+        }
+        if (GetGrowableBufferMemorySize() + growthSize > GetGpuMemoryBudgetInBytes()) {
+            spdlog::error("Geometry pool: growing by {} bytes would exceed the GPU memory budget of {} MiB", growthSize, g_gpuMemoryBudgetInMiB);
+            return std::nullopt;
+        }
+
+        if (!Grow(allocator, static_cast<uint32_t>(newCapacity))) {
+            return std::nullopt;
+        }
+
+        for (auto* buffer : buffers) {
+            GrowBuffer(*buffer, static_cast<uint32_t>(newCapacity));
+        }
+    }
+}
+
+// creates the textures of a prepared model, queues the uploads of its streams and fills in the model.
+// textures and materials already loaded by another model are shared through the registries. GL thread only
+auto CreateModel(
+    SModel& model,
+    SPreparedModel& preparedModel,
+    SGeometryPool& geometryPool,
+    const uint32_t megaMaterialBuffer) -> bool {
+
+    TOADWART_PROFILE_SCOPED();
+
+    const auto& modelDataPtr = preparedModel.ModelData;
+    const auto& modelData = *modelDataPtr;
+
+    // the geometry gets its place first, a model which doesn't fit anymore isn't created at all
+    auto vertexAllocation = AllocateGeometry(geometryPool.VertexAllocator, { &geometryPool.VertexPositions, &geometryPool.VertexNormalUvs }, static_cast<uint32_t>(modelData.VertexPositions.size()));
+    auto indexAllocation = AllocateGeometry(geometryPool.IndexAllocator, { &geometryPool.Indices }, static_cast<uint32_t>(modelData.Indices.size()));
+    auto index16Allocation = AllocateGeometry(geometryPool.Index16Allocator, { &geometryPool.Indices16 }, static_cast<uint32_t>(modelData.Indices16.size()));
+    if (!vertexAllocation || !indexAllocation || !index16Allocation) {
+
+        spdlog::error("Geometry of {} does not fit into the geometry pool", modelData.Name);
+        Free(geometryPool.VertexAllocator, vertexAllocation.value_or(SOffsetAllocation{}));
+        Free(geometryPool.IndexAllocator, indexAllocation.value_or(SOffsetAllocation{}));
+        Free(geometryPool.Index16Allocator, index16Allocation.value_or(SOffsetAllocation{}));
+        return false;
+    }
+
+    model.VertexAllocation = *vertexAllocation;
+    model.IndexAllocation = *indexAllocation;
+    model.Index16Allocation = *index16Allocation;
+    const auto vertexOffset = vertexAllocation->Offset;
+    const auto indexOffset = indexAllocation->Offset;
+    const auto index16Offset = index16Allocation->Offset;
+
+    // every texture and material of the model resolves to a shared slot, GL objects are only created for content
+    // which no model loaded before. slots of textures and materials no model uses anymore are reused
+    std::vector<std::optional<size_t>> textureIndices;
+    textureIndices.reserve(modelData.Textures.size());
+    for (auto& modelTexture : modelData.Textures) {
+
+        auto& imageData = preparedModel.Images[modelTexture.ImageIndex];
+
+        TOADWART_PROFILE_NAMED_SCOPE("Create Textures");
+        TOADWART_PROFILE_NAMED_SIZED_SCOPE(imageData.Name.c_str(), imageData.Name.size());
+
+        // materials drop a texture which failed to load, as if they never had it
+        if (imageData.MipmapChain == nullptr && imageData.CookedTexture == nullptr) {
+            textureIndices.push_back(std::nullopt);
+            continue;
+        }
+
+        auto& samplerData = modelData.Samplers[modelTexture.SamplerIndex];
+
+        const auto imageKey = HashCombine(imageData.ContentHash, imageData.IsSrgb ? 1 : 0);
+        const auto textureKey = HashCombine(imageKey, samplerData.Name);
+        model.TextureKeys.push_back(textureKey);
+
+        if (const auto* textureResource = g_textureRegistry.Acquire(textureKey)) {
+            textureIndices.push_back(textureResource->TextureIndex);
+            continue;
+        }
+
+        // the same image with another sampler shares the texture object and only needs a handle of its own.
+        // only cooked images can be evicted, the texture cache is where they come back from
+        auto* imageResource = g_imageRegistry.Acquire(imageKey);
+        if (imageResource == nullptr) {
+            const auto isCooked = imageData.CookedTexture != nullptr;
+            imageResource = &g_imageRegistry.Add(imageKey, SImageResource{
+                .Texture = isCooked
+                    ? CreateTextureFromCookedTexture(imageData.CookedTexture)
+                    : CreateTextureFromMipmapChain(imageData.MipmapChain),
+                .ContentHash = imageData.ContentHash,
+                .IsSrgb = imageData.IsSrgb,
+                .IsReloadable = isCooked,
+                .LevelCount = static_cast<uint32_t>(isCooked ? imageData.CookedTexture->Levels.size() : imageData.MipmapChain->Levels.size()),
+                .MemorySize = isCooked ? GetCookedTextureMemorySize(*imageData.CookedTexture, 0) : imageData.MipmapChain->Pixels.size(),
+                .LastUsedFrame = g_residencyFrameIndex
+            });
+        }
+
+        const auto textureIndex = g_textureRegistry.AllocateSlot(g_textures.size());
+        if (textureIndex == g_textures.size()) {
+            g_textures.push_back(0);
+            g_textureHandles.push_back(0);
+            g_textureResidencies.emplace_back();
+        }
+        imageResource->TextureIndices.push_back(textureIndex);
+
+        g_textureRegistry.Add(textureKey, STextureResource{
+            .TextureIndex = textureIndex,
+            .ImageKey = imageKey
+        });
+        textureIndices.push_back(textureIndex);
+        g_textures[textureIndex] = imageResource->Texture;
+        g_textureHandles[textureIndex] = 0;
+        g_textureResidencies[textureIndex] = STextureResidency{
+            .ImageKey = imageKey,
+            .Sampler = GetOrCreateSampler(samplerData),
+            .LastUsedFrame = g_residencyFrameIndex
+        };
+        MakeTextureResident(textureIndex);
+    }
+
+    // materials are keyed on their parameters, the name does not take part
+    std::vector<size_t> materialIndices;
+    materialIndices.reserve(modelData.Materials.size());
+    for (auto material : modelData.Materials) {
+
+        auto materialKey = Hash64(&material.BaseColor, sizeof(material.BaseColor));
+        for (auto* textureIndex : { &material.BaseTextureIndex, &material.NormalTextureIndex, &material.OcclusionTextureIndex, &material.MetallicRoughnessTextureIndex, &material.EmissiveTextureIndex }) {
+            if (textureIndex->has_value()) {
+                *textureIndex = textureIndices[textureIndex->value()];
+            }
+            materialKey = HashCombine(materialKey, textureIndex->has_value() ? textureIndex->value() : std::numeric_limits<uint64_t>::max());
+        }
+        model.MaterialKeys.push_back(materialKey);
+
+        if (const auto* materialIndex = g_materialRegistry.Acquire(materialKey)) {
+            materialIndices.push_back(*materialIndex);
+            continue;
+        }
+
+        const auto materialIndex = g_materialRegistry.AllocateSlot(g_cpuMaterials.size());
+        if (materialIndex == g_cpuMaterials.size()) {
+            g_cpuMaterials.emplace_back();
+        }
+        g_materialRegistry.Add(materialKey, materialIndex);
+        materialIndices.push_back(materialIndex);
+        g_cpuMaterials[materialIndex] = std::move(material);
+        g_gpuMaterialsNeedUpdate = true;
+    }
+
+    // the streams of a model are contiguous, they go up in one piece regardless of where they came from
+    EnqueueBufferUpload(geometryPool.VertexPositions.Id, vertexOffset * sizeof(SVertexPosition), std::as_bytes(modelData.VertexPositions), modelDataPtr);
+    EnqueueBufferUpload(geometryPool.VertexNormalUvs.Id, vertexOffset * sizeof(SVertexNormalUv), std::as_bytes(modelData.VertexNormalUvs), modelDataPtr);
+    EnqueueBufferUpload(geometryPool.Indices.Id, indexOffset * sizeof(uint32_t), std::as_bytes(modelData.Indices), modelDataPtr);
+    model.UploadId = EnqueueBufferUpload(geometryPool.Indices16.Id, index16Offset * sizeof(uint16_t), std::as_bytes(modelData.Indices16), modelDataPtr);
+
+    if (model.TransformNode == g_transformNodeNone) {
+        model.TransformNode = CreateTransformNode(g_transformHierarchy, g_transformNodeNone, glm::mat4(1.0f));
+    }
+
+    for (auto& modelDataMesh : modelData.Meshes) {
+
+        auto modelMesh = SModelMesh{
+            .Name = modelDataMesh.Name,
+            .TransformNode = CreateTransformNode(g_transformHierarchy, model.TransformNode, modelDataMesh.WorldMatrix)
+        };
+
+        const auto modelDataPrimitives = std::span(modelData.Primitives).subspan(modelDataMesh.PrimitiveOffset, modelDataMesh.PrimitiveCount);
+        for (const auto& modelDataPrimitive : modelDataPrimitives) {
+
+            const auto baseIndexOffset = modelDataPrimitive.IndexType == EIndexType::UnsignedShort
+                ? index16Offset
+                : indexOffset;
+            auto pooledPrimitive = GetPooledPrimitive(
+                modelDataPrimitive,
+                vertexOffset,
+                baseIndexOffset);
+            auto pooledMaterial = GetPooledMaterial(
+                megaMaterialBuffer,
+                static_cast<uint32_t>(modelDataPrimitive.MaterialIndex < materialIndices.size() ? materialIndices[modelDataPrimitive.MaterialIndex] : 0)
+            );
+            const auto meshlets = std::span(modelData.Meshlets).subspan(modelDataPrimitive.MeshletOffset, modelDataPrimitive.MeshletCount);
+            auto primitive = SPrimitive{
+                .Primitive = std::move(pooledPrimitive),
+                .Material = std::move(pooledMaterial),
+                .Statistics = modelDataPrimitive.Statistics,
+                .Meshlets = std::vector<SMeshlet>(meshlets.begin(), meshlets.end()),
+                .Center = modelDataPrimitive.Center,
+                .Radius = modelDataPrimitive.Radius,
+                .Extent = modelDataPrimitive.Extent,
+                .Quantization = modelDataPrimitive.Quantization
+            };
+            for (auto lod : std::span(modelData.Lods).subspan(modelDataPrimitive.LodOffset, modelDataPrimitive.LodCount)) {
+                lod.IndexOffset += baseIndexOffset;
+                primitive.Lods.push_back(lod);
+            }
+            modelMesh.Primitives.push_back(std::move(primitive));
+        }
+
+        model.Meshes.push_back(std::move(modelMesh));
+    }
+
+    model.DependencyFilePaths.clear();
+    for (const auto& dependency : modelData.Dependencies) {
+        model.DependencyFilePaths.push_back(GetWatchedFilePath(dependency.FilePath));
+    }
+    for (const auto& modelImage : modelData.Images) {
+        if (!modelImage.FilePath.empty()) {
+            model.DependencyFilePaths.push_back(GetWatchedFilePath(modelImage.FilePath));
+        }
+    }
+    for (const auto& dependencyFilePath : model.DependencyFilePaths) {
+        WatchFile(dependencyFilePath);
+    }
+
+    return true;
+}
+
+// drops the references of the model on its textures and materials, whatever no other model uses anymore is destroyed
+// and its slot in g_cpuMaterials or g_textureHandles goes back to the registry for the next model to take
+auto ReleaseModelResources(SModel& model) -> void {
+
+    for (auto textureKey : model.TextureKeys) {
+
+        auto textureResource = g_textureRegistry.Release(textureKey);
+        if (!textureResource.has_value()) {
+            continue;
+        }
+
+        MakeTextureNonResident(textureResource->TextureIndex);
+        g_textureHandles[textureResource->TextureIndex] = 0;
+        g_textures[textureResource->TextureIndex] = 0;
+        g_textureResidencies[textureResource->TextureIndex] = STextureResidency{};
+        g_textureRegistry.FreeSlot(textureResource->TextureIndex);
+
+        if (auto imageEntry = g_imageRegistry.Entries.find(textureResource->ImageKey); imageEntry != g_imageRegistry.Entries.end()) {
+            std::erase(imageEntry->second.Resource.TextureIndices, textureResource->TextureIndex);
+        }
+        if (auto imageResource = g_imageRegistry.Release(textureResource->ImageKey)) {
+            glDeleteTextures(1, &imageResource->Texture);
+            glDeleteTextures(1, &imageResource->ReloadTexture);
+        }
+    }
+
+    for (auto materialKey : model.MaterialKeys) {
+        if (auto materialIndex = g_materialRegistry.Release(materialKey)) {
+            g_materialRegistry.FreeSlot(*materialIndex);
+        }
+    }
+
+    model.TextureKeys.clear();
+    model.MaterialKeys.clear();
+}
+
+auto GetGeometryAllocator(
+    SGeometryPool& geometryPool,
+    EGeometryStream stream) -> SOffsetAllocator& {
+
+    switch (stream) {
+        case EGeometryStream::Vertices: return geometryPool.VertexAllocator;
+        case EGeometryStream::Indices: return geometryPool.IndexAllocator;
+        default: return geometryPool.Index16Allocator;
+    }
+}
+
+auto GetGeometryBuffers(
+    SGeometryPool& geometryPool,
+    EGeometryStream stream) -> std::vector<SGrowableBuffer*> {
+
+    switch (stream) {
+        case EGeometryStream::Vertices: return { &geometryPool.VertexPositions, &geometryPool.VertexNormalUvs };
+        case EGeometryStream::Indices: return { &geometryPool.Indices };
+        default: return { &geometryPool.Indices16 };
+    }
+}
+
+auto GetGeometryAllocation(
+    SModel& model,
+    EGeometryStream stream) -> SOffsetAllocation& {
+
+    switch (stream) {
+        case EGeometryStream::Vertices: return model.VertexAllocation;
+        case EGeometryStream::Indices: return model.IndexAllocation;
+        default: return model.Index16Allocation;
+    }
+}
+
+// looks for a ready model near the end of a pool whose range fits into a free range further down
+auto FindGeometryMove(SGeometryPool& geometryPool) -> std::optional<SGeometryMove> {
+
+    for (auto stream : { EGeometryStream::Vertices, EGeometryStream::Indices, EGeometryStream::Indices16 }) {
+
+        std::string modelName;
+        const auto allocationMove = FindAllocationMove(GetGeometryAllocator(geometryPool, stream), g_defragmentationCandidateCount, [&](const SOffsetAllocation& allocation) {
+            auto modelNameToModel = std::find_if(g_modelNameToModelMap.begin(), g_modelNameToModelMap.end(), [&](auto& modelNameToModel) {
+                return GetGeometryAllocation(modelNameToModel.second, stream).NodeIndex == allocation.NodeIndex;
+            });
+            if (modelNameToModel == g_modelNameToModelMap.end() || modelNameToModel->second.State != EModelState::Ready) {
+                return false;
+            }
+            modelName = modelNameToModel->first;
+            return true;
+        });
+        if (!allocationMove.has_value()) {
+            continue;
+        }
+
+        return SGeometryMove{
+            .ModelName = std::move(modelName),
+            .Stream = stream,
+            .Source = allocationMove->Source,
+            .Destination = allocationMove->Destination,
+            .ElementCount = allocationMove->Size,
+            .CopiedElementCount = 0
+        };
+    }
+
+    return std::nullopt;
+}
+
+// points the primitives of the model at the moved range, offsets within the range stay what they were
+auto PatchModelGeometryOffsets(
+    SModel& model,
+    EGeometryStream stream,
+    uint32_t sourceOffset,
+    uint32_t destinationOffset) -> void {
+
+    for (auto& mesh : model.Meshes) {
+        for (auto& primitive : mesh.Primitives) {
+
+            auto& pooledPrimitive = primitive.Primitive;
+            if (stream == EGeometryStream::Vertices) {
+                pooledPrimitive.VertexOffset = destinationOffset + (pooledPrimitive.VertexOffset - sourceOffset);
+                continue;
+            }
+
+            const auto streamIndexType = stream == EGeometryStream::Indices ? EIndexType::UnsignedInt : EIndexType::UnsignedShort;
+            if (pooledPrimitive.IndexType != streamIndexType) {
+                continue;
+            }
+
+            pooledPrimitive.IndexOffset = destinationOffset + (pooledPrimitive.IndexOffset - sourceOffset);
+            for (auto& lod : primitive.Lods) {
+                lod.IndexOffset = destinationOffset + (lod.IndexOffset - sourceOffset);
+            }
+        }
+    }
+}
+
+// checks the bookkeeping of the pool after a move under stress: the live ranges of a stream don't overlap, the free
+// storage of its allocator is its size minus what models and a move in flight hold, and the primitives of every
+// model lie inside the model's ranges
+auto ValidateGeometryPool(SGeometryPool& geometryPool) -> std::expected<void, std::string> {
+
+    TOADWART_PROFILE_SCOPED();
+
+    for (auto stream : { EGeometryStream::Vertices, EGeometryStream::Indices, EGeometryStream::Indices16 }) {
+
+        std::vector<SOffsetAllocation> allocations;
+        for (auto& [modelName, model] : g_modelNameToModelMap) {
+            allocations.push_back(GetGeometryAllocation(model, stream));
+        }
+        if (g_geometryMove.has_value() && g_geometryMove->Stream == stream) {
+            allocations.push_back(g_geometryMove->Destination);
+        }
+
+        if (auto validation = ValidateOffsetAllocator(GetGeometryAllocator(geometryPool, stream), allocations); !validation) {
+            return std::unexpected(std::format("stream {}: {}", static_cast<uint32_t>(stream), validation.error()));
+        }
+    }
+
+    for (auto& [modelName, model] : g_modelNameToModelMap) {
+
+        const auto isInside = [&](EGeometryStream stream, std::size_t offset, std::size_t count) {
+            const auto& allocation = GetGeometryAllocation(model, stream);
+            const auto size = GetAllocationSize(GetGeometryAllocator(geometryPool, stream), allocation);
+            return count == 0 || (offset >= allocation.Offset && offset + count <= static_cast<std::size_t>(allocation.Offset) + size);
+        };
+
+        for (const auto& mesh : model.Meshes) {
+            for (const auto& primitive : mesh.Primitives) {
+
+                const auto& pooledPrimitive = primitive.Primitive;
+                if (!isInside(EGeometryStream::Vertices, pooledPrimitive.VertexOffset, pooledPrimitive.VertexCount)) {
+                    return std::unexpected(std::format("{}: vertices [{}, {}) outside of the model's range", modelName,
+                        pooledPrimitive.VertexOffset, pooledPrimitive.VertexOffset + pooledPrimitive.VertexCount));
+                }
+
+                const auto indexStream = pooledPrimitive.IndexType == EIndexType::UnsignedShort ? EGeometryStream::Indices16 : EGeometryStream::Indices;
+                if (!isInside(indexStream, pooledPrimitive.IndexOffset, pooledPrimitive.IndexCount)) {
+                    return std::unexpected(std::format("{}: indices [{}, {}) outside of the model's range", modelName,
+                        pooledPrimitive.IndexOffset, pooledPrimitive.IndexOffset + pooledPrimitive.IndexCount));
+                }
+                for (const auto& lod : primitive.Lods) {
+                    if (!isInside(indexStream, lod.IndexOffset, lod.IndexCount)) {
+                        return std::unexpected(std::format("{}: lod indices [{}, {}) outside of the model's range", modelName,
+                            lod.IndexOffset, lod.IndexOffset + lod.IndexCount));
+                    }
+                }
+            }
+        }
+    }
+
+    return {};
+}
+
+// compacts the geometry pool a slice at a time. ranges are copied within their buffer, GL orders the copies
+// before any draw issued after them, so a model can switch to its new range in the same frame its last slice
+// went out. returns true when a model switched and the scene has to be rebuilt before drawing
+auto DefragmentGeometryPool(
+    SGeometryPool& geometryPool,
+    std::size_t budgetInBytes) -> bool {
+
+    TOADWART_PROFILE_SCOPED();
+
+    g_defragmentationStatistics.FrameBytesMoved = 0;
+    for (auto stream : { EGeometryStream::Vertices, EGeometryStream::Indices, EGeometryStream::Indices16 }) {
+        g_defragmentationStatistics.Fragmentation[static_cast<uint32_t>(stream)] = GetFragmentation(GetGeometryAllocator(geometryPool, stream));
+    }
+
+    auto isSceneChanged = false;
+    while (g_defragmentationStatistics.FrameBytesMoved < budgetInBytes) {
+
+        if (!g_geometryMove.has_value()) {
+            g_geometryMove = FindGeometryMove(geometryPool);
+            if (!g_geometryMove.has_value()) {
+                break;
+            }
+        }
+
+        auto& geometryMove = *g_geometryMove;
+        const auto geometryBuffers = GetGeometryBuffers(geometryPool, geometryMove.Stream);
+
+        std::size_t elementSize = 0;
+        for (const auto* geometryBuffer : geometryBuffers) {
+            elementSize += geometryBuffer->ElementSize;
+        }
+
+        const auto budgetElementCount = std::max<std::size_t>((budgetInBytes - g_defragmentationStatistics.FrameBytesMoved) / elementSize, 1);
+        const auto sliceElementCount = static_cast<uint32_t>(std::min<std::size_t>(geometryMove.ElementCount - geometryMove.CopiedElementCount, budgetElementCount));
+        for (const auto* geometryBuffer : geometryBuffers) {
+            glCopyNamedBufferSubData(
+                geometryBuffer->Id,
+                geometryBuffer->Id,
+                static_cast<GLintptr>((static_cast<std::size_t>(geometryMove.Source.Offset) + geometryMove.CopiedElementCount) * geometryBuffer->ElementSize),
+                static_cast<GLintptr>((static_cast<std::size_t>(geometryMove.Destination.Offset) + geometryMove.CopiedElementCount) * geometryBuffer->ElementSize),
+                static_cast<GLsizeiptr>(static_cast<std::size_t>(sliceElementCount) * geometryBuffer->ElementSize));
+        }
+
+        geometryMove.CopiedElementCount += sliceElementCount;
+        g_defragmentationStatistics.FrameBytesMoved += sliceElementCount * elementSize;
+        g_defragmentationStatistics.TotalBytesMoved += sliceElementCount * elementSize;
+
+        if (geometryMove.CopiedElementCount < geometryMove.ElementCount) {
+            continue;
+        }
+
+        auto& model = g_modelNameToModelMap[geometryMove.ModelName];
+        PatchModelGeometryOffsets(model, geometryMove.Stream, geometryMove.Source.Offset, geometryMove.Destination.Offset);
+        GetGeometryAllocation(model, geometryMove.Stream) = geometryMove.Destination;
+        Free(GetGeometryAllocator(geometryPool, geometryMove.Stream), geometryMove.Source);
+
+        g_defragmentationStatistics.TotalMoves++;
+        g_geometryMove.reset();
+        isSceneChanged = true;
+
+        // the stress toggle exists to find bookkeeping bugs, it stops at the first one so the log shows where
+        if (g_isDefragmentationStressEnabled) {
+            if (auto validation = ValidateGeometryPool(geometryPool); !validation) {
+                spdlog::error("Defragmentation stress: {}", validation.error());
+                g_isDefragmentationStressEnabled = false;
+            }
+        }
+    }
+
+    return isSceneChanged;
+}
+
+// a move of the model's geometry in flight is dropped, its destination goes back to the pool
+auto CancelGeometryMove(
+    SGeometryPool& geometryPool,
+    const std::string& modelName) -> void {
+
+    if (g_geometryMove.has_value() && g_geometryMove->ModelName == modelName) {
+        Free(GetGeometryAllocator(geometryPool, g_geometryMove->Stream), g_geometryMove->Destination);
+        g_geometryMove.reset();
+    }
+}
+
+// takes the model out of the scene and gives back its geometry, textures and materials. models still loading or
+// uploading can't be unloaded, their worker or their uploads still refer to them
+auto UnloadModel(
+    const std::string& modelName,
+    SGeometryPool& geometryPool) -> void {
+
+    auto modelNameToModel = g_modelNameToModelMap.find(modelName);
+    if (modelNameToModel == g_modelNameToModelMap.end()) {
+        return;
+    }
+
+    auto& model = modelNameToModel->second;
+    if (model.State == EModelState::Loading || model.State == EModelState::Uploading) {
+        return;
+    }
+
+    CancelGeometryMove(geometryPool, modelName);
+
+    Free(geometryPool.VertexAllocator, model.VertexAllocation);
+    Free(geometryPool.IndexAllocator, model.IndexAllocation);
+    Free(geometryPool.Index16Allocator, model.Index16Allocation);
+    ReleaseModelResources(model);
+    DestroyTransformNode(g_transformHierarchy, model.TransformNode);
+
+    std::erase(g_sceneModelNames, modelName);
+    g_modelNameToModelMap.erase(modelNameToModel);
+    g_sceneNeedsUpdate = true;
+}
+
+// loads a model and waits for all of its uploads
+auto AddModelFromFile(
+    const std::string& modelName,
+    std::filesystem::path filePath,
+    SGeometryPool& geometryPool,
+    const uint32_t megaMaterialBuffer) -> void {
+
+    TOADWART_PROFILE_SCOPED();
+    if (g_modelNameToModelMap.contains(modelName))
+    {
+        return;
+    }
+
+    auto preparedModelResult = PrepareModel(filePath, g_modelImportSettings);
+    if (!preparedModelResult) {
+        spdlog::error(preparedModelResult.error());
+        return;
+    }
+
+    auto& model = g_modelNameToModelMap[modelName];
+    model.Name = filePath.string();
+    model.FilePath = GetWatchedFilePath(filePath);
+    WatchFile(filePath);
+    if (!CreateModel(model, *preparedModelResult, geometryPool, megaMaterialBuffer)) {
+        model.State = EModelState::Failed;
+        return;
+    }
+    FinishUploadQueue();
+    model.State = EModelState::Ready;
+}
+
+// registers the model as loading and prepares it on a worker thread, ProcessModelLoadCompletions picks it up
+// on the GL thread once the worker is done
+auto AddModelFromFileAsync(
+    const std::string& modelName,
+    std::filesystem::path filePath) -> void {
+
+    if (g_modelNameToModelMap.contains(modelName))
+    {
+        return;
+    }
+
+    auto& model = g_modelNameToModelMap[modelName];
+    model.Name = filePath.string();
+    model.FilePath = GetWatchedFilePath(filePath);
+    model.State = EModelState::Loading;
+    WatchFile(filePath);
+
+    g_modelLoadTasks.push_back(std::async(std::launch::async, [modelName, filePath = std::move(filePath), importSettings = g_modelImportSettings] {
+        g_modelLoadCompletions.Push(SModelLoadCompletion{
+            .ModelName = modelName,
+            .PreparedModel = PrepareModel(filePath, importSettings)
+        });
+    }));
+}
+
+// creates the models whose workers finished and promotes models whose uploads went through to ready.
+// returns true when a model became ready this frame
+auto ProcessModelLoadCompletions(
+    SGeometryPool& geometryPool,
+    const uint32_t megaMaterialBuffer) -> bool {
+
+    TOADWART_PROFILE_SCOPED();
+
+    for (auto& modelLoadCompletion : g_modelLoadCompletions.PopAll()) {
+
+        auto& model = g_modelNameToModelMap[modelLoadCompletion.ModelName];
+        if (!modelLoadCompletion.PreparedModel) {
+            spdlog::error(modelLoadCompletion.PreparedModel.error());
+            model.State = EModelState::Failed;
+            continue;
+        }
+
+        model.State = CreateModel(model, *modelLoadCompletion.PreparedModel, geometryPool, megaMaterialBuffer)
+            ? EModelState::Uploading
+            : EModelState::Failed;
+    }
+
+    std::erase_if(g_modelLoadTasks, [](const std::future<void>& modelLoadTask) {
+        return modelLoadTask.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    });
+
+    auto isModelReady = false;
+    for (auto& [modelName, model] : g_modelNameToModelMap) {
+        if (model.State == EModelState::Uploading && IsUploadSubmitted(model.UploadId)) {
+            model.State = EModelState::Ready;
+            isModelReady = true;
+        }
+    }
+
+    return isModelReady;
+}
+
+// starts reloading every model built from one of the changed files, a model which failed to load gets another
+// go when its glTF changes. the model stays in the scene as it is until its new version is ready
+auto ReloadModels(std::span<const std::filesystem::path> changedFilePaths) -> void {
+
+    auto isChanged = [&](const std::filesystem::path& filePath) {
+        return std::ranges::find(changedFilePaths, filePath) != changedFilePaths.end();
+    };
+
+    std::vector<std::pair<std::string, std::filesystem::path>> modelsToReload;
+    for (const auto& [modelName, model] : g_modelNameToModelMap) {
+        if (model.State == EModelState::Loading || model.State == EModelState::Uploading || modelName.ends_with(g_reloadModelNameSuffix)) {
+            continue;
+        }
+        if (isChanged(model.FilePath) || std::ranges::any_of(model.DependencyFilePaths, isChanged)) {
+            modelsToReload.emplace_back(modelName, model.FilePath);
+        }
+    }
+
+    for (auto& [modelName, filePath] : modelsToReload) {
+
+        if (auto modelReload = g_modelReloads.find(modelName); modelReload != g_modelReloads.end()) {
+            modelReload->second.IsStale = true;
+            continue;
+        }
+
+        auto reloadModelName = std::format("{}{}", modelName, g_reloadModelNameSuffix);
+        spdlog::info("Hot reload: reloading {} from {}", modelName, filePath.string());
+        AddModelFromFileAsync(reloadModelName, std::move(filePath));
+        g_modelReloads[modelName] = SModelReload{ .ReloadModelName = std::move(reloadModelName) };
+    }
+}
+
+// swaps reloaded models in for their old versions, which are unloaded right away. a reload which failed is
+// dropped and the old version stays. returns true when a model was swapped
+auto ProcessModelReloads(SGeometryPool& geometryPool) -> bool {
 
-        auto modelMesh = SModelMesh{
-            .Name = std::move(meshName),
-            .WorldMatrix = std::move(globalTransform)
-        };
+    auto isModelSwapped = false;
+    std::vector<std::string> staleModelNames;
 
-        for (const auto& fgPrimitive : fgMesh.primitives)
-        {
-            TOADWART_PROFILE_NAMED_SCOPE("LoadPrimitive");
-            TOADWART_PROFILE_NAMED_SIZED_SCOPE(fgMesh.name.data(), fgMesh.name.size());
+    std::erase_if(g_modelReloads, [&](auto& modelNameAndReload) {
 
-            const auto primitiveMaterialIndex = fgPrimitive.materialIndex.has_value()
-                ? fgPrimitive.materialIndex.value()
-                : 0;
+        auto& [modelName, modelReload] = modelNameAndReload;
+        auto reloadModel = g_modelNameToModelMap.find(modelReload.ReloadModelName);
+        if (reloadModel == g_modelNameToModelMap.end()) {
+            return true;
+        }
+        if (reloadModel->second.State == EModelState::Loading || reloadModel->second.State == EModelState::Uploading) {
+            return false;
+        }
 
-            auto pooledPrimitive = GetPooledPrimitive(
-                megaVertexBufferPosition,
-                megaVertexBufferNormalUv,
-                megaIndexBuffer,
-                fgAsset,
-                fgPrimitive);
-            auto pooledMaterial = GetPooledMaterial(
-                megaMaterialBuffer,
-                primitiveMaterialIndex
-            );
-            auto primitive = SPrimitive{
-                .Primitive = std::move(pooledPrimitive),
-                .Material = std::move(pooledMaterial)
-            };
-            modelMesh.Primitives.push_back(std::move(primitive));
+        auto model = g_modelNameToModelMap.find(modelName);
+        if (reloadModel->second.State == EModelState::Failed || model == g_modelNameToModelMap.end()) {
+            if (model != g_modelNameToModelMap.end()) {
+                spdlog::error("Hot reload: {} failed to load, keeping the previous version", modelName);
+            }
+        } else {
+            // the geometry moves of the defragmenter refer to models by name, the name is about to change hands
+            CancelGeometryMove(geometryPool, modelName);
+            std::swap(model->second, reloadModel->second);
+            // the new version stays where the old one was placed
+            const auto previousNode = reloadModel->second.TransformNode;
+            SetTransformNodeLocal(
+                g_transformHierarchy,
+                model->second.TransformNode,
+                GetTransformNodeTranslation(g_transformHierarchy, previousNode),
+                GetTransformNodeRotation(g_transformHierarchy, previousNode),
+                GetTransformNodeScale(g_transformHierarchy, previousNode));
+            isModelSwapped = true;
+            spdlog::info("Hot reload: swapped in {}", modelName);
         }
 
-        model.Meshes.push_back(std::move(modelMesh));
+        UnloadModel(modelReload.ReloadModelName, geometryPool);
+        if (modelReload.IsStale) {
+            staleModelNames.push_back(modelName);
+        }
+        return true;
+    });
+
+    for (const auto& staleModelName : staleModelNames) {
+        if (const auto model = g_modelNameToModelMap.find(staleModelName); model != g_modelNameToModelMap.end()) {
+            ReloadModels(std::span(&model->second.FilePath, 1));
+        }
     }
 
-    g_modelNameToModelMap.insert({modelName, std::move(model)});
+    return isModelSwapped;
 }
 
 auto main(
@@ -961,6 +3086,11 @@ auto main(
 
     spdlog::info("Running in RenderDoc: {}", g_isRunningInRenderDoc);
 
+    if (const auto* gpuMemoryBudget = getenv("TOADWART_GPU_MEMORY_BUDGET_MIB")) {
+        g_gpuMemoryBudgetInMiB = std::max(std::atoi(gpuMemoryBudget), 1);
+    }
+    spdlog::info("GPU memory budget: {} MiB", g_gpuMemoryBudgetInMiB);
+
     TOADWART_PROFILE_SCOPED();
     SWindowSettings windowSettings = {
         .ResolutionWidth = 1920,
@@ -1045,6 +3175,8 @@ auto main(
         return -4;
     }
 
+    InitializeShaderCompiler();
+
     if (windowSettings.IsDebug) {
         glDebugMessageCallback(OnOpenGLDebugMessage, nullptr);
         glEnable(GL_DEBUG_OUTPUT);
@@ -1119,6 +3251,11 @@ auto main(
         return -6;
     }
 
+    // without it nothing is reloaded, everything else works the same
+    if (!CreateFileWatcher()) {
+        spdlog::warn("Hot reload is not available");
+    }
+
     glfwSwapInterval(1);
 
     glEnable(GL_FRAMEBUFFER_SRGB);
@@ -1131,59 +3268,62 @@ auto main(
 
     glViewport(0, 0, g_framebufferSize.x, g_framebufferSize.y);
 
-    auto simpleVertexShaderResult = CreateProgram(GL_VERTEX_SHADER, "data/shaders/Simple.vs.glsl", "Simple.vs.glsl");
+    // every program is submitted before anything waits for one, the driver compiles them while the startup scene loads
+    auto simpleVertexShaderResult = CreateShaderProgram(GL_VERTEX_SHADER, "data/shaders/Simple.vs.glsl", "Simple.vs.glsl");
     if (!simpleVertexShaderResult) {
         spdlog::error(simpleVertexShaderResult.error());
         return -7;
     }
-    auto simpleVertexShader = *simpleVertexShaderResult;
-
-    auto simpleFragmentShaderResult = CreateProgram(GL_FRAGMENT_SHADER, "data/shaders/Simple.fs.glsl", "Simple.fs.glsl");
-    if (!simpleFragmentShaderResult) {
-        spdlog::error(simpleFragmentShaderResult.error());
-        return -7;
-    }
-    auto simpleFragmentShader = *simpleFragmentShaderResult;
+    auto& simpleVertexShader = **simpleVertexShaderResult;
 
-    auto simpleDebugFragmentShaderResult = CreateProgram(GL_FRAGMENT_SHADER, "data/shaders/Simple.Debug.fs.glsl", "Simple.Debug.fs.glsl");
+    auto simpleDebugFragmentShaderResult = CreateShaderProgram(GL_FRAGMENT_SHADER, "data/shaders/Simple.Debug.fs.glsl", "Simple.Debug.fs.glsl");
     if (!simpleDebugFragmentShaderResult) {
         spdlog::error(simpleDebugFragmentShaderResult.error());
         return -7;
     }
-    auto simpleDebugFragmentShader = *simpleDebugFragmentShaderResult;
+    auto& simpleDebugFragmentShader = **simpleDebugFragmentShaderResult;
 
-    auto fullscreenTriangleVertexShaderResult = CreateProgram(GL_VERTEX_SHADER, "data/shaders/FST.vs.glsl", "FST.vs.glsl");
+    auto fullscreenTriangleVertexShaderResult = CreateShaderProgram(GL_VERTEX_SHADER, "data/shaders/FST.vs.glsl", "FST.vs.glsl");
     if (!fullscreenTriangleVertexShaderResult) {
         spdlog::error(fullscreenTriangleVertexShaderResult.error());
         return -7;
     }
-    auto fullscreenTriangleVertexShader = *fullscreenTriangleVertexShaderResult;
+    auto& fullscreenTriangleVertexShader = **fullscreenTriangleVertexShaderResult;
 
-    auto fullscreenTriangleFragmentShaderResult = CreateProgram(GL_FRAGMENT_SHADER, "data/shaders/FST.fs.glsl", "FST.fs.glsl");
+    auto fullscreenTriangleFragmentShaderResult = CreateShaderProgram(GL_FRAGMENT_SHADER, "data/shaders/FST.fs.glsl", "FST.fs.glsl");
     if (!fullscreenTriangleFragmentShaderResult) {
         spdlog::error(fullscreenTriangleFragmentShaderResult.error());
         return -7;
     }
-    auto fullscreenTriangleFragmentShader = *fullscreenTriangleFragmentShaderResult;
-
-    auto simpleProgramPipeline = CreateGraphicsProgramPipeline("SimplePipeline", simpleVertexShader, simpleFragmentShader);
-    auto simpleDebugProgramPipeline = CreateGraphicsProgramPipeline("SimpleDebugPipeline", simpleVertexShader, simpleDebugFragmentShader);
-    g_fullscreenTrianglePipeline = CreateGraphicsProgramPipeline("FST", fullscreenTriangleVertexShader, fullscreenTriangleFragmentShader);
+    auto& fullscreenTriangleFragmentShader = **fullscreenTriangleFragmentShaderResult;
 
-    auto shadowVertexShaderResult = CreateProgram(GL_VERTEX_SHADER, "data/shaders/Shadow.vs.glsl", "Shadow.vs.glsl");
+    auto shadowVertexShaderResult = CreateShaderProgram(GL_VERTEX_SHADER, "data/shaders/Shadow.vs.glsl", "Shadow.vs.glsl");
     if (!shadowVertexShaderResult) {
         spdlog::error(shadowVertexShaderResult.error());
         return -7;
     }
-    auto shadowVertexShader = *shadowVertexShaderResult;
+    auto& shadowVertexShader = **shadowVertexShaderResult;
 
-    auto shadowFragmentShaderResult = CreateProgram(GL_FRAGMENT_SHADER, "data/shaders/Shadow.fs.glsl", "Shadow.fs.glsl");
+    auto shadowFragmentShaderResult = CreateShaderProgram(GL_FRAGMENT_SHADER, "data/shaders/Shadow.fs.glsl", "Shadow.fs.glsl");
     if (!shadowFragmentShaderResult) {
         spdlog::error(shadowFragmentShaderResult.error());
         return -7;
     }
-    auto shadowFragmentShader = *shadowFragmentShaderResult;
-    auto shadowProgramPipeline = CreateGraphicsProgramPipeline("Shadow", shadowVertexShader, shadowFragmentShader);
+    auto& shadowFragmentShader = **shadowFragmentShaderResult;
+
+    auto cullMeshletsComputeShaderResult = CreateShaderProgram(GL_COMPUTE_SHADER, "data/shaders/CullMeshlets.cs.glsl", "CullMeshlets.cs.glsl");
+    if (!cullMeshletsComputeShaderResult) {
+        spdlog::error(cullMeshletsComputeShaderResult.error());
+        return -7;
+    }
+    auto& cullMeshletsComputeShader = **cullMeshletsComputeShaderResult;
+
+    auto cullObjectsComputeShaderResult = CreateShaderProgram(GL_COMPUTE_SHADER, "data/shaders/CullObjects.cs.glsl", "CullObjects.cs.glsl");
+    if (!cullObjectsComputeShaderResult) {
+        spdlog::error(cullObjectsComputeShaderResult.error());
+        return -7;
+    }
+    auto& cullObjectsComputeShader = **cullObjectsComputeShaderResult;
 
     SGlobalUniforms globalUniforms = {
         .ProjectionMatrix = glm::infinitePerspectiveRH_ZO(glm::radians(60.0f), (float)g_framebufferSize.x / (float)g_framebufferSize.x, 0.1f),
@@ -1227,37 +3367,46 @@ auto main(
     SetDebugLabel(g_defaultInputLayout, GL_VERTEX_ARRAY, "InputLayout_Empty");
     glBindVertexArray(g_defaultInputLayout);
 
-    uint32_t megaVertexBufferPosition = 0;
-    glCreateBuffers(1, &megaVertexBufferPosition);
-    glNamedBufferStorage(megaVertexBufferPosition, sizeof(SVertexPosition) * 1048576, nullptr, GL_DYNAMIC_STORAGE_BIT);
-
-    uint32_t megaVertexBufferNormalUv = 0;
-    glCreateBuffers(1, &megaVertexBufferNormalUv);
-    glNamedBufferStorage(megaVertexBufferNormalUv, sizeof(SVertexNormalUv) * 1048576, nullptr, GL_DYNAMIC_STORAGE_BIT);
-
-    uint32_t megaIndexBuffer = 0;
-    glCreateBuffers(1, &megaIndexBuffer);
-    glNamedBufferStorage(megaIndexBuffer, 768000000, nullptr, GL_DYNAMIC_STORAGE_BIT);
+    if (!CreateUploadQueue(SUploadQueueSettings{})) {
+        return -8;
+    }
 
-    uint32_t megaMaterialBuffer = 0;
-    glCreateBuffers(1, &megaMaterialBuffer);
-    glNamedBufferStorage(megaMaterialBuffer, sizeof(SGpuMaterial) * 512, nullptr, GL_DYNAMIC_STORAGE_BIT);
+    // sampled in place of every texture whose handle is not resident
+    {
+        constexpr std::array<uint8_t, 4> fallbackPixel = { 128, 128, 128, 255 };
+        glCreateTextures(GL_TEXTURE_2D, 1, &g_fallbackTexture);
+        SetDebugLabel(g_fallbackTexture, GL_TEXTURE, "Fallback");
+        glTextureStorage2D(g_fallbackTexture, 1, GL_RGBA8, 1, 1);
+        glTextureSubImage2D(g_fallbackTexture, 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, fallbackPixel.data());
+        g_fallbackTextureHandle = g_fallbackTexture;
+        if (!g_isRunningInRenderDoc) {
+            g_fallbackTextureHandle = glGetTextureSamplerHandleARB(g_fallbackTexture, g_fullscreenSamplerNearestNearestClampToEdge);
+            glMakeTextureHandleResidentARB(g_fallbackTextureHandle);
+        }
+    }
 
-    uint32_t objectBuffer = 0;
-    glCreateBuffers(1, &objectBuffer);
-    glNamedBufferStorage(objectBuffer, sizeof(SObject) * 65536, nullptr, GL_DYNAMIC_STORAGE_BIT);
+    // the pool starts small and grows with what gets loaded, unloaded models hand their ranges back
+    auto geometryPool = SGeometryPool{
+        .VertexPositions = CreateGrowableBuffer("MegaVertexBufferPosition", sizeof(SVertexPosition), g_geometryPoolInitialVertexCount),
+        .VertexNormalUvs = CreateGrowableBuffer("MegaVertexBufferNormalUv", sizeof(SVertexNormalUv), g_geometryPoolInitialVertexCount),
+        .Indices = CreateGrowableBuffer("MegaIndexBuffer", sizeof(uint32_t), g_geometryPoolInitialIndexCount),
+        .Indices16 = CreateGrowableBuffer("MegaIndexBuffer16", sizeof(uint16_t), g_geometryPoolInitialIndexCount),
+        .VertexAllocator = CreateOffsetAllocator(g_geometryPoolInitialVertexCount, g_geometryPoolMaxAllocations),
+        .IndexAllocator = CreateOffsetAllocator(g_geometryPoolInitialIndexCount, g_geometryPoolMaxAllocations),
+        .Index16Allocator = CreateOffsetAllocator(g_geometryPoolInitialIndexCount, g_geometryPoolMaxAllocations)
+    };
 
-    uint32_t objectIndirectBuffer = 0;
-    glCreateBuffers(1, &objectIndirectBuffer);
-    glNamedBufferStorage(objectIndirectBuffer, sizeof(SGpuPooledPrimitive) * 65536, nullptr, GL_DYNAMIC_STORAGE_BIT);
+    // material buffers grow with g_cpuMaterials when materials are uploaded
+    auto megaMaterialBuffer = CreateGrowableBuffer("MegaMaterials", sizeof(SGpuMaterial), g_materialBufferInitialCapacity);
 
-    uint32_t gpuMaterialBuffer = 0;
-    glCreateBuffers(1, &gpuMaterialBuffer);
-    glNamedBufferStorage(gpuMaterialBuffer, sizeof(SGpuMaterial) * 512, nullptr, GL_DYNAMIC_STORAGE_BIT);
+    // both are rewritten whenever the scene changes and grow with it
+    auto objectBuffer = CreateGrowableBuffer("Objects", sizeof(SObject), g_objectBufferInitialCapacity);
+    auto objectIndirectBuffer = CreateGrowableBuffer("ObjectIndirect", sizeof(SGpuPooledPrimitive), g_objectBufferInitialCapacity);
+    auto objectLodBuffer = CreateGrowableBuffer("ObjectLods", sizeof(uint32_t), g_objectBufferInitialCapacity);
+    auto cullObjectBuffer = CreateGrowableBuffer("CullObjects", sizeof(SGpuCullObject), g_objectBufferInitialCapacity);
 
-    uint32_t cpuMaterialBuffer = 0;
-    glCreateBuffers(1, &cpuMaterialBuffer);
-    glNamedBufferStorage(cpuMaterialBuffer, sizeof(SCpuMaterial) * 512, nullptr, GL_DYNAMIC_STORAGE_BIT);
+    auto gpuMaterialBuffer = CreateGrowableBuffer("GpuMaterials", sizeof(SGpuMaterial), g_materialBufferInitialCapacity);
+    auto cpuMaterialBuffer = CreateGrowableBuffer("CpuMaterials", sizeof(SCpuMaterial), g_materialBufferInitialCapacity);
 
     uint32_t debugOptionsBuffer = 0;
     glCreateBuffers(1, &debugOptionsBuffer);
@@ -1330,10 +3479,8 @@ auto main(
     AddModelFromFile(
         "SM_Model",
         "data/default/SM_Deccer_Cubes_Textured.gltf",
-        megaVertexBufferPosition,
-        megaVertexBufferNormalUv,
-        megaIndexBuffer,
-        megaMaterialBuffer);
+        geometryPool,
+        megaMaterialBuffer.Id);
 
 /*
     AddModelFromFile(
@@ -1374,63 +3521,324 @@ auto main(
         megaIndexBuffer);
 */
 
-    auto model = g_modelNameToModelMap["SM_Model"];
+    // the startup scene is needed in full before the first frame, anything loaded later streams in under the frame budget
+    FinishUploadQueue();
+
+    if (auto shaderProgramsResult = FinishShaderPrograms(); !shaderProgramsResult) {
+        spdlog::error(shaderProgramsResult.error());
+        return -7;
+    }
+
+    auto simpleDebugProgramPipeline = CreateGraphicsProgramPipeline("SimpleDebugPipeline", simpleVertexShader, simpleDebugFragmentShader);
+    g_fullscreenTrianglePipeline = CreateGraphicsProgramPipeline("FST", fullscreenTriangleVertexShader, fullscreenTriangleFragmentShader);
+    auto shadowProgramPipeline = CreateGraphicsProgramPipeline("Shadow", shadowVertexShader, shadowFragmentShader);
+    auto cullMeshletsProgramPipeline = CreateComputeProgramPipeline("CullMeshlets", cullMeshletsComputeShader);
+    auto cullObjectsProgramPipeline = CreateComputeProgramPipeline("CullObjects", cullObjectsComputeShader);
+
+    g_sceneModelNames.push_back("SM_Model");
+
+    std::vector<SGpuMeshlet> gpuMeshlets;
+    std::vector<SPrimitiveInstance> primitiveInstances;
+    std::vector<SObject> objects;
+
+    // objects and meshlets are grouped by index type and material permutation, each group is drawn as its own
+    // bucket from the index buffer of its index type with the fragment shader of its permutation
+    std::vector<SDrawBucket> drawBuckets;
+
+    // by material features, created when the first material with those features shows up in the scene
+    std::unordered_map<uint32_t, SMaterialPermutation> materialPermutations;
+
+    // one indirect command per visible primitive, rewritten every frame with the selected lod. the commands of a
+    // bucket are packed at the start of its range
+    std::vector<SGpuPooledPrimitive> gpuPooledPrimitives;
+
+    // world space boxes of the objects, culled on the cpu every frame
+    SCullingBounds cullingBounds;
+    std::vector<uint8_t> objectVisibilities;
+    auto visibleObjectCount = 0u;
+
+    // selected lod per object, g_objectLodCulled when out of view. the meshlet culling pass only draws objects at lod 0
+    std::vector<uint32_t> objectLods;
+
+    // what the object culling pass needs on top of the objects, lods of all primitives of the scene are in one buffer
+    std::vector<SGpuCullObject> gpuCullObjects;
+    std::vector<SPrimitiveLod> gpuPrimitiveLods;
+    uint32_t primitiveLodBuffer = 0;
+
+    uint32_t objectIndirectCountBuffer = 0;
+    glCreateBuffers(1, &objectIndirectCountBuffer);
+    SetDebugLabel(objectIndirectCountBuffer, GL_BUFFER, "ObjectIndirectCount");
+    glNamedBufferStorage(objectIndirectCountBuffer, sizeof(uint32_t) * g_drawBucketCapacity, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    // the gpu pass tells the cpu what is in view through seen bits, read back once their fence passed a few frames
+    // later, things coming into view stay on the fallback texture until then
+    std::vector<SModel*> sceneModels;
+    uint64_t sceneVersion = 0;
+    std::array<SSeenBuffer, g_seenBufferCount> seenBuffers = {};
+    uint32_t seenBufferIndex = 0;
+    std::vector<uint32_t> seenBits;
+
+    std::vector<uint32_t> gpuObjectLods;
+    std::array<uint32_t, g_drawBucketCapacity> gpuDrawCounts = {};
+    auto gpuCullingMismatchCount = 0u;
+
+    // one indirect command per meshlet surviving the culling pass, the object index travels in BaseInstance
+    uint32_t meshletCount = 0;
+    uint32_t meshletBuffer = 0;
+    uint32_t meshletIndirectBuffer = 0;
+
+    uint32_t meshletIndirectCountBuffer = 0;
+    glCreateBuffers(1, &meshletIndirectCountBuffer);
+    SetDebugLabel(meshletIndirectCountBuffer, GL_BUFFER, "MeshletIndirectCount");
+    glNamedBufferStorage(meshletIndirectCountBuffer, sizeof(uint32_t) * g_drawBucketCapacity, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+    // slots without a resident handle sample the fallback texture, a material never points at a non-resident handle
+    auto getResidentTextureHandle = [](const std::optional<size_t>& textureIndex) -> uint64_t {
+        if (!textureIndex.has_value()) {
+            return 0;
+        }
+        return g_textureResidencies[textureIndex.value()].IsHandleResident
+            ? g_textureHandles[textureIndex.value()]
+            : g_fallbackTextureHandle;
+    };
 
     // prepare material buffer, in this instance its update per material, cpu materials should be transformed into gpu materials
     // and gpumaterials uploaded to gpu at once, rather than one after another
+    auto uploadMaterials = [&]() {
+
+        const auto materialCount = static_cast<uint32_t>(g_cpuMaterials.size());
+        if (materialCount > gpuMaterialBuffer.Capacity) {
+            const auto materialCapacity = std::max(gpuMaterialBuffer.Capacity * 2, materialCount);
+            GrowBuffer(megaMaterialBuffer, materialCapacity);
+            GrowBuffer(gpuMaterialBuffer, materialCapacity);
+            GrowBuffer(cpuMaterialBuffer, materialCapacity);
+        }
 
-    for (auto materialIndex = 0; auto& cpuMaterial : g_cpuMaterials) {
-
-        glNamedBufferSubData(cpuMaterialBuffer, sizeof(SCpuMaterial) * materialIndex, sizeof(SGpuMaterial), &cpuMaterial);
-        auto gpuMaterial = SGpuMaterial{
-            .BaseColor = cpuMaterial.BaseColor,
-            .BaseTextureHandle = cpuMaterial.BaseTextureIndex.has_value()
-                ? g_textureHandles[cpuMaterial.BaseTextureIndex.value()]
-                : 0,
-            .NormalTextureHandle = cpuMaterial.NormalTextureIndex.has_value()
-                ? g_textureHandles[cpuMaterial.NormalTextureIndex.value()]
-                : 0,
-            .OcclusionTextureHandle = cpuMaterial.OcclusionTextureIndex.has_value()
-                ? g_textureHandles[cpuMaterial.OcclusionTextureIndex.value()]
-                : 0,
-            .MetallicRoughnessTextureHandle = cpuMaterial.MetallicRoughnessTextureIndex.has_value()
-                ? g_textureHandles[cpuMaterial.MetallicRoughnessTextureIndex.value()]
-                : 0,
-            .EmissiveTextureHandle = cpuMaterial.EmissiveTextureIndex.has_value()
-                ? g_textureHandles[cpuMaterial.EmissiveTextureIndex.value()]
-                : 0,
-            ._padding1 = 0,
-        };
-        glNamedBufferSubData(gpuMaterialBuffer, sizeof(SGpuMaterial) * materialIndex, sizeof(SGpuMaterial), &gpuMaterial);
-        materialIndex++;
-    }
+        for (auto materialIndex = 0; auto& cpuMaterial : g_cpuMaterials) {
+
+            glNamedBufferSubData(cpuMaterialBuffer.Id, sizeof(SCpuMaterial) * materialIndex, sizeof(SGpuMaterial), &cpuMaterial);
+            auto gpuMaterial = SGpuMaterial{
+                .BaseColor = cpuMaterial.BaseColor,
+                .BaseTextureHandle = getResidentTextureHandle(cpuMaterial.BaseTextureIndex),
+                .NormalTextureHandle = getResidentTextureHandle(cpuMaterial.NormalTextureIndex),
+                .OcclusionTextureHandle = getResidentTextureHandle(cpuMaterial.OcclusionTextureIndex),
+                .MetallicRoughnessTextureHandle = getResidentTextureHandle(cpuMaterial.MetallicRoughnessTextureIndex),
+                .EmissiveTextureHandle = getResidentTextureHandle(cpuMaterial.EmissiveTextureIndex),
+                ._padding1 = 0,
+            };
+            glNamedBufferSubData(gpuMaterialBuffer.Id, sizeof(SGpuMaterial) * materialIndex, sizeof(SGpuMaterial), &gpuMaterial);
+            materialIndex++;
+        }
+        g_gpuMaterialsNeedUpdate = false;
+    };
 
-    auto primitiveCount = 0;
-    for (auto meshIndex = 0; auto mesh : model.Meshes) {
+    // rebuilds objects, meshlets and batches from the ready models of the scene, whenever models were added or became ready
+    auto updateScene = [&]() {
 
-        auto transform = mesh.WorldMatrix;
-        for (auto primitiveIndex = 0; auto primitive : mesh.Primitives) {
+        TOADWART_PROFILE_NAMED_SCOPE("UpdateScene");
 
-            SObject object = {
-                .WorldMatrix = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f)) * transform,
-                .InstanceParameter = glm::ivec4(primitive.Material.MaterialIndex, 0, 0, 0)
-            };
-            glNamedBufferSubData(objectBuffer, sizeof(SObject) * primitiveCount, sizeof(SObject), &object);
+        if (g_gpuMaterialsNeedUpdate) {
+            uploadMaterials();
+        }
+
+        gpuMeshlets.clear();
+        primitiveInstances.clear();
+        objects.clear();
+        drawBuckets.clear();
+        gpuCullObjects.clear();
+        gpuPrimitiveLods.clear();
+        sceneModels.clear();
+        sceneVersion++;
+
+        for (const auto& sceneModelName : g_sceneModelNames) {
+
+            auto& model = g_modelNameToModelMap[sceneModelName];
+            if (model.State != EModelState::Ready) {
+                continue;
+            }
+            sceneModels.push_back(&model);
+
+            for (auto& mesh : model.Meshes) {
+                for (auto& primitive : mesh.Primitives) {
+                    primitiveInstances.push_back(SPrimitiveInstance{
+                        .Model = &model,
+                        .ModelIndex = static_cast<uint32_t>(sceneModels.size() - 1),
+                        .Primitive = &primitive,
+                        .TransformNode = mesh.TransformNode,
+                        .WorldMatrix = GetWorldMatrix(g_transformHierarchy, mesh.TransformNode)
+                    });
+                }
+            }
+        }
 
-            SGpuPooledPrimitive gpuPooledPrimitive = {
-                .IndexCount = static_cast<uint32_t>(primitive.Primitive.IndexCount),
-                .InstanceCount = 1,
-                .FirstIndex = static_cast<uint32_t>(primitive.Primitive.IndexOffset),
+        auto getDrawBucketKey = [](const SPrimitiveInstance& primitiveInstance) {
+            const auto& primitive = *primitiveInstance.Primitive;
+            return std::make_pair(primitive.Primitive.IndexType, GetMaterialFeatures(g_cpuMaterials[primitive.Material.MaterialIndex]));
+        };
+        std::ranges::stable_sort(primitiveInstances, std::less{}, getDrawBucketKey);
+
+        for (auto primitiveIndex = 0u; auto& primitiveInstance : primitiveInstances) {
+
+            const auto& primitive = *primitiveInstance.Primitive;
+            const auto [indexType, materialFeatures] = getDrawBucketKey(primitiveInstance);
+
+            if (drawBuckets.empty() || drawBuckets.back().IndexType != indexType || drawBuckets.back().MaterialFeatures != materialFeatures) {
+                const auto is16Bit = indexType == EIndexType::UnsignedShort;
+                drawBuckets.push_back(SDrawBucket{
+                    .IndexType = indexType,
+                    .IndexBuffer = is16Bit ? &geometryPool.Indices16 : &geometryPool.Indices,
+                    .ElementType = static_cast<uint32_t>(is16Bit ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT),
+                    .MaterialFeatures = materialFeatures,
+                    .FirstPrimitive = primitiveIndex,
+                    .PrimitiveCount = 0,
+                    .VisiblePrimitiveCount = 0,
+                    .FirstMeshlet = static_cast<uint32_t>(gpuMeshlets.size()),
+                    .MeshletCount = 0
+                });
+            }
+            auto& drawBucket = drawBuckets.back();
+
+            // the culling pass appends the visible meshlets of the object to the range and count of its bucket
+            objects.push_back(SObject{
+                .WorldMatrix = primitiveInstance.WorldMatrix,
+                .InstanceParameter = glm::ivec4(primitive.Material.MaterialIndex, drawBuckets.size() - 1, drawBucket.FirstMeshlet, drawBucket.FirstPrimitive),
+                .PositionScale = glm::vec4(primitive.Quantization.Scale, 0.0f),
+                .PositionOffset = glm::vec4(primitive.Quantization.Offset, 0.0f)
+            });
+
+            gpuCullObjects.push_back(SGpuCullObject{
+                .CenterRadius = glm::vec4(primitive.Center, primitive.Radius),
+                .Extent = primitive.Extent,
+                .FirstLod = static_cast<uint32_t>(gpuPrimitiveLods.size()),
+                .LodCount = static_cast<uint32_t>(primitive.Lods.size()),
                 .BaseVertex = static_cast<int32_t>(primitive.Primitive.VertexOffset),
-                .BaseInstance = 0
-            };
-            glNamedBufferSubData(objectIndirectBuffer, sizeof(SGpuPooledPrimitive) * primitiveCount, sizeof(SGpuPooledPrimitive), &gpuPooledPrimitive);
+                .HasMeshlets = primitive.Meshlets.empty() ? 0u : 1u,
+                .ModelIndex = primitiveInstance.ModelIndex
+            });
+            gpuPrimitiveLods.insert(gpuPrimitiveLods.end(), primitive.Lods.begin(), primitive.Lods.end());
+
+            for (auto& meshlet : primitive.Meshlets) {
+                gpuMeshlets.push_back(SGpuMeshlet{
+                    .CenterRadius = glm::vec4(meshlet.Center, meshlet.Radius),
+                    .ConeApexCutoff = glm::vec4(meshlet.ConeApex, meshlet.ConeCutoff),
+                    .ConeAxis = glm::vec4(meshlet.ConeAxis, 0.0f),
+                    .FirstIndex = static_cast<uint32_t>(primitive.Primitive.IndexOffset + meshlet.IndexOffset),
+                    .IndexCount = meshlet.IndexCount,
+                    .BaseVertex = static_cast<int32_t>(primitive.Primitive.VertexOffset),
+                    .ObjectIndex = primitiveIndex
+                });
+            }
+
+            drawBucket.PrimitiveCount++;
+            drawBucket.MeshletCount = static_cast<uint32_t>(gpuMeshlets.size()) - drawBucket.FirstMeshlet;
             primitiveIndex++;
-            primitiveCount++;
         }
 
-        meshIndex++;
+        for (const auto& drawBucket : drawBuckets) {
+            if (materialPermutations.contains(drawBucket.MaterialFeatures)) {
+                continue;
+            }
+            auto materialPermutation = CreateMaterialPermutation(simpleVertexShader, drawBucket.MaterialFeatures);
+            if (!materialPermutation) {
+                spdlog::error(materialPermutation.error());
+                continue;
+            }
+            materialPermutations[drawBucket.MaterialFeatures] = *materialPermutation;
+        }
+
+        gpuPooledPrimitives.resize(primitiveInstances.size());
+        objectVisibilities.resize(primitiveInstances.size());
+        objectLods.resize(primitiveInstances.size());
+
+        ResizeCullingBounds(cullingBounds, static_cast<uint32_t>(primitiveInstances.size()));
+        for (auto objectIndex = 0u; const auto& primitiveInstance : primitiveInstances) {
+            const auto& primitive = *primitiveInstance.Primitive;
+            SetCullingBounds(cullingBounds, objectIndex++, primitiveInstance.WorldMatrix, primitive.Center, primitive.Extent);
+        }
+
+        // contents are rewritten right away, growing copies the old objects over for nothing but keeps it simple
+        const auto objectCount = static_cast<uint32_t>(objects.size());
+        if (objectCount > objectBuffer.Capacity) {
+            const auto objectCapacity = std::max(objectBuffer.Capacity * 2, objectCount);
+            GrowBuffer(objectBuffer, objectCapacity);
+            GrowBuffer(objectIndirectBuffer, objectCapacity);
+            GrowBuffer(objectLodBuffer, objectCapacity);
+            GrowBuffer(cullObjectBuffer, objectCapacity);
+        }
+        glNamedBufferSubData(objectBuffer.Id, 0, sizeof(SObject) * objects.size(), objects.data());
+        glNamedBufferSubData(cullObjectBuffer.Id, 0, sizeof(SGpuCullObject) * gpuCullObjects.size(), gpuCullObjects.data());
+
+        glDeleteBuffers(1, &primitiveLodBuffer);
+        glCreateBuffers(1, &primitiveLodBuffer);
+        SetDebugLabel(primitiveLodBuffer, GL_BUFFER, "PrimitiveLods");
+        glNamedBufferStorage(primitiveLodBuffer, sizeof(SPrimitiveLod) * std::max<std::size_t>(gpuPrimitiveLods.size(), 1), gpuPrimitiveLods.data(), 0);
+
+        meshletCount = static_cast<uint32_t>(gpuMeshlets.size());
+
+        // meshlet buffers are immutable, they are sized for the scene and created again when it changes
+        glDeleteBuffers(1, &meshletBuffer);
+        glCreateBuffers(1, &meshletBuffer);
+        SetDebugLabel(meshletBuffer, GL_BUFFER, "Meshlets");
+        glNamedBufferStorage(meshletBuffer, sizeof(SGpuMeshlet) * std::max(meshletCount, 1u), gpuMeshlets.data(), 0);
+
+        glDeleteBuffers(1, &meshletIndirectBuffer);
+        glCreateBuffers(1, &meshletIndirectBuffer);
+        SetDebugLabel(meshletIndirectBuffer, GL_BUFFER, "MeshletIndirect");
+        glNamedBufferStorage(meshletIndirectBuffer, sizeof(SGpuPooledPrimitive) * std::max(meshletCount, 1u), nullptr, 0);
+    };
+
+    // writes the objects whose transform node moved in the last transform update, returns how many were written
+    std::vector<std::pair<uint32_t, uint32_t>> objectWriteRanges;
+    auto writeChangedObjects = [&]() -> uint32_t {
+
+        TOADWART_PROFILE_NAMED_SCOPE("WriteChangedObjects");
+
+        objectWriteRanges.clear();
+        for (auto objectIndex = 0u; objectIndex < objects.size(); objectIndex++) {
+
+            auto& primitiveInstance = primitiveInstances[objectIndex];
+            if (!IsTransformNodeChanged(g_transformHierarchy, primitiveInstance.TransformNode)) {
+                continue;
+            }
+
+            primitiveInstance.WorldMatrix = GetWorldMatrix(g_transformHierarchy, primitiveInstance.TransformNode);
+            objects[objectIndex].WorldMatrix = primitiveInstance.WorldMatrix;
+            SetCullingBounds(cullingBounds, objectIndex, primitiveInstance.WorldMatrix, primitiveInstance.Primitive->Center, primitiveInstance.Primitive->Extent);
+            if (!objectWriteRanges.empty() && objectWriteRanges.back().second == objectIndex) {
+                objectWriteRanges.back().second++;
+            } else {
+                objectWriteRanges.emplace_back(objectIndex, objectIndex + 1);
+            }
+        }
+
+        if (objectWriteRanges.size() > g_maxObjectWriteRanges) {
+            objectWriteRanges = { { objectWriteRanges.front().first, objectWriteRanges.back().second } };
+        }
+
+        auto writtenObjectCount = 0u;
+        for (const auto& [firstObject, lastObject] : objectWriteRanges) {
+            glNamedBufferSubData(objectBuffer.Id, sizeof(SObject) * firstObject, sizeof(SObject) * (lastObject - firstObject), &objects[firstObject]);
+            writtenObjectCount += lastObject - firstObject;
+        }
+        return writtenObjectCount;
+    };
+
+    UpdateTransformHierarchy(g_transformHierarchy);
+    updateScene();
+
+    auto changedTransformNodeCount = 0u;
+    auto writtenObjectCount = 0u;
+
+    // model files the editor offers to load
+    std::vector<std::filesystem::path> modelFilePaths;
+    std::error_code directoryErrorCode;
+    for (const auto& directoryEntry : std::filesystem::recursive_directory_iterator("data", directoryErrorCode)) {
+        const auto extension = directoryEntry.path().extension();
+        if (directoryEntry.is_regular_file() && (extension == ".gltf" || extension == ".glb")) {
+            modelFilePaths.push_back(directoryEntry.path());
+        }
     }
+    std::sort(modelFilePaths.begin(), modelFilePaths.end());
 
     auto isSrgbDisabled = false;
     auto isCullfaceDisabled = false;
@@ -1438,6 +3846,17 @@ auto main(
     g_sceneViewerSize = g_framebufferSize;
     glm::vec2 scaledFramebufferSize = glm::vec2(g_sceneViewerSize) * windowSettings.ResolutionScale;
 
+    // the default cube models the defragmentation stress loads and unloads
+    std::vector<std::filesystem::path> stressModelFilePaths;
+    for (const auto* stressModelFilePath : { "data/default/SM_Deccer_Cubes_Textured.gltf", "data/default/SM_Deccer_Cubes_Textured_Complex.gltf", "data/default/SM_Deccer_Cubes_Textured_Embedded.gltf" }) {
+        if (std::filesystem::exists(stressModelFilePath)) {
+            stressModelFilePaths.emplace_back(stressModelFilePath);
+        }
+    }
+    std::vector<std::string> stressModelNames;
+    uint32_t stressModelCounter = 0;
+    auto stressRandom = std::mt19937(1337);
+
     uint64_t frameCounter = 0;
 
     auto previousTimeInSeconds = glfwGetTime();
@@ -1453,14 +3872,194 @@ auto main(
         previousTimeInSeconds = currentTimeInSeconds;
 
         HandleCamera(deltaTimeInSeconds);
+
+        // loads and unloads the default cube models at random, keeps the geometry pool fragmenting for the defragmenter
+        if (g_isDefragmentationStressEnabled && !stressModelFilePaths.empty() && (frameCounter % 4) == 0) {
+
+            const auto isLoading = stressModelNames.size() < 8 || (stressModelNames.size() < 64 && (stressRandom() % 2) == 0);
+            if (isLoading) {
+                auto stressModelName = std::format("SM_Stress_{}", stressModelCounter++);
+                AddModelFromFileAsync(stressModelName, stressModelFilePaths[stressRandom() % stressModelFilePaths.size()]);
+                g_sceneModelNames.push_back(stressModelName);
+                stressModelNames.push_back(std::move(stressModelName));
+            } else {
+                const auto stressModelIndex = stressRandom() % stressModelNames.size();
+                const auto stressModelState = g_modelNameToModelMap[stressModelNames[stressModelIndex]].State;
+                if (stressModelState == EModelState::Ready || stressModelState == EModelState::Failed) {
+                    UnloadModel(stressModelNames[stressModelIndex], geometryPool);
+                    stressModelNames.erase(stressModelNames.begin() + static_cast<std::ptrdiff_t>(stressModelIndex));
+                }
+            }
+        }
+
+        // everything built from files changed on disk is rebuilt here, between two frames
+        if (const auto changedFilePaths = PopChangedFiles(g_hotReloadSettleTime); !changedFilePaths.empty()) {
+            ReloadShaderPrograms(changedFilePaths);
+            ReloadModels(changedFilePaths);
+        }
+        ProcessShaderProgramCompiles();
+
+        ProcessUploadQueue(g_uploadBudgetInMilliseconds);
+        auto isSceneChanged = ProcessModelLoadCompletions(geometryPool, megaMaterialBuffer.Id);
+        isSceneChanged |= ProcessModelReloads(geometryPool);
+        if (g_isDefragmentationEnabled) {
+            isSceneChanged |= DefragmentGeometryPool(geometryPool, static_cast<std::size_t>(g_defragmentationBudgetInKiB) * 1024);
+        }
+
+        // Transform Update
+        // a scene which is rebuilt anyway picks up the new world matrices, otherwise only objects of moved nodes are written
+
+        {
+            TOADWART_PROFILE_NAMED_SCOPE("UpdateTransforms");
+
+            if (g_isTransformAnimationEnabled) {
+                const auto rotation = glm::angleAxis(static_cast<float>(deltaTimeInSeconds) * g_transformAnimationSpeed, glm::vec3(0.0f, 1.0f, 0.0f));
+                for (auto& [modelName, model] : g_modelNameToModelMap) {
+                    if (model.State != EModelState::Ready) {
+                        continue;
+                    }
+                    for (auto& mesh : model.Meshes) {
+                        const auto meshRotation = GetTransformNodeRotation(g_transformHierarchy, mesh.TransformNode);
+                        SetTransformNodeRotation(g_transformHierarchy, mesh.TransformNode, glm::normalize(rotation * meshRotation));
+                    }
+                }
+            }
+
+            changedTransformNodeCount = UpdateTransformHierarchy(g_transformHierarchy);
+            writtenObjectCount = 0;
+            if (isSceneChanged || g_sceneNeedsUpdate) {
+                updateScene();
+                g_sceneNeedsUpdate = false;
+            } else if (changedTransformNodeCount > 0) {
+                writtenObjectCount = writeChangedObjects();
+            }
+        }
+
         globalUniforms = {
             .ProjectionMatrix = glm::perspectiveFovRH_ZO(glm::radians(60.0f), (float)g_sceneViewerSize.x, (float)g_sceneViewerSize.y, 0.1f, 1024.0f),
             .ViewMatrix = g_mainCamera.GetViewMatrix(),
             .CameraPosition = glm::vec4(g_mainCamera.Position, 0.0f)
         };
 
+        const auto useMeshletCulling = g_useMeshletCulling && meshletCount > 0;
+        const auto useGpuCulling = g_useGpuCulling && !objects.empty();
+        // the cpu path still runs next to the gpu pass when it is validated, it only skips uploading
+        const auto useCpuCulling = !useGpuCulling || g_isGpuCullingValidationEnabled;
+        const auto projectionScale = static_cast<float>(g_sceneViewerSize.y) / (2.0f * glm::tan(glm::radians(60.0f) * 0.5f));
+
+        const auto frustumPlanes = GetFrustumPlanes(globalUniforms.ProjectionMatrix * globalUniforms.ViewMatrix);
+        std::copy(frustumPlanes.begin(), frustumPlanes.end(), globalUniforms.FrustumPlanes);
+
         glNamedBufferSubData(globalUniformsBuffer, 0, sizeof(SGlobalUniforms), &globalUniforms);
 
+        // Frustum Culling
+
+        if (useCpuCulling) {
+            TOADWART_PROFILE_NAMED_SCOPE("CullObjects");
+
+            if (g_useFrustumCulling) {
+                visibleObjectCount = CullBounds(cullingBounds, frustumPlanes, objectVisibilities);
+            } else {
+                std::fill(objectVisibilities.begin(), objectVisibilities.end(), 1);
+                visibleObjectCount = static_cast<uint32_t>(objectVisibilities.size());
+            }
+        }
+
+        // Lod Selection
+        // lod 0 of a primitive is drawn through its meshlets when meshlet culling is on, the culling pass skips
+        // the meshlets of every primitive which is out of view or got a coarser lod here
+
+        if (useCpuCulling) {
+            TOADWART_PROFILE_NAMED_SCOPE("SelectLods");
+
+            for (auto& drawBucket : drawBuckets) {
+
+                drawBucket.VisiblePrimitiveCount = 0;
+                for (auto objectIndex = drawBucket.FirstPrimitive; objectIndex < drawBucket.FirstPrimitive + drawBucket.PrimitiveCount; objectIndex++) {
+
+                    if (objectVisibilities[objectIndex] == 0) {
+                        objectLods[objectIndex] = g_objectLodCulled;
+                        continue;
+                    }
+
+                    // materials of whatever is in view keep their texture handles resident
+                    const auto& primitiveInstance = primitiveInstances[objectIndex];
+                    const auto& primitive = *primitiveInstance.Primitive;
+                    TouchMaterial(primitive.Material.MaterialIndex);
+                    primitiveInstance.Model->LastUsedFrame = g_residencyFrameIndex;
+
+                    const auto lodIndex = g_useLods
+                        ? SelectLod(primitive.Lods, primitive.Center, primitive.Radius, primitiveInstance.WorldMatrix, g_mainCamera.Position, projectionScale, g_lodErrorThreshold)
+                        : 0u;
+                    const auto& lod = primitive.Lods[lodIndex];
+                    objectLods[objectIndex] = lodIndex;
+                    if (useMeshletCulling && lodIndex == 0 && !primitive.Meshlets.empty()) {
+                        continue;
+                    }
+
+                    gpuPooledPrimitives[drawBucket.FirstPrimitive + drawBucket.VisiblePrimitiveCount++] = SGpuPooledPrimitive{
+                        .IndexCount = lod.IndexCount,
+                        .InstanceCount = 1,
+                        .FirstIndex = lod.IndexOffset,
+                        .BaseVertex = static_cast<int32_t>(primitive.Primitive.VertexOffset),
+                        .BaseInstance = objectIndex
+                    };
+                }
+
+                if (!useGpuCulling && drawBucket.VisiblePrimitiveCount > 0) {
+                    glNamedBufferSubData(
+                        objectIndirectBuffer.Id,
+                        drawBucket.FirstPrimitive * sizeof(SGpuPooledPrimitive),
+                        drawBucket.VisiblePrimitiveCount * sizeof(SGpuPooledPrimitive),
+                        &gpuPooledPrimitives[drawBucket.FirstPrimitive]);
+                }
+            }
+            if (!useGpuCulling && useMeshletCulling && !objectLods.empty()) {
+                glNamedBufferSubData(objectLodBuffer.Id, 0, objectLods.size() * sizeof(uint32_t), objectLods.data());
+            }
+        }
+
+        // the oldest seen bits, the culling pass writes them again this frame. a fence which didn't pass yet only
+        // loses the bits of that frame, idle handles take far longer than that to become non-resident
+        if (useGpuCulling) {
+
+            auto& seenBuffer = seenBuffers[seenBufferIndex];
+            if (seenBuffer.Fence != nullptr) {
+                const auto waitResult = glClientWaitSync(seenBuffer.Fence, 0, 0);
+                if ((waitResult == GL_ALREADY_SIGNALED || waitResult == GL_CONDITION_SATISFIED) && seenBuffer.SceneVersion == sceneVersion) {
+
+                    TOADWART_PROFILE_NAMED_SCOPE("ReadSeenBits");
+
+                    seenBits.resize(seenBuffer.WordCount);
+                    glGetNamedBufferSubData(seenBuffer.Buffer, 0, sizeof(uint32_t) * seenBits.size(), seenBits.data());
+                    for (auto wordIndex = 0u; wordIndex < seenBuffer.WordCount; wordIndex++) {
+                        for (auto bits = seenBits[wordIndex]; bits != 0; bits &= bits - 1) {
+                            const auto index = wordIndex * 32 + static_cast<uint32_t>(std::countr_zero(bits));
+                            if (wordIndex < seenBuffer.ModelFirstWord) {
+                                if (index < g_cpuMaterials.size()) {
+                                    TouchMaterial(index);
+                                }
+                            } else if (index - seenBuffer.ModelFirstWord * 32 < sceneModels.size()) {
+                                sceneModels[index - seenBuffer.ModelFirstWord * 32]->LastUsedFrame = g_residencyFrameIndex;
+                            }
+                        }
+                    }
+                }
+                glDeleteSync(seenBuffer.Fence);
+                seenBuffer.Fence = nullptr;
+            }
+        }
+
+        {
+            TOADWART_PROFILE_NAMED_SCOPE("UpdateResidency");
+
+            UpdateResidency();
+            if (g_gpuMaterialsNeedUpdate) {
+                uploadMaterials();
+            }
+            g_residencyFrameIndex++;
+        }
+
         shadingUniforms = {
             .SunDirection = glm::vec4(PolarToCartesian(g_sunElevation, g_sunAzimuth), 0),
             .SunStrength = glm::vec4{g_sunStrength * g_sunColor, 0}
@@ -1509,15 +4108,102 @@ auto main(
         PopDebugGroup();
         */
 
+        // Object Culling Pass
+
+        if (useGpuCulling) {
+
+            PushDebugGroup("CullObjects");
+
+            glClearNamedBufferData(objectIndirectCountBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+            glBindProgramPipeline(cullObjectsProgramPipeline);
+            glProgramUniform1ui(cullObjectsComputeShader.Program, 0, static_cast<uint32_t>(objects.size()));
+            glProgramUniform1f(cullObjectsComputeShader.Program, 1, projectionScale);
+            glProgramUniform1f(cullObjectsComputeShader.Program, 2, g_lodErrorThreshold);
+            glProgramUniform1i(cullObjectsComputeShader.Program, 3, g_useLods ? 1 : 0);
+            glProgramUniform1i(cullObjectsComputeShader.Program, 4, g_useFrustumCulling ? 1 : 0);
+            glProgramUniform1i(cullObjectsComputeShader.Program, 5, useMeshletCulling ? 1 : 0);
+            glBindBufferBase(GL_UNIFORM_BUFFER, 0, globalUniformsBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, objectBuffer.Id);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, objectLodBuffer.Id);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, cullObjectBuffer.Id);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, primitiveLodBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 12, objectIndirectBuffer.Id);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, objectIndirectCountBuffer);
+
+            auto& seenBuffer = seenBuffers[seenBufferIndex];
+            const auto modelFirstWord = (static_cast<uint32_t>(g_cpuMaterials.size()) + 31) / 32;
+            const auto seenWordCount = modelFirstWord + (static_cast<uint32_t>(sceneModels.size()) + 31) / 32;
+            if (seenWordCount > seenBuffer.WordCount) {
+                seenBuffer.WordCount = std::max(seenBuffer.WordCount * 2, seenWordCount);
+                glDeleteBuffers(1, &seenBuffer.Buffer);
+                glCreateBuffers(1, &seenBuffer.Buffer);
+                SetDebugLabel(seenBuffer.Buffer, GL_BUFFER, "SeenBits");
+                glNamedBufferStorage(seenBuffer.Buffer, sizeof(uint32_t) * seenBuffer.WordCount, nullptr, 0);
+            }
+            seenBuffer.ModelFirstWord = modelFirstWord;
+            seenBuffer.SceneVersion = sceneVersion;
+            glClearNamedBufferData(seenBuffer.Buffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+            glProgramUniform1ui(cullObjectsComputeShader.Program, 6, modelFirstWord);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 14, seenBuffer.Buffer);
+
+            glDispatchCompute((static_cast<uint32_t>(objects.size()) + 63) / 64, 1, 1);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+            seenBuffer.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            seenBufferIndex = (seenBufferIndex + 1) % g_seenBufferCount;
+
+            PopDebugGroup();
+
+            // the cpu path is the reference, objects right on a plane may come out different by rounding
+            if (g_isGpuCullingValidationEnabled) {
+
+                TOADWART_PROFILE_NAMED_SCOPE("ValidateGpuCulling");
+
+                gpuObjectLods.resize(objects.size());
+                glGetNamedBufferSubData(objectLodBuffer.Id, 0, sizeof(uint32_t) * gpuObjectLods.size(), gpuObjectLods.data());
+                glGetNamedBufferSubData(objectIndirectCountBuffer, 0, sizeof(uint32_t) * drawBuckets.size(), gpuDrawCounts.data());
+
+                auto mismatchCount = 0u;
+                for (auto objectIndex = 0u; objectIndex < gpuObjectLods.size(); objectIndex++) {
+                    mismatchCount += gpuObjectLods[objectIndex] != objectLods[objectIndex] ? 1 : 0;
+                }
+                for (auto drawBucketIndex = 0u; drawBucketIndex < drawBuckets.size(); drawBucketIndex++) {
+                    mismatchCount += gpuDrawCounts[drawBucketIndex] != drawBuckets[drawBucketIndex].VisiblePrimitiveCount ? 1 : 0;
+                }
+                if (mismatchCount > 0 && gpuCullingMismatchCount == 0) {
+                    spdlog::warn("GPU culling differs from the CPU path in {} objects and draw counts", mismatchCount);
+                }
+                gpuCullingMismatchCount = mismatchCount;
+            }
+        }
+
+        // Meshlet Culling Pass
+
+        if (useMeshletCulling) {
+
+            PushDebugGroup("CullMeshlets");
+
+            glClearNamedBufferData(meshletIndirectCountBuffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+            glBindProgramPipeline(cullMeshletsProgramPipeline);
+            glProgramUniform1ui(cullMeshletsComputeShader.Program, 0, meshletCount);
+            glBindBufferBase(GL_UNIFORM_BUFFER, 0, globalUniformsBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, objectBuffer.Id);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, meshletBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, meshletIndirectBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, meshletIndirectCountBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, objectLodBuffer.Id);
+            glDispatchCompute((meshletCount + 63) / 64, 1, 1);
+            glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+
+            PopDebugGroup();
+        }
+
         // GBuffer Pass
 
         PushDebugGroup("SimplePipeline");
 
-        if (g_debugShowMaterialId) {
-            glBindProgramPipeline(simpleDebugProgramPipeline);
-        } else {
-            glBindProgramPipeline(simpleProgramPipeline);
-        }
         BindFramebuffer(mainFramebuffer);
 
         auto clearDepth = 1.0f;
@@ -1528,22 +4214,69 @@ auto main(
         ClearFramebuffer(mainFramebuffer);
         glEnable(GL_FRAMEBUFFER_SRGB);
 
-        glVertexArrayElementBuffer(g_defaultInputLayout, megaIndexBuffer);
-
         glBindBufferBase(GL_UNIFORM_BUFFER, 0, globalUniformsBuffer);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, megaVertexBufferPosition);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, megaVertexBufferNormalUv);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, objectBuffer);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, gpuMaterialBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, geometryPool.VertexPositions.Id);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, geometryPool.VertexNormalUvs.Id);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, objectBuffer.Id);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, gpuMaterialBuffer.Id);
         glBindBufferBase(GL_UNIFORM_BUFFER, 5, shadingUniformsBuffer);
 
         if (g_debugShowMaterialId) {
-            //glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 19, cpuMaterialBuffer);
+            //glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 19, cpuMaterialBuffer.Id);
             //glBindBufferBase(GL_UNIFORM_BUFFER, 20, debugOptionsBuffer);
         }
 
-        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, objectIndirectBuffer);
-        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, primitiveCount, sizeof(SGpuPooledPrimitive));
+        // the debug view draws every bucket with the same fragment shader
+        if (g_debugShowMaterialId) {
+            glBindProgramPipeline(simpleDebugProgramPipeline);
+        }
+
+        for (auto drawBucketIndex = 0u; auto& drawBucket : drawBuckets) {
+
+            const auto drawCountOffset = drawBucketIndex++ * sizeof(uint32_t);
+            if (!g_debugShowMaterialId) {
+                // a permutation still compiling has nothing to draw with, its bucket shows up once it is done
+                const auto materialPermutation = materialPermutations.find(drawBucket.MaterialFeatures);
+                if (materialPermutation == materialPermutations.end() || materialPermutation->second.FragmentShader->Program == 0) {
+                    continue;
+                }
+                glBindProgramPipeline(materialPermutation->second.ProgramPipeline);
+            }
+
+            glVertexArrayElementBuffer(g_defaultInputLayout, drawBucket.IndexBuffer->Id);
+
+            if (useMeshletCulling && drawBucket.MeshletCount > 0) {
+                glBindBuffer(GL_DRAW_INDIRECT_BUFFER, meshletIndirectBuffer);
+                glBindBuffer(GL_PARAMETER_BUFFER, meshletIndirectCountBuffer);
+                glMultiDrawElementsIndirectCount(
+                    GL_TRIANGLES,
+                    drawBucket.ElementType,
+                    reinterpret_cast<const void*>(drawBucket.FirstMeshlet * sizeof(SGpuPooledPrimitive)),
+                    drawCountOffset,
+                    drawBucket.MeshletCount,
+                    sizeof(SGpuPooledPrimitive));
+            }
+
+            if (useGpuCulling && drawBucket.PrimitiveCount > 0) {
+                glBindBuffer(GL_DRAW_INDIRECT_BUFFER, objectIndirectBuffer.Id);
+                glBindBuffer(GL_PARAMETER_BUFFER, objectIndirectCountBuffer);
+                glMultiDrawElementsIndirectCount(
+                    GL_TRIANGLES,
+                    drawBucket.ElementType,
+                    reinterpret_cast<const void*>(drawBucket.FirstPrimitive * sizeof(SGpuPooledPrimitive)),
+                    drawCountOffset,
+                    drawBucket.PrimitiveCount,
+                    sizeof(SGpuPooledPrimitive));
+            } else if (!useGpuCulling && drawBucket.VisiblePrimitiveCount > 0) {
+                glBindBuffer(GL_DRAW_INDIRECT_BUFFER, objectIndirectBuffer.Id);
+                glMultiDrawElementsIndirect(
+                    GL_TRIANGLES,
+                    drawBucket.ElementType,
+                    reinterpret_cast<const void*>(drawBucket.FirstPrimitive * sizeof(SGpuPooledPrimitive)),
+                    drawBucket.VisiblePrimitiveCount,
+                    sizeof(SGpuPooledPrimitive));
+            }
+        }
 
         PopDebugGroup();
 
@@ -1608,6 +4341,63 @@ auto main(
             ImGui::SliderFloat("Sun Elevation", &g_sunElevation, 0, 3.1415f);
             ImGui::ColorEdit3("Sun Color", &g_sunColor[0], ImGuiColorEditFlags_Float);
             ImGui::SliderFloat("Sun Strength", &g_sunStrength, 0, 500, "%.2f", ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_NoRoundToFormat);
+            ImGui::Checkbox("Frustum Culling", &g_useFrustumCulling);
+            ImGui::Checkbox("GPU Culling", &g_useGpuCulling);
+            if (g_useGpuCulling) {
+                ImGui::Checkbox("Validate Against CPU", &g_isGpuCullingValidationEnabled);
+            }
+            if (!g_useGpuCulling || g_isGpuCullingValidationEnabled) {
+                ImGui::Text("Visible: %u of %zu primitives (%s)", visibleObjectCount, primitiveInstances.size(), IsAvx2CullingSupported() ? "AVX2" : "scalar");
+            }
+            if (g_useGpuCulling && g_isGpuCullingValidationEnabled) {
+                ImGui::Text("GPU/CPU Mismatches: %u", gpuCullingMismatchCount);
+            }
+            ImGui::Checkbox("Meshlet Culling", &g_useMeshletCulling);
+            ImGui::Text("Draw Buckets: %zu, Material Permutations: %zu", drawBuckets.size(), materialPermutations.size());
+            ImGui::Checkbox("Animate Transforms", &g_isTransformAnimationEnabled);
+            ImGui::SliderFloat("Animation Speed", &g_transformAnimationSpeed, 0.0f, 4.0f);
+            ImGui::Text("Transforms: %u nodes, %u changed, %u objects written",
+                GetTransformNodeCount(g_transformHierarchy),
+                changedTransformNodeCount,
+                writtenObjectCount);
+            ImGui::Checkbox("Level of Detail", &g_useLods);
+            ImGui::SliderFloat("Lod Error (px)", &g_lodErrorThreshold, 0.25f, 16.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+
+            const auto& uploadStatistics = GetUploadStatistics();
+            ImGui::SliderFloat("Upload Budget (ms)", &g_uploadBudgetInMilliseconds, 0.1f, 16.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+            ImGui::Text("Uploads: %.2f KiB in %u copies, %.3f ms", uploadStatistics.FrameBytes / 1024.0f, uploadStatistics.FrameCopyCommands, uploadStatistics.FrameMilliseconds);
+            ImGui::Text("Upload Stalls: %u this frame, %u total", uploadStatistics.FrameStalls, uploadStatistics.TotalStalls);
+            ImGui::Text("Pending: %u uploads, %.2f MiB", uploadStatistics.PendingUploads, uploadStatistics.PendingBytes / (1024.0f * 1024.0f));
+
+            ImGui::Checkbox("Defragmentation", &g_isDefragmentationEnabled);
+            ImGui::SliderInt("Defragmentation Budget (KiB)", &g_defragmentationBudgetInKiB, 64, 16384, "%d", ImGuiSliderFlags_Logarithmic);
+            ImGui::Checkbox("Defragmentation Stress", &g_isDefragmentationStressEnabled);
+            ImGui::Text("Fragmentation: %.1f%% vertices, %.1f%% indices, %.1f%% indices16",
+                g_defragmentationStatistics.Fragmentation[0] * 100.0f,
+                g_defragmentationStatistics.Fragmentation[1] * 100.0f,
+                g_defragmentationStatistics.Fragmentation[2] * 100.0f);
+            ImGui::Text("Moved: %.2f KiB this frame, %.2f MiB in %u moves total",
+                g_defragmentationStatistics.FrameBytesMoved / 1024.0f,
+                g_defragmentationStatistics.TotalBytesMoved / (1024.0f * 1024.0f),
+                g_defragmentationStatistics.TotalMoves);
+            const auto geometryAllocators = std::to_array<std::pair<const char*, const SOffsetAllocator*>>({
+                { "Vertices", &geometryPool.VertexAllocator },
+                { "Indices", &geometryPool.IndexAllocator },
+                { "Indices16", &geometryPool.Index16Allocator }
+            });
+            for (const auto& [allocatorName, allocator] : geometryAllocators) {
+                ImGui::Text("%s: %u of %u used, largest free %u", allocatorName, allocator->Size - allocator->FreeStorage, allocator->Size, GetLargestFreeRegion(*allocator));
+            }
+
+            ImGui::SliderInt("GPU Memory Budget (MiB)", &g_gpuMemoryBudgetInMiB, 64, 16384, "%d", ImGuiSliderFlags_Logarithmic);
+            ImGui::Text("GPU Memory: %.2f MiB textures, %.2f MiB buffers",
+                g_residencyStatistics.TextureBytes / (1024.0f * 1024.0f),
+                g_residencyStatistics.BufferBytes / (1024.0f * 1024.0f));
+            ImGui::Text("Residency: %u handles resident, %u images evicted", g_residencyStatistics.ResidentHandles, g_residencyStatistics.EvictedImages);
+            ImGui::Text("Residency: %u evictions, %u mip drops, %u reloads total",
+                g_residencyStatistics.TotalEvictions,
+                g_residencyStatistics.TotalMipDrops,
+                g_residencyStatistics.TotalReloads);
         }
         ImGui::End();
 
@@ -1632,12 +4422,40 @@ auto main(
             }
             ImGui::End();
 
-            if (!g_modelNameToModelMap.empty()) {
+            if (!g_modelNameToModelMap.empty() || !modelFilePaths.empty()) {
                 if (ImGui::Begin("Assets")) {
-                    if (ImGui::BeginTable("Models", 2, ImGuiTableFlags_::ImGuiTableFlags_RowBg)) {
+                    if (ImGui::BeginTable("Files", 2, ImGuiTableFlags_::ImGuiTableFlags_RowBg)) {
+
+                        ImGui::TableSetupColumn("File", ImGuiTableColumnFlags_NoSort);
+                        ImGui::TableSetupColumn("Add", ImGuiTableColumnFlags_NoSort | ImGuiTableColumnFlags_WidthFixed, 32);
+                        ImGui::TableHeadersRow();
+
+                        for (const auto& modelFilePath : modelFilePaths) {
+                            const auto modelFileName = modelFilePath.string();
+                            ImGui::TableNextRow();
+                            ImGui::PushID(modelFileName.c_str());
+                            ImGui::TableSetColumnIndex(0);
+                            ImGui::TextUnformatted(modelFileName.c_str());
+                            ImGui::TableSetColumnIndex(1);
+                            ImGui::BeginDisabled(g_modelNameToModelMap.contains(modelFileName));
+                            if (ImGui::Button("Add")) {
+                                // loads in the background, the model shows up in the scene once it is ready
+                                AddModelFromFileAsync(modelFileName, modelFilePath);
+                                g_sceneModelNames.push_back(modelFileName);
+                            }
+                            ImGui::EndDisabled();
+                            ImGui::PopID();
+                        }
+
+                        ImGui::EndTable();
+                    }
+
+                    std::optional<std::string> modelNameToUnload;
+                    if (ImGui::BeginTable("Models", 3, ImGuiTableFlags_::ImGuiTableFlags_RowBg)) {
                         
                         ImGui::TableSetupColumn("Model", ImGuiTableColumnFlags_NoSort);
                         ImGui::TableSetupColumn("Add", ImGuiTableColumnFlags_NoSort | ImGuiTableColumnFlags_WidthFixed, 32);
+                        ImGui::TableSetupColumn("Unload", ImGuiTableColumnFlags_NoSort | ImGuiTableColumnFlags_WidthFixed, 48);
                         ImGui::TableHeadersRow();
 
                         for (auto& modelNameToModel : g_modelNameToModelMap) {
@@ -1647,11 +4465,30 @@ auto main(
                             ImGui::Image(reinterpret_cast<ImTextureID>(g_iconPackage), ImVec2{16, 16}, g_imvec2UnitY, g_imvec2UnitX);
                             ImGui::SameLine();
                             auto isExpanded = ImGui::TreeNodeEx(modelNameToModel.first.data());
+                            const auto modelState = modelNameToModel.second.State;
+                            if (modelState != EModelState::Ready) {
+                                ImGui::SameLine();
+                                ImGui::TextDisabled(modelState == EModelState::Loading
+                                    ? "(loading)"
+                                    : modelState == EModelState::Uploading
+                                        ? "(uploading)"
+                                        : "(failed)");
+                            }
 
                             ImGui::TableSetColumnIndex(1);
+                            ImGui::BeginDisabled(modelState == EModelState::Failed);
                             if (ImGui::Button("Add")) {
-                                // add model (and its primitives)
+                                g_sceneModelNames.push_back(modelNameToModel.first);
+                                g_sceneNeedsUpdate = true;
+                            }
+                            ImGui::EndDisabled();
+
+                            ImGui::TableSetColumnIndex(2);
+                            ImGui::BeginDisabled(modelState == EModelState::Loading || modelState == EModelState::Uploading);
+                            if (ImGui::Button("Unload")) {
+                                modelNameToUnload = modelNameToModel.first;
                             }
+                            ImGui::EndDisabled();
 
                             if (isExpanded) {
                                 std::vector<SModelMesh>& meshes = modelNameToModel.second.Meshes;
@@ -1665,6 +4502,21 @@ auto main(
                                     if (ImGui::Button("Add")) {
                                         // add primitive
                                     }
+
+                                    for (auto primitiveIndex = 0; auto& primitive : modelMesh.Primitives) {
+                                        const auto& imported = primitive.Statistics.Imported;
+                                        const auto& optimized = primitive.Statistics.Optimized;
+                                        ImGui::TableNextRow();
+                                        ImGui::TableSetColumnIndex(0);
+                                        ImGui::Indent();
+                                        ImGui::TextUnformatted(std::format("Primitive {} ({} triangles, {} meshlets, {} lods, {} bit indices)", primitiveIndex, primitive.Primitive.IndexCount / 3, primitive.Meshlets.size(), primitive.Lods.size(), primitive.Primitive.IndexType == EIndexType::UnsignedShort ? 16 : 32).c_str());
+                                        ImGui::TextUnformatted(std::format("Vertices {} -> {}", imported.VertexCount, optimized.VertexCount).c_str());
+                                        ImGui::TextUnformatted(std::format("ACMR {:.3f} -> {:.3f}", imported.Acmr, optimized.Acmr).c_str());
+                                        ImGui::TextUnformatted(std::format("ATVR {:.3f} -> {:.3f}", imported.Atvr, optimized.Atvr).c_str());
+                                        ImGui::TextUnformatted(std::format("Overdraw {:.3f} -> {:.3f}", imported.Overdraw, optimized.Overdraw).c_str());
+                                        ImGui::Unindent();
+                                        primitiveIndex++;
+                                    }
                                 }
 
                                 ImGui::TreePop();
@@ -1675,6 +4527,11 @@ auto main(
 
                         ImGui::EndTable();
                     }
+
+                    // the primitive instances of the scene point into the model, the scene is rebuilt next frame
+                    if (modelNameToUnload.has_value()) {
+                        UnloadModel(*modelNameToUnload, geometryPool);
+                    }
                 }
                 ImGui::End();
             }
@@ -1821,12 +4678,30 @@ auto main(
         TOADWART_MARK_FRAME();
     }
 
+    DestroyFileWatcher();
+
+    // reloads still in flight would otherwise complete into released images
+    for (auto& textureReloadTask : g_textureReloadTasks) {
+        textureReloadTask.wait();
+    }
+    g_textureReloadTasks.clear();
+    g_textureReloadCompletions.PopAll();
+
+    for (auto& [modelName, model] : g_modelNameToModelMap) {
+        ReleaseModelResources(model);
+    }
+
+    if (!g_isRunningInRenderDoc) {
+        glMakeTextureHandleNonResidentARB(g_fallbackTextureHandle);
+    }
+    glDeleteTextures(1, &g_fallbackTexture);
+
     glDeleteSamplers(1, &g_fullscreenSamplerNearestNearestClampToEdge);
     for(auto sampler : g_samplers) {
         glDeleteSamplers(1, &sampler);
     }
     for (auto textureHandle : g_textureHandles) {
-        if (glIsTextureHandleResidentARB(textureHandle)) {
+        if (textureHandle != 0 && glIsTextureHandleResidentARB(textureHandle)) {
             glMakeTextureHandleNonResidentARB(textureHandle);
         }
     }
@@ -1834,29 +4709,55 @@ auto main(
         glDeleteTextures(1, &texture);
     }
 
-    DestroyFramebuffer(mainFramebuffer);
+    for (auto& modelLoadTask : g_modelLoadTasks) {
+        modelLoadTask.wait();
+    }
+    g_modelLoadTasks.clear();
+    g_modelLoadCompletions.PopAll();
 
-    glDeleteBuffers(1, &objectBuffer);
-    glDeleteBuffers(1, &megaMaterialBuffer);
-    glDeleteBuffers(1, &megaVertexBufferPosition);
-    glDeleteBuffers(1, &megaVertexBufferNormalUv);
-    glDeleteBuffers(1, &megaIndexBuffer);
-    glDeleteBuffers(1, &cpuMaterialBuffer);
-    glDeleteBuffers(1, &gpuMaterialBuffer);
+    DestroyFramebuffer(mainFramebuffer);
+    DestroyUploadQueue();
+
+    DeleteGrowableBuffer(objectBuffer);
+    DeleteGrowableBuffer(objectIndirectBuffer);
+    DeleteGrowableBuffer(objectLodBuffer);
+    DeleteGrowableBuffer(cullObjectBuffer);
+    DeleteGrowableBuffer(megaMaterialBuffer);
+    DeleteGrowableBuffer(geometryPool.VertexPositions);
+    DeleteGrowableBuffer(geometryPool.VertexNormalUvs);
+    DeleteGrowableBuffer(geometryPool.Indices);
+    DeleteGrowableBuffer(geometryPool.Indices16);
+    DeleteGrowableBuffer(cpuMaterialBuffer);
+    DeleteGrowableBuffer(gpuMaterialBuffer);
+    glDeleteBuffers(1, &meshletBuffer);
+    glDeleteBuffers(1, &meshletIndirectBuffer);
+    glDeleteBuffers(1, &meshletIndirectCountBuffer);
+    glDeleteBuffers(1, &primitiveLodBuffer);
+    glDeleteBuffers(1, &objectIndirectCountBuffer);
+    for (auto& seenBuffer : seenBuffers) {
+        if (seenBuffer.Fence != nullptr) {
+            glDeleteSync(seenBuffer.Fence);
+        }
+        glDeleteBuffers(1, &seenBuffer.Buffer);
+    }
 
     glDeleteVertexArrays(1, &g_defaultInputLayout);
 
-    glDeleteProgram(simpleVertexShader);
-    glDeleteProgram(simpleFragmentShader);
-    glDeleteProgram(simpleDebugFragmentShader);
+    for (auto& [shaderProgramLabel, shaderProgram] : g_shaderPrograms) {
+        if (shaderProgram.Compile.has_value()) {
+            AbortProgramCompile(*shaderProgram.Compile);
+        }
+        glDeleteProgram(shaderProgram.Program);
+    }
+    g_shaderPrograms.clear();
     glDeleteProgramPipelines(1, &simpleDebugProgramPipeline);
-    glDeleteProgramPipelines(1, &simpleProgramPipeline);
-    glDeleteProgram(fullscreenTriangleVertexShader);
-    glDeleteProgram(fullscreenTriangleFragmentShader);
+    for (auto& [materialFeatures, materialPermutation] : materialPermutations) {
+        glDeleteProgramPipelines(1, &materialPermutation.ProgramPipeline);
+    }
     glDeleteProgramPipelines(1, &g_fullscreenTrianglePipeline);
-    glDeleteProgram(shadowVertexShader);
-    glDeleteProgram(shadowFragmentShader);
     glDeleteProgramPipelines(1, &shadowProgramPipeline);
+    glDeleteProgramPipelines(1, &cullMeshletsProgramPipeline);
+    glDeleteProgramPipelines(1, &cullObjectsProgramPipeline);
 
     if (g_implotContext != nullptr) {
         ImPlot::DestroyContext(g_implotContext);
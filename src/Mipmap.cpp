@@ -0,0 +1,225 @@
+#include "Mipmap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <span>
+
+#include <glm/vec4.hpp>
+#include <glm/common.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+  #include <xmmintrin.h>
+  #define TOADWART_MIPMAP_SSE
+#endif
+
+constexpr std::size_t g_linearToSrgbTableSize = 4096;
+
+auto SrgbToLinear(float value) -> float {
+    return value <= 0.04045f
+        ? value / 12.92f
+        : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+auto LinearToSrgb(float value) -> float {
+    return value <= 0.0031308f
+        ? value * 12.92f
+        : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+auto CreateSrgbToLinearTable() -> std::array<float, 256> {
+    std::array<float, 256> table = {};
+    for (size_t i = 0; i < table.size(); i++) {
+        table[i] = SrgbToLinear(static_cast<float>(i) / 255.0f);
+    }
+    return table;
+}
+
+auto CreateLinearToSrgbTable() -> std::array<uint8_t, g_linearToSrgbTableSize> {
+    std::array<uint8_t, g_linearToSrgbTableSize> table = {};
+    for (size_t i = 0; i < table.size(); i++) {
+        const auto linear = static_cast<float>(i) / static_cast<float>(table.size() - 1);
+        table[i] = static_cast<uint8_t>(LinearToSrgb(linear) * 255.0f + 0.5f);
+    }
+    return table;
+}
+
+const auto g_srgbToLinearTable = CreateSrgbToLinearTable();
+const auto g_linearToSrgbTable = CreateLinearToSrgbTable();
+
+auto DecodePixel(const uint8_t* pixel, bool isSrgb) -> glm::vec4 {
+    if (isSrgb) {
+        return glm::vec4(
+            g_srgbToLinearTable[pixel[0]],
+            g_srgbToLinearTable[pixel[1]],
+            g_srgbToLinearTable[pixel[2]],
+            static_cast<float>(pixel[3]) / 255.0f);
+    }
+    return glm::vec4(pixel[0], pixel[1], pixel[2], pixel[3]) / 255.0f;
+}
+
+auto EncodePixel(const glm::vec4& color, uint8_t* pixel, bool isSrgb) -> void {
+    const auto clampedColor = glm::clamp(color, 0.0f, 1.0f);
+    if (isSrgb) {
+        constexpr auto tableScale = static_cast<float>(g_linearToSrgbTableSize - 1);
+        pixel[0] = g_linearToSrgbTable[static_cast<size_t>(clampedColor.r * tableScale + 0.5f)];
+        pixel[1] = g_linearToSrgbTable[static_cast<size_t>(clampedColor.g * tableScale + 0.5f)];
+        pixel[2] = g_linearToSrgbTable[static_cast<size_t>(clampedColor.b * tableScale + 0.5f)];
+    } else {
+        pixel[0] = static_cast<uint8_t>(clampedColor.r * 255.0f + 0.5f);
+        pixel[1] = static_cast<uint8_t>(clampedColor.g * 255.0f + 0.5f);
+        pixel[2] = static_cast<uint8_t>(clampedColor.b * 255.0f + 0.5f);
+    }
+    pixel[3] = static_cast<uint8_t>(clampedColor.a * 255.0f + 0.5f);
+}
+
+// source pixels and weights along one axis of a level pixel. an even size takes 2 pixels, an odd one 3, weighted as
+// a box filter over size / levelSize pixels, so the last row or column of an odd size is spread over the level
+// instead of being dropped
+struct SDownsampleTaps {
+    std::array<uint32_t, 3> Indices;
+    std::array<float, 3> Weights;
+    uint32_t Count;
+};
+
+auto GetDownsampleTaps(
+    uint32_t size,
+    uint32_t levelSize,
+    uint32_t levelIndex) -> SDownsampleTaps {
+
+    if (size == 1) {
+        return { .Indices = { 0, 0, 0 }, .Weights = { 1.0f, 0.0f, 0.0f }, .Count = 1 };
+    }
+    if (size % 2 == 0) {
+        return { .Indices = { levelIndex * 2, levelIndex * 2 + 1, 0 }, .Weights = { 0.5f, 0.5f, 0.0f }, .Count = 2 };
+    }
+
+    const auto sizeScale = 1.0f / static_cast<float>(size);
+    return {
+        .Indices = { levelIndex * 2, levelIndex * 2 + 1, levelIndex * 2 + 2 },
+        .Weights = {
+            static_cast<float>(levelSize - levelIndex) * sizeScale,
+            static_cast<float>(levelSize) * sizeScale,
+            static_cast<float>(levelIndex + 1) * sizeScale },
+        .Count = 3
+    };
+}
+
+// box filter on whole pixels, 2x2 pixels per level pixel, up to 3x3 along odd dimensions. even sizes average the
+// 4 pixels with sse where there is sse, everything else goes through the scalar taps
+auto DownsampleLevel(
+    std::span<const glm::vec4> pixels,
+    uint32_t width,
+    uint32_t height,
+    std::span<glm::vec4> levelPixels) -> void {
+
+    const auto levelWidth = std::max(width / 2, 1u);
+    const auto levelHeight = std::max(height / 2, 1u);
+
+#if defined(TOADWART_MIPMAP_SSE)
+    if (width % 2 == 0 && height % 2 == 0) {
+        const auto quarter = _mm_set1_ps(0.25f);
+        for (uint32_t y = 0; y < levelHeight; y++) {
+            const auto* topRow = &pixels[static_cast<size_t>(y) * 2 * width];
+            const auto* bottomRow = topRow + width;
+            auto* levelRow = &levelPixels[static_cast<size_t>(y) * levelWidth];
+            for (uint32_t x = 0; x < levelWidth; x++) {
+                const auto top = _mm_add_ps(_mm_loadu_ps(&topRow[x * 2].x), _mm_loadu_ps(&topRow[x * 2 + 1].x));
+                const auto bottom = _mm_add_ps(_mm_loadu_ps(&bottomRow[x * 2].x), _mm_loadu_ps(&bottomRow[x * 2 + 1].x));
+                _mm_storeu_ps(&levelRow[x].x, _mm_mul_ps(_mm_add_ps(top, bottom), quarter));
+            }
+        }
+        return;
+    }
+#endif
+
+    std::vector<SDownsampleTaps> columnTaps(levelWidth);
+    for (uint32_t x = 0; x < levelWidth; x++) {
+        columnTaps[x] = GetDownsampleTaps(width, levelWidth, x);
+    }
+
+    for (uint32_t y = 0; y < levelHeight; y++) {
+        const auto rowTaps = GetDownsampleTaps(height, levelHeight, y);
+        auto* levelRow = &levelPixels[static_cast<size_t>(y) * levelWidth];
+        for (uint32_t x = 0; x < levelWidth; x++) {
+            const auto& columnTap = columnTaps[x];
+            auto color = glm::vec4(0.0f);
+            for (uint32_t rowTapIndex = 0; rowTapIndex < rowTaps.Count; rowTapIndex++) {
+                const auto* row = &pixels[static_cast<size_t>(rowTaps.Indices[rowTapIndex]) * width];
+                auto rowColor = glm::vec4(0.0f);
+                for (uint32_t columnTapIndex = 0; columnTapIndex < columnTap.Count; columnTapIndex++) {
+                    rowColor += row[columnTap.Indices[columnTapIndex]] * columnTap.Weights[columnTapIndex];
+                }
+                color += rowColor * rowTaps.Weights[rowTapIndex];
+            }
+            levelRow[x] = color;
+        }
+    }
+}
+
+auto GetMipmapLevelCount(uint32_t width, uint32_t height) -> uint32_t {
+    return 1 + static_cast<uint32_t>(std::floor(std::log2(std::max({width, height, 1u}))));
+}
+
+auto GenerateMipmapChain(
+    const uint8_t* pixels,
+    uint32_t width,
+    uint32_t height,
+    bool isSrgb) -> SMipmapChain {
+
+    SMipmapChain mipmapChain = {};
+    mipmapChain.Width = width;
+    mipmapChain.Height = height;
+    mipmapChain.IsSrgb = isSrgb;
+
+    if (pixels == nullptr || width == 0 || height == 0) {
+        return mipmapChain;
+    }
+
+    const auto levelCount = GetMipmapLevelCount(width, height);
+
+    size_t pixelsSize = 0;
+    for (uint32_t level = 0; level < levelCount; level++) {
+        const auto levelWidth = std::max(width >> level, 1u);
+        const auto levelHeight = std::max(height >> level, 1u);
+        const auto levelSize = static_cast<size_t>(levelWidth) * levelHeight * 4;
+        mipmapChain.Levels.push_back(SMipmapLevel{
+            .Width = levelWidth,
+            .Height = levelHeight,
+            .Offset = pixelsSize,
+            .Size = levelSize
+        });
+        pixelsSize += levelSize;
+    }
+    mipmapChain.Pixels.resize(pixelsSize);
+    std::copy_n(pixels, mipmapChain.Levels[0].Size, mipmapChain.Pixels.begin());
+
+    // every level is filtered from the float version of the previous one, rounding to 8 bit happens once per level
+    auto pixelCount = static_cast<size_t>(width) * height;
+    std::vector<glm::vec4> levelPixels(pixelCount);
+    std::vector<glm::vec4> nextLevelPixels(pixelCount);
+    for (size_t i = 0; i < pixelCount; i++) {
+        levelPixels[i] = DecodePixel(&pixels[i * 4], isSrgb);
+    }
+
+    for (uint32_t level = 1; level < levelCount; level++) {
+        const auto& previousLevel = mipmapChain.Levels[level - 1];
+        const auto& currentLevel = mipmapChain.Levels[level];
+        const auto currentPixelCount = static_cast<size_t>(currentLevel.Width) * currentLevel.Height;
+
+        DownsampleLevel(
+            std::span(levelPixels).first(static_cast<size_t>(previousLevel.Width) * previousLevel.Height),
+            previousLevel.Width,
+            previousLevel.Height,
+            std::span(nextLevelPixels).first(currentPixelCount));
+
+        auto* levelDestination = &mipmapChain.Pixels[currentLevel.Offset];
+        for (size_t i = 0; i < currentPixelCount; i++) {
+            EncodePixel(nextLevelPixels[i], &levelDestination[i * 4], isSrgb);
+        }
+
+        std::swap(levelPixels, nextLevelPixels);
+    }
+
+    return mipmapChain;
+}
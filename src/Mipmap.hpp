@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct SMipmapLevel {
+    uint32_t Width;
+    uint32_t Height;
+    std::size_t Offset;
+    std::size_t Size;
+};
+
+// rgba8 pixels of every level of a texture, tightly packed one level after another
+struct SMipmapChain {
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    bool IsSrgb = false;
+    std::vector<SMipmapLevel> Levels;
+    std::vector<uint8_t> Pixels;
+};
+
+auto GetMipmapLevelCount(uint32_t width, uint32_t height) -> uint32_t;
+
+// builds the full chain down to 1x1 with a box filter. sRGB color is filtered in linear space, alpha always is linear
+auto GenerateMipmapChain(
+    const uint8_t* pixels,
+    uint32_t width,
+    uint32_t height,
+    bool isSrgb) -> SMipmapChain;
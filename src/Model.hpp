@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "Io.hpp"
+#include "OffsetAllocator.hpp"
+#include "TransformHierarchy.hpp"
+#include "VertexFormat.hpp"
+
+struct SSamplerData {
+    uint64_t Name;
+    uint32_t MinFilter;
+    uint32_t MagFilter;
+    uint32_t WrapS;
+    uint32_t WrapT;
+};
+
+struct SCpuMaterial {
+    std::string Name;
+    std::optional<size_t> BaseTextureIndex;
+    std::optional<size_t> NormalTextureIndex;
+    std::optional<size_t> OcclusionTextureIndex;
+    std::optional<size_t> MetallicRoughnessTextureIndex;
+    std::optional<size_t> EmissiveTextureIndex;
+
+    size_t _padding1;
+
+    glm::vec4 BaseColor;
+};
+
+struct SCpuPooledMaterial {
+    size_t MaterialIndex;
+};
+
+// primitives with less than 64k vertices get their indices stored as 16 bit, offsets are in elements of the
+// index stream the primitive lives in
+enum class EIndexType : uint32_t {
+    UnsignedInt,
+    UnsignedShort
+};
+
+struct SCpuPooledPrimitive {
+    size_t VertexCount;
+    size_t VertexOffset;
+    size_t IndexCount;
+    size_t IndexOffset;
+    EIndexType IndexType;
+};
+
+struct SMeshStatistics {
+    uint32_t VertexCount;
+    float Acmr; // average cache miss ratio
+    float Atvr; // average transformed vertex ratio
+    float Overdraw;
+};
+
+struct SMeshOptimizationStatistics {
+    SMeshStatistics Imported;
+    SMeshStatistics Optimized;
+};
+
+// cluster of up to 124 triangles, its indices are stored contiguously in the primitive's index range.
+// bounds and cone are in object space, a cone cutoff of 1 means the cluster can't be backface culled
+struct SMeshlet {
+    glm::vec3 Center;
+    float Radius;
+    glm::vec3 ConeApex;
+    float ConeCutoff;
+    glm::vec3 ConeAxis;
+    uint32_t IndexOffset;
+    uint32_t IndexCount;
+};
+
+// simplified index range of a primitive, lod 0 is the primitive itself. error is the object space
+// deviation from lod 0 and is what gets projected to the screen when picking a lod
+struct SPrimitiveLod {
+    uint32_t IndexOffset;
+    uint32_t IndexCount;
+    float Error;
+};
+
+struct SPrimitive {
+    SCpuPooledPrimitive Primitive;
+    SCpuPooledMaterial Material;
+    SMeshOptimizationStatistics Statistics;
+    std::vector<SMeshlet> Meshlets;
+    // bounding sphere and half size of the bounding box around the same center, in object space
+    glm::vec3 Center;
+    float Radius;
+    glm::vec3 Extent;
+    std::vector<SPrimitiveLod> Lods;
+    SVertexQuantization Quantization;
+};
+
+struct SModelMesh {
+    std::string Name;
+    // node in g_transformHierarchy below the node of the model, its local transform is what the importer baked
+    uint32_t TransformNode = g_transformNodeNone;
+    std::vector<SPrimitive> Primitives;
+};
+
+// a model is loading while a worker imports it, uploading until the upload queue submitted all of its data
+enum class EModelState : uint32_t {
+    Loading,
+    Uploading,
+    Ready,
+    Failed
+};
+
+struct SModel {
+    std::string Name;
+    std::filesystem::path FilePath;
+    // files the model was built from (glTF, buffers and images), the model is reloaded when one of them changes
+    std::vector<std::filesystem::path> DependencyFilePaths;
+    std::vector<SModelMesh> Meshes;
+    // places the model in the scene, the nodes of its meshes hang off it
+    uint32_t TransformNode = g_transformNodeNone;
+    // last upload of the model's geometry and textures, see IsUploadSubmitted
+    uint64_t UploadId = 0;
+    EModelState State = EModelState::Loading;
+    // ranges of the model in the geometry pool, given back when the model is unloaded
+    SOffsetAllocation VertexAllocation;
+    SOffsetAllocation IndexAllocation;
+    SOffsetAllocation Index16Allocation;
+    // references the model holds on shared textures and materials, see ReleaseModelResources
+    std::vector<uint64_t> TextureKeys;
+    std::vector<uint64_t> MaterialKeys;
+    // residency frame the model was last in view, see UpdateResidency
+    uint64_t LastUsedFrame = 0;
+};
+
+struct SModelImportSettings {
+    bool OptimizeMeshes = true;
+    bool GenerateMeshlets = true;
+    bool GenerateLods = true;
+    bool WeldVertices = true;
+};
+
+// CPU side of a model before it is uploaded, produced by the glTF importer or read back from the model cache.
+// Offsets are relative to the model's own vertex and index streams
+
+struct SModelDataDependency {
+    std::filesystem::path FilePath;
+    uint64_t FileSize;
+    int64_t LastWriteTime;
+    uint64_t ContentHash;
+};
+
+struct SModelDataPrimitive {
+    uint32_t VertexOffset;
+    uint32_t VertexCount;
+    uint32_t IndexOffset;
+    uint32_t IndexCount;
+    EIndexType IndexType;
+    uint32_t MaterialIndex;
+    uint32_t MeshletOffset;
+    uint32_t MeshletCount;
+    uint32_t LodOffset;
+    uint32_t LodCount;
+    glm::vec3 Center;
+    float Radius;
+    glm::vec3 Extent;
+    SVertexQuantization Quantization;
+    SMeshOptimizationStatistics Statistics;
+};
+
+struct SModelDataMesh {
+    std::string Name;
+    glm::mat4 WorldMatrix;
+    uint32_t PrimitiveOffset;
+    uint32_t PrimitiveCount;
+};
+
+struct SModelDataTexture {
+    uint32_t ImageIndex;
+    uint32_t SamplerIndex;
+};
+
+struct SModelDataImage {
+    std::string Name;
+    std::filesystem::path FilePath; // empty when the image is embedded
+    std::vector<std::byte> EncodedData;
+};
+
+struct SModelData {
+    std::string Name;
+    SModelImportSettings ImportSettings;
+    std::vector<SModelDataDependency> Dependencies;
+    std::vector<SModelDataMesh> Meshes;
+    std::vector<SModelDataPrimitive> Primitives;
+    std::vector<SMeshlet> Meshlets;
+    std::vector<SPrimitiveLod> Lods;
+    std::vector<SCpuMaterial> Materials;
+    std::vector<SSamplerData> Samplers;
+    std::vector<SModelDataTexture> Textures;
+    std::vector<SModelDataImage> Images;
+
+    std::span<const SVertexPosition> VertexPositions;
+    std::span<const SVertexNormalUv> VertexNormalUvs;
+    std::span<const uint32_t> Indices;
+    std::span<const uint16_t> Indices16;
+
+    // backing storage of the streams above, either filled by the importer or a mapped model cache file
+    std::vector<SVertexPosition> ImportedVertexPositions;
+    std::vector<SVertexNormalUv> ImportedVertexNormalUvs;
+    std::vector<uint32_t> ImportedIndices;
+    std::vector<uint16_t> ImportedIndices16;
+    SMappedFile MappedFile;
+};
@@ -0,0 +1,556 @@
+#include "ModelCache.hpp"
+#include "Hash.hpp"
+
+#include <array>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+// Layout of a cooked model
+//
+// SModelCacheHeader
+// SModelCacheChunk[ChunkCount]
+// chunk data, every chunk starts 16 byte aligned
+//
+// Vertex, index and primitive streams are used straight from the mapped file
+
+constexpr uint32_t g_modelCacheMagic = 0x4D435754; // TWCM
+constexpr uint32_t g_modelCacheVersion = 9;
+constexpr std::size_t g_modelCacheChunkAlignment = 16;
+constexpr int64_t g_modelCacheNoIndex = -1;
+
+const std::filesystem::path g_modelCacheDirectory = "cache/models";
+
+enum class EModelCacheChunk : uint32_t {
+    Strings,
+    Dependencies,
+    Meshes,
+    Primitives,
+    Materials,
+    Samplers,
+    Textures,
+    Images,
+    ImageData,
+    VertexPositions,
+    VertexNormalUvs,
+    Indices,
+    Meshlets,
+    Lods,
+    Indices16
+};
+
+struct SModelCacheString {
+    uint32_t Offset;
+    uint32_t Size;
+};
+
+struct SModelCacheHeader {
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t ChunkCount;
+    uint32_t ImportSettings;
+    uint32_t VertexFormat;
+    uint32_t _padding1;
+    SModelCacheString SourcePath;
+};
+
+struct SModelCacheChunk {
+    EModelCacheChunk Type;
+    uint32_t _padding1;
+    uint64_t Offset;
+    uint64_t Size;
+};
+
+struct SModelCacheDependency {
+    SModelCacheString FilePath;
+    uint64_t FileSize;
+    int64_t LastWriteTime;
+    uint64_t ContentHash;
+};
+
+struct SModelCacheMesh {
+    glm::mat4 WorldMatrix;
+    SModelCacheString Name;
+    uint32_t PrimitiveOffset;
+    uint32_t PrimitiveCount;
+};
+
+struct SModelCacheMaterial {
+    glm::vec4 BaseColor;
+    SModelCacheString Name;
+    int64_t BaseTextureIndex;
+    int64_t NormalTextureIndex;
+    int64_t OcclusionTextureIndex;
+    int64_t MetallicRoughnessTextureIndex;
+    int64_t EmissiveTextureIndex;
+};
+
+struct SModelCacheImage {
+    SModelCacheString Name;
+    SModelCacheString FilePath;
+    uint64_t EncodedDataOffset;
+    uint64_t EncodedDataSize;
+};
+
+struct SModelCacheWriter {
+    std::string Strings;
+    std::vector<SModelCacheChunk> Chunks;
+    std::vector<std::span<const std::byte>> ChunkData;
+};
+
+auto GetModelCacheFilePath(const std::filesystem::path& filePath) -> std::filesystem::path {
+    return g_modelCacheDirectory / std::format("{:016x}.model", Hash64(filePath.generic_string()));
+}
+
+auto GetLastWriteTime(const std::filesystem::path& filePath) -> int64_t {
+    std::error_code errorCode;
+    auto lastWriteTime = std::filesystem::last_write_time(filePath, errorCode);
+    return errorCode ? 0 : static_cast<int64_t>(lastWriteTime.time_since_epoch().count());
+}
+
+auto PackImportSettings(const SModelImportSettings& importSettings) -> uint32_t {
+    return (importSettings.OptimizeMeshes ? 1u : 0u) |
+           (importSettings.GenerateMeshlets ? 2u : 0u) |
+           (importSettings.GenerateLods ? 4u : 0u) |
+           (importSettings.WeldVertices ? 8u : 0u);
+}
+
+auto UnpackImportSettings(uint32_t packedImportSettings) -> SModelImportSettings {
+    return SModelImportSettings{
+        .OptimizeMeshes = (packedImportSettings & 1u) != 0,
+        .GenerateMeshlets = (packedImportSettings & 2u) != 0,
+        .GenerateLods = (packedImportSettings & 4u) != 0,
+        .WeldVertices = (packedImportSettings & 8u) != 0
+    };
+}
+
+auto ToCacheIndex(const std::optional<size_t>& index) -> int64_t {
+    return index.has_value() ? static_cast<int64_t>(index.value()) : g_modelCacheNoIndex;
+}
+
+auto FromCacheIndex(int64_t index) -> std::optional<size_t> {
+    return index == g_modelCacheNoIndex ? std::nullopt : std::optional<size_t>(static_cast<size_t>(index));
+}
+
+auto AddString(
+    SModelCacheWriter& writer,
+    std::string_view text) -> SModelCacheString {
+
+    auto cacheString = SModelCacheString{
+        .Offset = static_cast<uint32_t>(writer.Strings.size()),
+        .Size = static_cast<uint32_t>(text.size())
+    };
+    writer.Strings.append(text);
+    return cacheString;
+}
+
+template<typename T>
+auto AddChunk(
+    SModelCacheWriter& writer,
+    EModelCacheChunk type,
+    std::span<const T> data) -> void {
+
+    writer.Chunks.push_back(SModelCacheChunk{
+        .Type = type,
+        .Size = data.size_bytes()
+    });
+    writer.ChunkData.push_back(std::as_bytes(data));
+}
+
+auto GetString(
+    std::string_view strings,
+    SModelCacheString cacheString) -> std::optional<std::string> {
+
+    if (static_cast<uint64_t>(cacheString.Offset) + cacheString.Size > strings.size()) {
+        return std::nullopt;
+    }
+    return std::string(strings.substr(cacheString.Offset, cacheString.Size));
+}
+
+template<typename T>
+auto GetChunk(
+    const SMappedFile& mappedFile,
+    std::span<const SModelCacheChunk> chunks,
+    EModelCacheChunk type) -> std::optional<std::span<const T>> {
+
+    for (const auto& chunk : chunks) {
+        if (chunk.Type != type) {
+            continue;
+        }
+        if (chunk.Offset > mappedFile.Size ||
+            chunk.Size > mappedFile.Size - chunk.Offset ||
+            chunk.Offset % alignof(T) != 0 ||
+            chunk.Size % sizeof(T) != 0) {
+            return std::nullopt;
+        }
+        return std::span<const T>(reinterpret_cast<const T*>(mappedFile.Data + chunk.Offset), chunk.Size / sizeof(T));
+    }
+    return std::nullopt;
+}
+
+auto IsDependencyUpToDate(const SModelDataDependency& dependency) -> bool {
+
+    std::error_code errorCode;
+    auto fileSize = std::filesystem::file_size(dependency.FilePath, errorCode);
+    if (errorCode || fileSize != dependency.FileSize) {
+        return false;
+    }
+
+    if (GetLastWriteTime(dependency.FilePath) == dependency.LastWriteTime) {
+        return true;
+    }
+
+    // touched but possibly unchanged (checkouts, copies), let the content decide
+    auto mappedFile = MapFile(dependency.FilePath, EFileAccessPattern::Sequential);
+    if (!mappedFile.has_value()) {
+        return false;
+    }
+    auto contentHash = Hash64(mappedFile->Data, mappedFile->Size);
+    UnmapFile(*mappedFile);
+
+    return contentHash == dependency.ContentHash;
+}
+
+auto CreateModelDataDependency(
+    const std::filesystem::path& filePath,
+    std::span<const std::byte> fileData) -> SModelDataDependency {
+
+    return SModelDataDependency{
+        .FilePath = filePath,
+        .FileSize = fileData.size(),
+        .LastWriteTime = GetLastWriteTime(filePath),
+        .ContentHash = Hash64(fileData)
+    };
+}
+
+auto ReadModelData(
+    const std::filesystem::path& filePath,
+    const SModelImportSettings& importSettings,
+    SMappedFile& mappedFile) -> std::optional<SModelData> {
+
+    if (mappedFile.Size < sizeof(SModelCacheHeader)) {
+        return std::nullopt;
+    }
+
+    SModelCacheHeader header = {};
+    std::memcpy(&header, mappedFile.Data, sizeof(SModelCacheHeader));
+    if (header.Magic != g_modelCacheMagic || header.Version != g_modelCacheVersion) {
+        return std::nullopt;
+    }
+    if (header.ImportSettings != PackImportSettings(importSettings)) {
+        spdlog::info("Model cache for {} was built with different import settings", filePath.string());
+        return std::nullopt;
+    }
+    if (header.VertexFormat != GetVertexFormatId()) {
+        spdlog::info("Model cache for {} was built with a different vertex format", filePath.string());
+        return std::nullopt;
+    }
+    if (sizeof(SModelCacheHeader) + header.ChunkCount * sizeof(SModelCacheChunk) > mappedFile.Size) {
+        return std::nullopt;
+    }
+
+    auto chunks = std::span<const SModelCacheChunk>(
+        reinterpret_cast<const SModelCacheChunk*>(mappedFile.Data + sizeof(SModelCacheHeader)),
+        header.ChunkCount);
+
+    auto stringsChunk = GetChunk<char>(mappedFile, chunks, EModelCacheChunk::Strings);
+    auto dependenciesChunk = GetChunk<SModelCacheDependency>(mappedFile, chunks, EModelCacheChunk::Dependencies);
+    auto meshesChunk = GetChunk<SModelCacheMesh>(mappedFile, chunks, EModelCacheChunk::Meshes);
+    auto primitivesChunk = GetChunk<SModelDataPrimitive>(mappedFile, chunks, EModelCacheChunk::Primitives);
+    auto meshletsChunk = GetChunk<SMeshlet>(mappedFile, chunks, EModelCacheChunk::Meshlets);
+    auto lodsChunk = GetChunk<SPrimitiveLod>(mappedFile, chunks, EModelCacheChunk::Lods);
+    auto materialsChunk = GetChunk<SModelCacheMaterial>(mappedFile, chunks, EModelCacheChunk::Materials);
+    auto samplersChunk = GetChunk<SSamplerData>(mappedFile, chunks, EModelCacheChunk::Samplers);
+    auto texturesChunk = GetChunk<SModelDataTexture>(mappedFile, chunks, EModelCacheChunk::Textures);
+    auto imagesChunk = GetChunk<SModelCacheImage>(mappedFile, chunks, EModelCacheChunk::Images);
+    auto imageDataChunk = GetChunk<std::byte>(mappedFile, chunks, EModelCacheChunk::ImageData);
+    auto vertexPositionsChunk = GetChunk<SVertexPosition>(mappedFile, chunks, EModelCacheChunk::VertexPositions);
+    auto vertexNormalUvsChunk = GetChunk<SVertexNormalUv>(mappedFile, chunks, EModelCacheChunk::VertexNormalUvs);
+    auto indicesChunk = GetChunk<uint32_t>(mappedFile, chunks, EModelCacheChunk::Indices);
+    auto indices16Chunk = GetChunk<uint16_t>(mappedFile, chunks, EModelCacheChunk::Indices16);
+
+    if (!stringsChunk || !dependenciesChunk || !meshesChunk || !primitivesChunk || !meshletsChunk || !lodsChunk || !materialsChunk || !samplersChunk ||
+        !texturesChunk || !imagesChunk || !imageDataChunk || !vertexPositionsChunk || !vertexNormalUvsChunk || !indicesChunk ||
+        !indices16Chunk) {
+        return std::nullopt;
+    }
+
+    auto strings = std::string_view(stringsChunk->data(), stringsChunk->size());
+    auto sourcePath = GetString(strings, header.SourcePath);
+    if (!sourcePath.has_value() || *sourcePath != filePath.generic_string()) {
+        return std::nullopt;
+    }
+
+    SModelData modelData = {};
+    modelData.Name = filePath.string();
+    modelData.ImportSettings = UnpackImportSettings(header.ImportSettings);
+
+    for (const auto& cacheDependency : *dependenciesChunk) {
+        auto dependencyFilePath = GetString(strings, cacheDependency.FilePath);
+        if (!dependencyFilePath.has_value()) {
+            return std::nullopt;
+        }
+
+        auto dependency = SModelDataDependency{
+            .FilePath = std::move(*dependencyFilePath),
+            .FileSize = cacheDependency.FileSize,
+            .LastWriteTime = cacheDependency.LastWriteTime,
+            .ContentHash = cacheDependency.ContentHash
+        };
+        if (!IsDependencyUpToDate(dependency)) {
+            spdlog::info("Model cache for {} is stale, {} has changed", filePath.string(), dependency.FilePath.string());
+            return std::nullopt;
+        }
+        modelData.Dependencies.push_back(std::move(dependency));
+    }
+
+    for (const auto& cacheMesh : *meshesChunk) {
+        auto meshName = GetString(strings, cacheMesh.Name);
+        if (!meshName.has_value() ||
+            static_cast<uint64_t>(cacheMesh.PrimitiveOffset) + cacheMesh.PrimitiveCount > primitivesChunk->size()) {
+            return std::nullopt;
+        }
+        modelData.Meshes.push_back(SModelDataMesh{
+            .Name = std::move(*meshName),
+            .WorldMatrix = cacheMesh.WorldMatrix,
+            .PrimitiveOffset = cacheMesh.PrimitiveOffset,
+            .PrimitiveCount = cacheMesh.PrimitiveCount
+        });
+    }
+
+    for (const auto& primitive : *primitivesChunk) {
+        if (primitive.IndexType != EIndexType::UnsignedInt && primitive.IndexType != EIndexType::UnsignedShort) {
+            return std::nullopt;
+        }
+
+        const auto indexCount = primitive.IndexType == EIndexType::UnsignedShort
+            ? indices16Chunk->size()
+            : indicesChunk->size();
+        if (static_cast<uint64_t>(primitive.VertexOffset) + primitive.VertexCount > vertexPositionsChunk->size() ||
+            static_cast<uint64_t>(primitive.IndexOffset) + primitive.IndexCount > indexCount ||
+            static_cast<uint64_t>(primitive.MeshletOffset) + primitive.MeshletCount > meshletsChunk->size() ||
+            static_cast<uint64_t>(primitive.LodOffset) + primitive.LodCount > lodsChunk->size()) {
+            return std::nullopt;
+        }
+
+        for (const auto& lod : lodsChunk->subspan(primitive.LodOffset, primitive.LodCount)) {
+            if (static_cast<uint64_t>(lod.IndexOffset) + lod.IndexCount > indexCount) {
+                return std::nullopt;
+            }
+        }
+    }
+    modelData.Primitives.assign(primitivesChunk->begin(), primitivesChunk->end());
+    modelData.Meshlets.assign(meshletsChunk->begin(), meshletsChunk->end());
+    modelData.Lods.assign(lodsChunk->begin(), lodsChunk->end());
+
+    for (const auto& cacheMaterial : *materialsChunk) {
+        auto materialName = GetString(strings, cacheMaterial.Name);
+        if (!materialName.has_value()) {
+            return std::nullopt;
+        }
+
+        SCpuMaterial cpuMaterial = {};
+        cpuMaterial.Name = std::move(*materialName);
+        cpuMaterial.BaseColor = cacheMaterial.BaseColor;
+        cpuMaterial.BaseTextureIndex = FromCacheIndex(cacheMaterial.BaseTextureIndex);
+        cpuMaterial.NormalTextureIndex = FromCacheIndex(cacheMaterial.NormalTextureIndex);
+        cpuMaterial.OcclusionTextureIndex = FromCacheIndex(cacheMaterial.OcclusionTextureIndex);
+        cpuMaterial.MetallicRoughnessTextureIndex = FromCacheIndex(cacheMaterial.MetallicRoughnessTextureIndex);
+        cpuMaterial.EmissiveTextureIndex = FromCacheIndex(cacheMaterial.EmissiveTextureIndex);
+        modelData.Materials.push_back(std::move(cpuMaterial));
+    }
+
+    modelData.Samplers.assign(samplersChunk->begin(), samplersChunk->end());
+    modelData.Textures.assign(texturesChunk->begin(), texturesChunk->end());
+
+    for (const auto& cacheImage : *imagesChunk) {
+        auto imageName = GetString(strings, cacheImage.Name);
+        auto imageFilePath = GetString(strings, cacheImage.FilePath);
+        if (!imageName.has_value() || !imageFilePath.has_value() ||
+            cacheImage.EncodedDataOffset > imageDataChunk->size() ||
+            cacheImage.EncodedDataSize > imageDataChunk->size() - cacheImage.EncodedDataOffset) {
+            return std::nullopt;
+        }
+
+        auto encodedData = imageDataChunk->subspan(cacheImage.EncodedDataOffset, cacheImage.EncodedDataSize);
+        modelData.Images.push_back(SModelDataImage{
+            .Name = std::move(*imageName),
+            .FilePath = std::move(*imageFilePath),
+            .EncodedData = std::vector<std::byte>(encodedData.begin(), encodedData.end())
+        });
+    }
+
+    modelData.VertexPositions = *vertexPositionsChunk;
+    modelData.VertexNormalUvs = *vertexNormalUvsChunk;
+    modelData.Indices = *indicesChunk;
+    modelData.Indices16 = *indices16Chunk;
+
+    return modelData;
+}
+
+auto LoadModelDataFromCache(
+    const std::filesystem::path& filePath,
+    const SModelImportSettings& importSettings) -> std::optional<SModelData> {
+
+    // all of it is validated and uploaded right away
+    auto mappedFile = MapFile(GetModelCacheFilePath(filePath), EFileAccessPattern::WillNeed);
+    if (!mappedFile.has_value()) {
+        return std::nullopt;
+    }
+
+    auto modelData = ReadModelData(filePath, importSettings, *mappedFile);
+    if (!modelData.has_value()) {
+        UnmapFile(*mappedFile);
+        return std::nullopt;
+    }
+
+    modelData->MappedFile = *mappedFile;
+    return modelData;
+}
+
+auto SaveModelDataToCache(
+    const std::filesystem::path& filePath,
+    const SModelData& modelData) -> bool {
+
+    SModelCacheWriter writer = {};
+
+    auto header = SModelCacheHeader{
+        .Magic = g_modelCacheMagic,
+        .Version = g_modelCacheVersion,
+        .ImportSettings = PackImportSettings(modelData.ImportSettings),
+        .VertexFormat = GetVertexFormatId(),
+        .SourcePath = AddString(writer, filePath.generic_string())
+    };
+
+    std::vector<SModelCacheDependency> dependencies;
+    dependencies.reserve(modelData.Dependencies.size());
+    for (const auto& dependency : modelData.Dependencies) {
+        dependencies.push_back(SModelCacheDependency{
+            .FilePath = AddString(writer, dependency.FilePath.generic_string()),
+            .FileSize = dependency.FileSize,
+            .LastWriteTime = dependency.LastWriteTime,
+            .ContentHash = dependency.ContentHash
+        });
+    }
+
+    std::vector<SModelCacheMesh> meshes;
+    meshes.reserve(modelData.Meshes.size());
+    for (const auto& mesh : modelData.Meshes) {
+        meshes.push_back(SModelCacheMesh{
+            .WorldMatrix = mesh.WorldMatrix,
+            .Name = AddString(writer, mesh.Name),
+            .PrimitiveOffset = mesh.PrimitiveOffset,
+            .PrimitiveCount = mesh.PrimitiveCount
+        });
+    }
+
+    std::vector<SModelCacheMaterial> materials;
+    materials.reserve(modelData.Materials.size());
+    for (const auto& material : modelData.Materials) {
+        materials.push_back(SModelCacheMaterial{
+            .BaseColor = material.BaseColor,
+            .Name = AddString(writer, material.Name),
+            .BaseTextureIndex = ToCacheIndex(material.BaseTextureIndex),
+            .NormalTextureIndex = ToCacheIndex(material.NormalTextureIndex),
+            .OcclusionTextureIndex = ToCacheIndex(material.OcclusionTextureIndex),
+            .MetallicRoughnessTextureIndex = ToCacheIndex(material.MetallicRoughnessTextureIndex),
+            .EmissiveTextureIndex = ToCacheIndex(material.EmissiveTextureIndex)
+        });
+    }
+
+    std::vector<SModelCacheImage> images;
+    std::vector<std::byte> imageData;
+    images.reserve(modelData.Images.size());
+    for (const auto& image : modelData.Images) {
+        images.push_back(SModelCacheImage{
+            .Name = AddString(writer, image.Name),
+            .FilePath = AddString(writer, image.FilePath.generic_string()),
+            .EncodedDataOffset = imageData.size(),
+            .EncodedDataSize = image.EncodedData.size()
+        });
+        imageData.insert(imageData.end(), image.EncodedData.begin(), image.EncodedData.end());
+    }
+
+    AddChunk(writer, EModelCacheChunk::Strings, std::span<const char>(writer.Strings));
+    AddChunk(writer, EModelCacheChunk::Dependencies, std::span<const SModelCacheDependency>(dependencies));
+    AddChunk(writer, EModelCacheChunk::Meshes, std::span<const SModelCacheMesh>(meshes));
+    AddChunk(writer, EModelCacheChunk::Primitives, std::span<const SModelDataPrimitive>(modelData.Primitives));
+    AddChunk(writer, EModelCacheChunk::Meshlets, std::span<const SMeshlet>(modelData.Meshlets));
+    AddChunk(writer, EModelCacheChunk::Lods, std::span<const SPrimitiveLod>(modelData.Lods));
+    AddChunk(writer, EModelCacheChunk::Materials, std::span<const SModelCacheMaterial>(materials));
+    AddChunk(writer, EModelCacheChunk::Samplers, std::span<const SSamplerData>(modelData.Samplers));
+    AddChunk(writer, EModelCacheChunk::Textures, std::span<const SModelDataTexture>(modelData.Textures));
+    AddChunk(writer, EModelCacheChunk::Images, std::span<const SModelCacheImage>(images));
+    AddChunk(writer, EModelCacheChunk::ImageData, std::span<const std::byte>(imageData));
+    AddChunk(writer, EModelCacheChunk::VertexPositions, modelData.VertexPositions);
+    AddChunk(writer, EModelCacheChunk::VertexNormalUvs, modelData.VertexNormalUvs);
+    AddChunk(writer, EModelCacheChunk::Indices, modelData.Indices);
+    AddChunk(writer, EModelCacheChunk::Indices16, modelData.Indices16);
+
+    header.ChunkCount = static_cast<uint32_t>(writer.Chunks.size());
+
+    auto alignOffset = [](uint64_t offset) {
+        return (offset + g_modelCacheChunkAlignment - 1) & ~(g_modelCacheChunkAlignment - 1);
+    };
+
+    auto offset = alignOffset(sizeof(SModelCacheHeader) + writer.Chunks.size() * sizeof(SModelCacheChunk));
+    for (auto& chunk : writer.Chunks) {
+        chunk.Offset = offset;
+        offset = alignOffset(offset + chunk.Size);
+    }
+
+    // each writer gets its own temporary file, workers and instances caching the same model don't write into one
+    auto cacheFilePath = GetModelCacheFilePath(filePath);
+    auto temporaryCacheFilePath = std::filesystem::path(cacheFilePath).replace_extension(
+        std::format(".{:08x}{:08x}.tmp", std::random_device{}(), std::random_device{}()));
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(g_modelCacheDirectory, errorCode);
+    if (errorCode) {
+        return false;
+    }
+
+    auto isWritten = false;
+    {
+        std::ofstream file{temporaryCacheFilePath, std::ofstream::binary | std::ofstream::trunc};
+        if (!file) {
+            std::filesystem::remove(temporaryCacheFilePath, errorCode);
+            return false;
+        }
+
+        constexpr std::array<char, g_modelCacheChunkAlignment> padding = {};
+        auto writePadding = [&]() {
+            auto position = static_cast<uint64_t>(file.tellp());
+            file.write(padding.data(), static_cast<std::streamsize>(alignOffset(position) - position));
+        };
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(SModelCacheHeader));
+        file.write(reinterpret_cast<const char*>(writer.Chunks.data()), static_cast<std::streamsize>(writer.Chunks.size() * sizeof(SModelCacheChunk)));
+        writePadding();
+        for (const auto& chunkData : writer.ChunkData) {
+            file.write(reinterpret_cast<const char*>(chunkData.data()), static_cast<std::streamsize>(chunkData.size()));
+            writePadding();
+        }
+
+        file.close();
+        isWritten = !file.fail();
+    }
+    if (!isWritten) {
+        std::filesystem::remove(temporaryCacheFilePath, errorCode);
+        return false;
+    }
+
+    // readers never see a half written cache file, the last of several writers wins
+    std::filesystem::rename(temporaryCacheFilePath, cacheFilePath, errorCode);
+    if (errorCode) {
+        std::filesystem::remove(temporaryCacheFilePath, errorCode);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+#include "Model.hpp"
+
+auto CreateModelDataDependency(
+    const std::filesystem::path& filePath,
+    std::span<const std::byte> fileData) -> SModelDataDependency;
+
+auto LoadModelDataFromCache(
+    const std::filesystem::path& filePath,
+    const SModelImportSettings& importSettings) -> std::optional<SModelData>;
+auto SaveModelDataToCache(
+    const std::filesystem::path& filePath,
+    const SModelData& modelData) -> bool;
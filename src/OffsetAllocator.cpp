@@ -0,0 +1,464 @@
+#include "OffsetAllocator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+
+constexpr uint32_t g_mantissaBitCount = 3;
+constexpr uint32_t g_mantissaValue = 1 << g_mantissaBitCount;
+constexpr uint32_t g_mantissaMask = g_mantissaValue - 1;
+
+// the bin of a size is its exponent and the 3 bits below the highest set bit. requests round up, so any range
+// in the bin found for them is big enough, free ranges round down so they are never filed too high
+auto SizeToBinIndexRoundUp(uint32_t size) -> uint32_t {
+
+    uint32_t exponent = 0;
+    uint32_t mantissa = 0;
+    if (size < g_mantissaValue) {
+        mantissa = size;
+    } else {
+        const auto highestSetBit = 31 - static_cast<uint32_t>(std::countl_zero(size));
+        const auto mantissaStartBit = highestSetBit - g_mantissaBitCount;
+        exponent = mantissaStartBit + 1;
+        mantissa = (size >> mantissaStartBit) & g_mantissaMask;
+
+        const auto lowBitsMask = (1u << mantissaStartBit) - 1;
+        if ((size & lowBitsMask) != 0) {
+            mantissa++;
+        }
+    }
+
+    // a mantissa overflowing carries into the exponent
+    return (exponent << g_mantissaBitCount) + mantissa;
+}
+
+auto SizeToBinIndexRoundDown(uint32_t size) -> uint32_t {
+
+    uint32_t exponent = 0;
+    uint32_t mantissa = 0;
+    if (size < g_mantissaValue) {
+        mantissa = size;
+    } else {
+        const auto highestSetBit = 31 - static_cast<uint32_t>(std::countl_zero(size));
+        const auto mantissaStartBit = highestSetBit - g_mantissaBitCount;
+        exponent = mantissaStartBit + 1;
+        mantissa = (size >> mantissaStartBit) & g_mantissaMask;
+    }
+
+    return (exponent << g_mantissaBitCount) | mantissa;
+}
+
+auto FindLowestSetBitAfter(
+    uint32_t bitMask,
+    uint32_t startBitIndex) -> uint32_t {
+
+    if (startBitIndex >= 32) {
+        return g_offsetAllocatorUnused;
+    }
+
+    const auto bitMaskAfter = bitMask & ~((1u << startBitIndex) - 1);
+    if (bitMaskAfter == 0) {
+        return g_offsetAllocatorUnused;
+    }
+
+    return static_cast<uint32_t>(std::countr_zero(bitMaskAfter));
+}
+
+auto InsertNodeIntoBin(
+    SOffsetAllocator& allocator,
+    uint32_t size,
+    uint32_t offset) -> uint32_t {
+
+    const auto binIndex = SizeToBinIndexRoundDown(size);
+    const auto topBinIndex = binIndex >> g_mantissaBitCount;
+    const auto leafBinIndex = binIndex & g_mantissaMask;
+
+    if (allocator.BinIndices[binIndex] == g_offsetAllocatorUnused) {
+        allocator.UsedBins[topBinIndex] |= 1 << leafBinIndex;
+        allocator.UsedBinsTop |= 1u << topBinIndex;
+    }
+
+    const auto topNodeIndex = allocator.BinIndices[binIndex];
+    const auto nodeIndex = allocator.FreeNodes[--allocator.FreeNodeCount];
+    allocator.Nodes[nodeIndex] = SOffsetAllocatorNode{
+        .Offset = offset,
+        .Size = size,
+        .BinListNext = topNodeIndex
+    };
+    if (topNodeIndex != g_offsetAllocatorUnused) {
+        allocator.Nodes[topNodeIndex].BinListPrevious = nodeIndex;
+    }
+    allocator.BinIndices[binIndex] = nodeIndex;
+
+    allocator.FreeStorage += size;
+    return nodeIndex;
+}
+
+auto RemoveNodeFromBin(
+    SOffsetAllocator& allocator,
+    uint32_t nodeIndex) -> void {
+
+    const auto& node = allocator.Nodes[nodeIndex];
+    if (node.BinListPrevious != g_offsetAllocatorUnused) {
+
+        allocator.Nodes[node.BinListPrevious].BinListNext = node.BinListNext;
+        if (node.BinListNext != g_offsetAllocatorUnused) {
+            allocator.Nodes[node.BinListNext].BinListPrevious = node.BinListPrevious;
+        }
+    } else {
+
+        // head of its bin
+        const auto binIndex = SizeToBinIndexRoundDown(node.Size);
+        const auto topBinIndex = binIndex >> g_mantissaBitCount;
+        const auto leafBinIndex = binIndex & g_mantissaMask;
+
+        allocator.BinIndices[binIndex] = node.BinListNext;
+        if (node.BinListNext != g_offsetAllocatorUnused) {
+            allocator.Nodes[node.BinListNext].BinListPrevious = g_offsetAllocatorUnused;
+        }
+
+        if (allocator.BinIndices[binIndex] == g_offsetAllocatorUnused) {
+            allocator.UsedBins[topBinIndex] &= ~(1 << leafBinIndex);
+            if (allocator.UsedBins[topBinIndex] == 0) {
+                allocator.UsedBinsTop &= ~(1u << topBinIndex);
+            }
+        }
+    }
+
+    allocator.FreeNodes[allocator.FreeNodeCount++] = nodeIndex;
+    allocator.FreeStorage -= node.Size;
+}
+
+auto CreateOffsetAllocator(
+    uint32_t size,
+    uint32_t maxAllocations) -> SOffsetAllocator {
+
+    SOffsetAllocator allocator = {};
+    allocator.Size = size;
+    allocator.BinIndices.fill(g_offsetAllocatorUnused);
+    allocator.Nodes.resize(maxAllocations + 1);
+    allocator.FreeNodes.resize(maxAllocations + 1);
+    allocator.FreeNodeCount = maxAllocations + 1;
+    for (uint32_t nodeIndex = 0; nodeIndex < allocator.FreeNodes.size(); nodeIndex++) {
+        allocator.FreeNodes[nodeIndex] = maxAllocations - nodeIndex;
+    }
+
+    if (size > 0) {
+        allocator.LastNodeIndex = InsertNodeIntoBin(allocator, size, 0);
+    }
+
+    return allocator;
+}
+
+auto Allocate(
+    SOffsetAllocator& allocator,
+    uint32_t size) -> std::optional<SOffsetAllocation> {
+
+    // splitting off the rest of a range needs a node
+    if (size == 0 || allocator.FreeNodeCount == 0) {
+        return std::nullopt;
+    }
+
+    const auto minimumBinIndex = SizeToBinIndexRoundUp(size);
+    const auto minimumTopBinIndex = minimumBinIndex >> g_mantissaBitCount;
+    const auto minimumLeafBinIndex = minimumBinIndex & g_mantissaMask;
+
+    auto topBinIndex = minimumTopBinIndex;
+    auto leafBinIndex = g_offsetAllocatorUnused;
+
+    if (topBinIndex < g_offsetAllocatorTopBinCount && (allocator.UsedBinsTop & (1u << topBinIndex)) != 0) {
+        leafBinIndex = FindLowestSetBitAfter(allocator.UsedBins[topBinIndex], minimumLeafBinIndex);
+    }
+
+    // nothing big enough in the same top bin, the first leaf of the next used top bin fits any request
+    if (leafBinIndex == g_offsetAllocatorUnused) {
+        topBinIndex = FindLowestSetBitAfter(allocator.UsedBinsTop, minimumTopBinIndex + 1);
+        if (topBinIndex == g_offsetAllocatorUnused) {
+            return std::nullopt;
+        }
+        leafBinIndex = static_cast<uint32_t>(std::countr_zero(allocator.UsedBins[topBinIndex]));
+    }
+
+    const auto binIndex = (topBinIndex << g_mantissaBitCount) | leafBinIndex;
+    const auto nodeIndex = allocator.BinIndices[binIndex];
+    const auto nodeSize = allocator.Nodes[nodeIndex].Size;
+
+    RemoveNodeFromBin(allocator, nodeIndex);
+    // the node keeps its place in the neighbor list, only the free node RemoveNodeFromBin handed back is taken again
+    allocator.FreeNodeCount--;
+
+    auto& node = allocator.Nodes[nodeIndex];
+    node.Size = size;
+    node.IsUsed = true;
+    node.BinListPrevious = g_offsetAllocatorUnused;
+    node.BinListNext = g_offsetAllocatorUnused;
+
+    const auto remainderSize = nodeSize - size;
+    if (remainderSize > 0) {
+
+        const auto remainderNodeIndex = InsertNodeIntoBin(allocator, remainderSize, node.Offset + size);
+        auto& remainderNode = allocator.Nodes[remainderNodeIndex];
+        if (node.NeighborNext != g_offsetAllocatorUnused) {
+            allocator.Nodes[node.NeighborNext].NeighborPrevious = remainderNodeIndex;
+        } else {
+            allocator.LastNodeIndex = remainderNodeIndex;
+        }
+        remainderNode.NeighborPrevious = nodeIndex;
+        remainderNode.NeighborNext = node.NeighborNext;
+        node.NeighborNext = remainderNodeIndex;
+    }
+
+    return SOffsetAllocation{
+        .Offset = node.Offset,
+        .NodeIndex = nodeIndex
+    };
+}
+
+auto Free(
+    SOffsetAllocator& allocator,
+    const SOffsetAllocation& allocation) -> void {
+
+    if (allocation.NodeIndex == g_offsetAllocatorUnused) {
+        return;
+    }
+
+    const auto node = allocator.Nodes[allocation.NodeIndex];
+    auto offset = node.Offset;
+    auto size = node.Size;
+    auto neighborPrevious = node.NeighborPrevious;
+    auto neighborNext = node.NeighborNext;
+
+    if (neighborPrevious != g_offsetAllocatorUnused && !allocator.Nodes[neighborPrevious].IsUsed) {
+
+        const auto& previousNode = allocator.Nodes[neighborPrevious];
+        offset = previousNode.Offset;
+        size += previousNode.Size;
+        const auto previousNodeIndex = neighborPrevious;
+        neighborPrevious = previousNode.NeighborPrevious;
+        RemoveNodeFromBin(allocator, previousNodeIndex);
+    }
+
+    if (neighborNext != g_offsetAllocatorUnused && !allocator.Nodes[neighborNext].IsUsed) {
+
+        const auto& nextNode = allocator.Nodes[neighborNext];
+        size += nextNode.Size;
+        const auto nextNodeIndex = neighborNext;
+        neighborNext = nextNode.NeighborNext;
+        RemoveNodeFromBin(allocator, nextNodeIndex);
+    }
+
+    allocator.Nodes[allocation.NodeIndex].IsUsed = false;
+    allocator.FreeNodes[allocator.FreeNodeCount++] = allocation.NodeIndex;
+
+    const auto combinedNodeIndex = InsertNodeIntoBin(allocator, size, offset);
+    auto& combinedNode = allocator.Nodes[combinedNodeIndex];
+
+    combinedNode.NeighborPrevious = neighborPrevious;
+    if (neighborPrevious != g_offsetAllocatorUnused) {
+        allocator.Nodes[neighborPrevious].NeighborNext = combinedNodeIndex;
+    }
+
+    combinedNode.NeighborNext = neighborNext;
+    if (neighborNext != g_offsetAllocatorUnused) {
+        allocator.Nodes[neighborNext].NeighborPrevious = combinedNodeIndex;
+    } else {
+        allocator.LastNodeIndex = combinedNodeIndex;
+    }
+}
+
+auto Grow(
+    SOffsetAllocator& allocator,
+    uint32_t newSize) -> bool {
+
+    if (newSize <= allocator.Size) {
+        return true;
+    }
+
+    auto offset = allocator.Size;
+    auto neighborPrevious = allocator.LastNodeIndex;
+
+    if (neighborPrevious != g_offsetAllocatorUnused && !allocator.Nodes[neighborPrevious].IsUsed) {
+
+        const auto lastNodeIndex = neighborPrevious;
+        offset = allocator.Nodes[lastNodeIndex].Offset;
+        neighborPrevious = allocator.Nodes[lastNodeIndex].NeighborPrevious;
+        RemoveNodeFromBin(allocator, lastNodeIndex);
+
+    } else if (allocator.FreeNodeCount == 0) {
+        return false;
+    }
+
+    const auto nodeIndex = InsertNodeIntoBin(allocator, newSize - offset, offset);
+    allocator.Nodes[nodeIndex].NeighborPrevious = neighborPrevious;
+    if (neighborPrevious != g_offsetAllocatorUnused) {
+        allocator.Nodes[neighborPrevious].NeighborNext = nodeIndex;
+    }
+
+    allocator.LastNodeIndex = nodeIndex;
+    allocator.Size = newSize;
+    return true;
+}
+
+auto GetAllocationSize(
+    const SOffsetAllocator& allocator,
+    const SOffsetAllocation& allocation) -> uint32_t {
+
+    if (allocation.NodeIndex == g_offsetAllocatorUnused) {
+        return 0;
+    }
+
+    return allocator.Nodes[allocation.NodeIndex].Size;
+}
+
+auto GetLargestFreeRegion(const SOffsetAllocator& allocator) -> uint32_t {
+
+    if (allocator.UsedBinsTop == 0) {
+        return 0;
+    }
+
+    // ranges in a bin only share their rounded size, the biggest one is looked up in the highest used bin
+    const auto topBinIndex = 31 - static_cast<uint32_t>(std::countl_zero(allocator.UsedBinsTop));
+    const auto leafBinIndex = 31 - static_cast<uint32_t>(std::countl_zero(static_cast<uint32_t>(allocator.UsedBins[topBinIndex])));
+
+    uint32_t largestSize = 0;
+    for (auto nodeIndex = allocator.BinIndices[(topBinIndex << g_mantissaBitCount) | leafBinIndex];
+         nodeIndex != g_offsetAllocatorUnused;
+         nodeIndex = allocator.Nodes[nodeIndex].BinListNext) {
+        largestSize = std::max(largestSize, allocator.Nodes[nodeIndex].Size);
+    }
+
+    return largestSize;
+}
+
+auto GetFragmentation(const SOffsetAllocator& allocator) -> float {
+
+    if (allocator.FreeStorage == 0) {
+        return 0.0f;
+    }
+
+    return 1.0f - static_cast<float>(GetLargestFreeRegion(allocator)) / static_cast<float>(allocator.FreeStorage);
+}
+
+auto GetAllocationsFromEnd(
+    const SOffsetAllocator& allocator,
+    std::size_t maxAllocationCount) -> std::vector<SOffsetAllocation> {
+
+    std::vector<SOffsetAllocation> allocations;
+    for (auto nodeIndex = allocator.LastNodeIndex;
+         nodeIndex != g_offsetAllocatorUnused && allocations.size() < maxAllocationCount;
+         nodeIndex = allocator.Nodes[nodeIndex].NeighborPrevious) {
+
+        const auto& node = allocator.Nodes[nodeIndex];
+        if (node.IsUsed) {
+            allocations.push_back(SOffsetAllocation{
+                .Offset = node.Offset,
+                .NodeIndex = nodeIndex
+            });
+        }
+    }
+
+    return allocations;
+}
+
+auto FindAllocationMove(
+    SOffsetAllocator& allocator,
+    std::size_t candidateCount,
+    const std::function<bool(const SOffsetAllocation&)>& isMovable) -> std::optional<SOffsetAllocationMove> {
+
+    if (GetFragmentation(allocator) == 0.0f) {
+        return std::nullopt;
+    }
+
+    for (const auto& allocation : GetAllocationsFromEnd(allocator, candidateCount)) {
+
+        if (!isMovable(allocation)) {
+            continue;
+        }
+
+        // the allocator picks a range by size only, whatever it returns is kept when it lies below the source
+        const auto size = GetAllocationSize(allocator, allocation);
+        auto destination = Allocate(allocator, size);
+        if (!destination.has_value()) {
+            continue;
+        }
+        if (destination->Offset > allocation.Offset) {
+            Free(allocator, *destination);
+            continue;
+        }
+
+        return SOffsetAllocationMove{
+            .Source = allocation,
+            .Destination = *destination,
+            .Size = size
+        };
+    }
+
+    return std::nullopt;
+}
+
+auto ValidateOffsetAllocator(
+    const SOffsetAllocator& allocator,
+    std::span<const SOffsetAllocation> allocations) -> std::expected<void, std::string> {
+
+    std::vector<SOffsetAllocation> sortedAllocations;
+    for (const auto& allocation : allocations) {
+        if (allocation.NodeIndex == g_offsetAllocatorUnused) {
+            continue;
+        }
+        if (allocation.NodeIndex >= allocator.Nodes.size()) {
+            return std::unexpected(std::format("allocation at {} has no node", allocation.Offset));
+        }
+        const auto& node = allocator.Nodes[allocation.NodeIndex];
+        if (!node.IsUsed || node.Offset != allocation.Offset) {
+            return std::unexpected(std::format("allocation at {} points at the {} range at {}", allocation.Offset, node.IsUsed ? "used" : "free", node.Offset));
+        }
+        sortedAllocations.push_back(allocation);
+    }
+    std::ranges::sort(sortedAllocations, {}, &SOffsetAllocation::Offset);
+
+    std::size_t allocatedSize = 0;
+    for (auto allocationIndex = 0u; allocationIndex < sortedAllocations.size(); allocationIndex++) {
+        const auto offset = sortedAllocations[allocationIndex].Offset;
+        const auto end = static_cast<std::size_t>(offset) + allocator.Nodes[sortedAllocations[allocationIndex].NodeIndex].Size;
+        if (end > allocator.Size) {
+            return std::unexpected(std::format("[{}, {}) ends past the end of the space at {}", offset, end, allocator.Size));
+        }
+        if (allocationIndex + 1 < sortedAllocations.size() && end > sortedAllocations[allocationIndex + 1].Offset) {
+            return std::unexpected(std::format("[{}, {}) overlaps the allocation at {}", offset, end, sortedAllocations[allocationIndex + 1].Offset));
+        }
+        allocatedSize += end - offset;
+    }
+    if (allocator.FreeStorage != allocator.Size - allocatedSize) {
+        return std::unexpected(std::format("{} free, {} of {} allocated", allocator.FreeStorage, allocatedSize, allocator.Size));
+    }
+
+    // back to front over the neighbors, every used range has to be held by an owner
+    std::size_t usedNodeCount = 0;
+    std::size_t freeSize = 0;
+    auto end = allocator.Size;
+    auto isNextFree = false;
+    for (auto nodeIndex = allocator.LastNodeIndex; nodeIndex != g_offsetAllocatorUnused; nodeIndex = allocator.Nodes[nodeIndex].NeighborPrevious) {
+        const auto& node = allocator.Nodes[nodeIndex];
+        if (node.Offset + node.Size != end) {
+            return std::unexpected(std::format("range at {} of size {} doesn't reach the next one at {}", node.Offset, node.Size, end));
+        }
+        if (!node.IsUsed && isNextFree) {
+            return std::unexpected(std::format("free range at {} wasn't merged with the one after it", node.Offset));
+        }
+        usedNodeCount += node.IsUsed ? 1 : 0;
+        freeSize += node.IsUsed ? 0 : node.Size;
+        end = node.Offset;
+        isNextFree = !node.IsUsed;
+    }
+    if (end != 0) {
+        return std::unexpected(std::format("the first range starts at {}", end));
+    }
+    if (usedNodeCount != sortedAllocations.size()) {
+        return std::unexpected(std::format("{} used ranges, {} allocations are held", usedNodeCount, sortedAllocations.size()));
+    }
+    if (freeSize != allocator.FreeStorage) {
+        return std::unexpected(std::format("free ranges add up to {}, the free storage is {}", freeSize, allocator.FreeStorage));
+    }
+
+    return {};
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// Hands out ranges of a linear space, the elements of a GPU buffer for instance. Free ranges are kept in 256 bins
+// by size (a tiny float, 5 bits exponent and 3 bits mantissa) with a two level bitmask over the bins, so allocating
+// and freeing are O(1). Freed ranges merge with free neighbors right away.
+// The allocator never touches the memory it manages, it only does the bookkeeping
+
+constexpr uint32_t g_offsetAllocatorTopBinCount = 32;
+constexpr uint32_t g_offsetAllocatorLeafBinCount = 8;
+constexpr uint32_t g_offsetAllocatorBinCount = g_offsetAllocatorTopBinCount * g_offsetAllocatorLeafBinCount;
+constexpr uint32_t g_offsetAllocatorUnused = 0xFFFFFFFF;
+
+struct SOffsetAllocation {
+    uint32_t Offset = g_offsetAllocatorUnused;
+    uint32_t NodeIndex = g_offsetAllocatorUnused;
+};
+
+struct SOffsetAllocatorNode {
+    uint32_t Offset = 0;
+    uint32_t Size = 0;
+    uint32_t BinListPrevious = g_offsetAllocatorUnused;
+    uint32_t BinListNext = g_offsetAllocatorUnused;
+    uint32_t NeighborPrevious = g_offsetAllocatorUnused;
+    uint32_t NeighborNext = g_offsetAllocatorUnused;
+    bool IsUsed = false;
+};
+
+// a live allocation on its way to a range further down, see FindAllocationMove
+struct SOffsetAllocationMove {
+    SOffsetAllocation Source;
+    SOffsetAllocation Destination;
+    uint32_t Size;
+};
+
+struct SOffsetAllocator {
+    uint32_t Size = 0;
+    uint32_t FreeStorage = 0;
+    uint32_t UsedBinsTop = 0;
+    std::array<uint8_t, g_offsetAllocatorTopBinCount> UsedBins = {};
+    std::array<uint32_t, g_offsetAllocatorBinCount> BinIndices = {};
+
+    std::vector<SOffsetAllocatorNode> Nodes;
+    std::vector<uint32_t> FreeNodes;
+    uint32_t FreeNodeCount = 0;
+    // node at the end of the space, Grow extends it
+    uint32_t LastNodeIndex = g_offsetAllocatorUnused;
+};
+
+// maxAllocations bounds the number of live allocations plus free ranges in between them
+auto CreateOffsetAllocator(
+    uint32_t size,
+    uint32_t maxAllocations) -> SOffsetAllocator;
+
+auto Allocate(
+    SOffsetAllocator& allocator,
+    uint32_t size) -> std::optional<SOffsetAllocation>;
+auto Free(
+    SOffsetAllocator& allocator,
+    const SOffsetAllocation& allocation) -> void;
+
+// appends [Size, newSize) to the space, merging it with a free range at the end
+auto Grow(
+    SOffsetAllocator& allocator,
+    uint32_t newSize) -> bool;
+
+auto GetAllocationSize(
+    const SOffsetAllocator& allocator,
+    const SOffsetAllocation& allocation) -> uint32_t;
+
+auto GetLargestFreeRegion(const SOffsetAllocator& allocator) -> uint32_t;
+
+// 0 when all free space is in one range, approaching 1 the more it is scattered over small ones
+auto GetFragmentation(const SOffsetAllocator& allocator) -> float;
+
+// live allocations in order of descending offset, at most maxAllocationCount of them
+auto GetAllocationsFromEnd(
+    const SOffsetAllocator& allocator,
+    std::size_t maxAllocationCount) -> std::vector<SOffsetAllocation>;
+
+// picks one of the last candidateCount allocations which isMovable accepts and allocates a range for it below its
+// current one. the caller copies the contents over and frees the source, or frees the destination to call it off
+auto FindAllocationMove(
+    SOffsetAllocator& allocator,
+    std::size_t candidateCount,
+    const std::function<bool(const SOffsetAllocation&)>& isMovable) -> std::optional<SOffsetAllocationMove>;
+
+// checks the bookkeeping against the allocations the owners hold: they are exactly the used ranges, don't overlap
+// and lie inside the space, ranges are contiguous with no two free ones next to each other, and the free storage
+// is the size minus the allocations
+auto ValidateOffsetAllocator(
+    const SOffsetAllocator& allocator,
+    std::span<const SOffsetAllocation> allocations) -> std::expected<void, std::string>;
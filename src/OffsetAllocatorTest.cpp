@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "OffsetAllocator.hpp"
+
+// Runs seeded random allocations and frees over an offset allocator, interleaved with the moves the geometry pool
+// defragmenter does: FindAllocationMove picks a range near the end and a destination below it, the contents are
+// copied in slices over several steps and the owner switches over once the last one went out. After every step the
+// bookkeeping has to hold up (ValidateOffsetAllocator) and the sub-ranges of every owner, the primitives of a model,
+// have to lie inside the owner's range. Draining the moves with nothing else going on must never lift the end of
+// the used space, and over the run the drains have to bring the fragmentation down.
+// No GL involved, the copies only move the sub-ranges
+
+struct SOwner {
+    SOffsetAllocation Allocation;
+    uint32_t Size;
+    // offset and size of a primitive within the pool
+    std::vector<std::pair<uint32_t, uint32_t>> SubRanges;
+};
+
+struct SMove {
+    uint32_t OwnerIndex;
+    SOffsetAllocationMove AllocationMove;
+    uint32_t CopiedSize;
+};
+
+struct SDefragmentationTest {
+    SOffsetAllocator Allocator;
+    std::vector<std::optional<SOwner>> Owners;
+    std::optional<SMove> Move;
+    std::mt19937 Random;
+    uint32_t StepIndex = 0;
+    uint32_t MoveCount = 0;
+};
+
+constexpr uint32_t g_initialSize = 64 * 1024;
+constexpr uint32_t g_maxSize = 16 * 1024 * 1024;
+constexpr uint32_t g_maxAllocations = 16 * 1024;
+constexpr uint32_t g_roundCount = 16;
+constexpr uint32_t g_stepsPerRound = 4000;
+constexpr std::size_t g_candidateCount = 8;
+constexpr uint32_t g_copySliceSize = 4096;
+
+auto GetOwnerIndex(
+    const SDefragmentationTest& test,
+    const SOffsetAllocation& allocation) -> std::optional<uint32_t> {
+
+    for (auto ownerIndex = 0u; ownerIndex < test.Owners.size(); ownerIndex++) {
+        const auto& owner = test.Owners[ownerIndex];
+        if (owner.has_value() && owner->Allocation.NodeIndex == allocation.NodeIndex) {
+            return ownerIndex;
+        }
+    }
+    return std::nullopt;
+}
+
+// the end of the last allocation, destinations of a move included
+auto GetUsedEnd(const SDefragmentationTest& test) -> uint32_t {
+
+    const auto allocations = GetAllocationsFromEnd(test.Allocator, 1);
+    return allocations.empty()
+        ? 0
+        : allocations.front().Offset + GetAllocationSize(test.Allocator, allocations.front());
+}
+
+auto Validate(const SDefragmentationTest& test) -> bool {
+
+    std::vector<SOffsetAllocation> allocations;
+    for (const auto& owner : test.Owners) {
+        if (owner.has_value()) {
+            allocations.push_back(owner->Allocation);
+        }
+    }
+    if (test.Move.has_value()) {
+        allocations.push_back(test.Move->AllocationMove.Destination);
+    }
+
+    if (auto validation = ValidateOffsetAllocator(test.Allocator, allocations); !validation) {
+        std::printf("step %u: %s\n", test.StepIndex, validation.error().c_str());
+        return false;
+    }
+
+    for (auto ownerIndex = 0u; ownerIndex < test.Owners.size(); ownerIndex++) {
+        const auto& owner = test.Owners[ownerIndex];
+        if (!owner.has_value()) {
+            continue;
+        }
+        if (GetAllocationSize(test.Allocator, owner->Allocation) != owner->Size) {
+            std::printf("step %u: owner %u holds %u elements, it asked for %u\n",
+                test.StepIndex, ownerIndex, GetAllocationSize(test.Allocator, owner->Allocation), owner->Size);
+            return false;
+        }
+        for (const auto& [offset, size] : owner->SubRanges) {
+            if (offset < owner->Allocation.Offset || offset + size > owner->Allocation.Offset + owner->Size) {
+                std::printf("step %u: owner %u has [%u, %u) outside of its range [%u, %u)\n",
+                    test.StepIndex, ownerIndex, offset, offset + size, owner->Allocation.Offset, owner->Allocation.Offset + owner->Size);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+// grows the space like the geometry pool does when nothing fits
+auto AllocateOwner(SDefragmentationTest& test) -> void {
+
+    // mostly small models with the odd big one
+    const auto size = (test.Random() % 8) == 0
+        ? static_cast<uint32_t>(test.Random() % 32768) + 1
+        : static_cast<uint32_t>(test.Random() % 2048) + 1;
+
+    auto allocation = Allocate(test.Allocator, size);
+    while (!allocation.has_value()) {
+        const auto newSize = std::max(test.Allocator.Size * 2, test.Allocator.Size + size * 2);
+        if (newSize > g_maxSize || !Grow(test.Allocator, newSize)) {
+            return;
+        }
+        allocation = Allocate(test.Allocator, size);
+    }
+
+    auto owner = SOwner{
+        .Allocation = *allocation,
+        .Size = size,
+        .SubRanges = {}
+    };
+    for (auto subOffset = 0u; subOffset < size;) {
+        const auto subSize = std::min(static_cast<uint32_t>(test.Random() % 512) + 1, size - subOffset);
+        owner.SubRanges.emplace_back(allocation->Offset + subOffset, subSize);
+        subOffset += subSize;
+    }
+
+    const auto freeOwner = std::ranges::find_if(test.Owners, [](const auto& owner) { return !owner.has_value(); });
+    if (freeOwner != test.Owners.end()) {
+        *freeOwner = std::move(owner);
+    } else {
+        test.Owners.push_back(std::move(owner));
+    }
+}
+
+auto FreeOwner(SDefragmentationTest& test) -> void {
+
+    if (test.Owners.empty()) {
+        return;
+    }
+
+    const auto ownerIndex = static_cast<uint32_t>(test.Random() % test.Owners.size());
+    auto& owner = test.Owners[ownerIndex];
+    if (!owner.has_value()) {
+        return;
+    }
+
+    // a move of the owner is called off, its destination goes back
+    if (test.Move.has_value() && test.Move->OwnerIndex == ownerIndex) {
+        Free(test.Allocator, test.Move->AllocationMove.Destination);
+        test.Move.reset();
+    }
+
+    Free(test.Allocator, owner->Allocation);
+    owner.reset();
+}
+
+// copies one slice of the move in flight, or starts the next one. returns false when there is nothing to move
+auto DefragmentStep(SDefragmentationTest& test) -> bool {
+
+    if (!test.Move.has_value()) {
+        std::optional<uint32_t> ownerIndex;
+        const auto allocationMove = FindAllocationMove(test.Allocator, g_candidateCount, [&](const SOffsetAllocation& allocation) {
+            ownerIndex = GetOwnerIndex(test, allocation);
+            return ownerIndex.has_value();
+        });
+        if (!allocationMove.has_value()) {
+            return false;
+        }
+        test.Move = SMove{
+            .OwnerIndex = *ownerIndex,
+            .AllocationMove = *allocationMove,
+            .CopiedSize = 0
+        };
+    }
+
+    auto& move = *test.Move;
+    move.CopiedSize = std::min(move.CopiedSize + g_copySliceSize, move.AllocationMove.Size);
+    if (move.CopiedSize < move.AllocationMove.Size) {
+        return true;
+    }
+
+    auto& owner = *test.Owners[move.OwnerIndex];
+    for (auto& [offset, size] : owner.SubRanges) {
+        offset = move.AllocationMove.Destination.Offset + (offset - move.AllocationMove.Source.Offset);
+    }
+    owner.Allocation = move.AllocationMove.Destination;
+    Free(test.Allocator, move.AllocationMove.Source);
+
+    test.Move.reset();
+    test.MoveCount++;
+    return true;
+}
+
+auto main() -> int {
+
+    auto test = SDefragmentationTest{
+        .Allocator = CreateOffsetAllocator(g_initialSize, g_maxAllocations),
+        .Owners = {},
+        .Move = std::nullopt,
+        .Random = std::mt19937(1337)
+    };
+
+    auto fragmentationDrop = 0.0f;
+    for (auto roundIndex = 0u; roundIndex < g_roundCount; roundIndex++) {
+
+        // loads and unloads at random with the defragmenter running along, more loads in the first rounds
+        const auto allocatePercentage = roundIndex < g_roundCount / 2 ? 55u : 45u;
+        for (auto stepIndex = 0u; stepIndex < g_stepsPerRound; stepIndex++, test.StepIndex++) {
+            const auto action = test.Random() % 100;
+            if (action < allocatePercentage) {
+                AllocateOwner(test);
+            } else if (action < 90) {
+                FreeOwner(test);
+            } else {
+                DefragmentStep(test);
+            }
+            if (!Validate(test)) {
+                return 1;
+            }
+        }
+
+        // the defragmenter alone, until nothing near the end fits further down
+        const auto fragmentation = GetFragmentation(test.Allocator);
+        const auto moveCount = test.MoveCount;
+        auto usedEnd = GetUsedEnd(test);
+        while (DefragmentStep(test)) {
+            test.StepIndex++;
+            if (!Validate(test)) {
+                return 1;
+            }
+            // a destination is allocated first, it never lands past the source, the end never goes up
+            if (!test.Move.has_value()) {
+                const auto newUsedEnd = GetUsedEnd(test);
+                if (newUsedEnd > usedEnd) {
+                    std::printf("step %u: the used space grew from %u to %u\n", test.StepIndex, usedEnd, newUsedEnd);
+                    return 1;
+                }
+                usedEnd = newUsedEnd;
+            }
+        }
+
+        const auto drainedFragmentation = GetFragmentation(test.Allocator);
+        std::printf("round %u: %zu owners, size %u, fragmentation %.6f -> %.6f after %u moves\n",
+            roundIndex,
+            static_cast<std::size_t>(std::ranges::count_if(test.Owners, [](const auto& owner) { return owner.has_value(); })),
+            test.Allocator.Size,
+            fragmentation,
+            drainedFragmentation,
+            test.MoveCount - moveCount);
+        // a single move can carve its destination out of the largest free range and nudge the fragmentation up,
+        // only the drop over the whole run is asserted
+        fragmentationDrop += fragmentation - drainedFragmentation;
+    }
+
+    if (fragmentationDrop <= 0.0f) {
+        std::printf("the moves never brought the fragmentation down\n");
+        return 1;
+    }
+    std::printf("%u moves, fragmentation down by %.6f in total\n", test.MoveCount, fragmentationDrop);
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "ProgramCache.hpp"
+#include "Hash.hpp"
+#include "Io.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glad/gl.h>
+#include <spdlog/spdlog.h>
+
+// Bump g_programCacheVersion whenever the layout of the cache files changes
+
+constexpr uint32_t g_programCacheMagic = 0x42505754; // TWPB
+constexpr uint32_t g_programCacheVersion = 1;
+
+const std::filesystem::path g_programCacheDirectory = "cache/programs";
+
+struct SProgramCacheHeader {
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t BinaryFormat;
+    uint32_t BinarySize;
+};
+
+auto GetProgramCacheFilePath(uint64_t programCacheKey) -> std::filesystem::path {
+    return g_programCacheDirectory / std::format("{:016x}_{}.bin", programCacheKey, g_programCacheVersion);
+}
+
+auto GetDriverHash() -> uint64_t {
+
+    static const auto driverHash = [] {
+        auto getString = [](uint32_t name) {
+            const auto* string = reinterpret_cast<const char*>(glGetString(name));
+            return std::string_view(string != nullptr ? string : "");
+        };
+        auto hash = Hash64(getString(GL_VENDOR));
+        hash = HashCombine(hash, Hash64(getString(GL_RENDERER)));
+        return HashCombine(hash, Hash64(getString(GL_VERSION)));
+    }();
+    return driverHash;
+}
+
+auto GetProgramCacheKey(
+    uint32_t shaderType,
+    std::string_view shaderSource) -> uint64_t {
+
+    return HashCombine(HashCombine(GetDriverHash(), shaderType), Hash64(shaderSource));
+}
+
+auto LoadProgramFromCache(uint64_t programCacheKey) -> uint32_t {
+
+    const auto cacheFilePath = GetProgramCacheFilePath(programCacheKey);
+    auto [fileData, fileDataSize] = ReadBinaryFromFile(cacheFilePath);
+    if (fileData == nullptr || fileDataSize < sizeof(SProgramCacheHeader)) {
+        return 0;
+    }
+
+    SProgramCacheHeader header = {};
+    std::memcpy(&header, fileData.get(), sizeof(header));
+    if (header.Magic != g_programCacheMagic ||
+        header.Version != g_programCacheVersion ||
+        header.BinarySize != fileDataSize - sizeof(header)) {
+        return 0;
+    }
+
+    auto program = glCreateProgram();
+    glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    glProgramBinary(program, header.BinaryFormat, fileData.get() + sizeof(header), static_cast<int32_t>(header.BinarySize));
+
+    int32_t linkStatus = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE) {
+        // the driver doesn't take it anymore, the next compile writes a fresh one
+        spdlog::warn("Program cache: binary {:016x} was rejected by the driver", programCacheKey);
+        glDeleteProgram(program);
+        std::error_code errorCode;
+        std::filesystem::remove(cacheFilePath, errorCode);
+        return 0;
+    }
+
+    return program;
+}
+
+auto SaveProgramToCache(
+    uint64_t programCacheKey,
+    uint32_t program) -> bool {
+
+    int32_t binarySize = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+    if (binarySize <= 0) {
+        return false;
+    }
+
+    std::vector<std::byte> fileData(sizeof(SProgramCacheHeader) + static_cast<std::size_t>(binarySize));
+    uint32_t binaryFormat = 0;
+    int32_t writtenSize = 0;
+    glGetProgramBinary(program, binarySize, &writtenSize, &binaryFormat, fileData.data() + sizeof(SProgramCacheHeader));
+    if (writtenSize <= 0) {
+        return false;
+    }
+
+    const auto header = SProgramCacheHeader{
+        .Magic = g_programCacheMagic,
+        .Version = g_programCacheVersion,
+        .BinaryFormat = binaryFormat,
+        .BinarySize = static_cast<uint32_t>(writtenSize)
+    };
+    std::memcpy(fileData.data(), &header, sizeof(header));
+    fileData.resize(sizeof(header) + static_cast<std::size_t>(writtenSize));
+
+    // each writer gets its own temporary file, instances and threads saving the same program don't write into one
+    auto cacheFilePath = GetProgramCacheFilePath(programCacheKey);
+    auto temporaryCacheFilePath = std::filesystem::path(cacheFilePath).replace_extension(
+        std::format(".{:08x}{:08x}.tmp", std::random_device{}(), std::random_device{}()));
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(g_programCacheDirectory, errorCode);
+    if (errorCode) {
+        return false;
+    }
+
+    auto isWritten = false;
+    {
+        std::ofstream file{temporaryCacheFilePath, std::ofstream::binary | std::ofstream::trunc};
+        file.write(reinterpret_cast<const char*>(fileData.data()), static_cast<std::streamsize>(fileData.size()));
+        file.close();
+        isWritten = !file.fail();
+    }
+    if (!isWritten) {
+        std::filesystem::remove(temporaryCacheFilePath, errorCode);
+        return false;
+    }
+
+    // readers never see a half written cache file, the last of several writers wins
+    std::filesystem::rename(temporaryCacheFilePath, cacheFilePath, errorCode);
+    if (errorCode) {
+        std::filesystem::remove(temporaryCacheFilePath, errorCode);
+        return false;
+    }
+    return true;
+}
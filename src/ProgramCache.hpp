@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// Linked programs as the driver hands them out (glGetProgramBinary), named after a hash of the shader source as it
+// is compiled and of the driver (vendor, renderer, version). A driver update changes the key, a binary the driver
+// rejects all the same is thrown away and the caller compiles from source. GL thread only
+
+auto GetProgramCacheKey(
+    uint32_t shaderType,
+    std::string_view shaderSource) -> uint64_t;
+
+// a separable program, 0 when there is no usable binary for the key
+auto LoadProgramFromCache(uint64_t programCacheKey) -> uint32_t;
+// the program has to be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+auto SaveProgramToCache(
+    uint64_t programCacheKey,
+    uint32_t program) -> bool;
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Content addressed registry. Resources are looked up by a 64 bit hash of whatever they were created from,
+// everyone adding the same content shares one resource. Entries are reference counted, Release hands the
+// resource back once the last reference is gone so the caller can destroy it.
+// Resources living in slots of an array the caller owns get their slot from the registry, slots of released
+// resources are handed out again before the array has to grow
+template <typename T>
+struct SResourceRegistry {
+
+    struct SEntry {
+        T Resource;
+        uint32_t ReferenceCount = 0;
+    };
+
+    std::unordered_map<uint64_t, SEntry> Entries;
+    std::vector<size_t> FreeSlots;
+
+    // takes another reference on an existing resource, nullptr when nothing was registered under the key yet
+    auto Acquire(uint64_t key) -> T* {
+        auto entry = Entries.find(key);
+        if (entry == Entries.end()) {
+            return nullptr;
+        }
+        entry->second.ReferenceCount++;
+        return &entry->second.Resource;
+    }
+
+    // registers a new resource, the caller holds the first reference
+    auto Add(uint64_t key, T resource) -> T& {
+        auto& entry = Entries[key];
+        entry = SEntry{ .Resource = std::move(resource), .ReferenceCount = 1 };
+        return entry.Resource;
+    }
+
+    // a released slot, or slotCount when the caller has to append a new one
+    auto AllocateSlot(size_t slotCount) -> size_t {
+        if (FreeSlots.empty()) {
+            return slotCount;
+        }
+        const auto slot = FreeSlots.back();
+        FreeSlots.pop_back();
+        return slot;
+    }
+
+    auto FreeSlot(size_t slot) -> void {
+        FreeSlots.push_back(slot);
+    }
+
+    auto Release(uint64_t key) -> std::optional<T> {
+        auto entry = Entries.find(key);
+        if (entry == Entries.end() || --entry->second.ReferenceCount > 0) {
+            return std::nullopt;
+        }
+        auto resource = std::move(entry->second.Resource);
+        Entries.erase(entry);
+        return resource;
+    }
+};
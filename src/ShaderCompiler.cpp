@@ -0,0 +1,309 @@
+#include "ShaderCompiler.hpp"
+#include "DebugLabel.hpp"
+#include "Io.hpp"
+#include "ProgramCache.hpp"
+#include "VertexFormat.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <format>
+
+#include <glad/gl.h>
+#include <spdlog/spdlog.h>
+
+struct SShaderPreprocessor {
+    SPreprocessedShader PreprocessedShader;
+    std::span<const SShaderDefine> Defines;
+};
+
+auto TrimShaderLine(std::string_view line) -> std::string_view {
+
+    const auto first = line.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    const auto last = line.find_last_not_of(" \t\r");
+    return line.substr(first, last - first + 1);
+}
+
+auto GetIncludeFileName(std::string_view directive) -> std::string_view {
+
+    const auto first = directive.find('"');
+    const auto last = directive.rfind('"');
+    if (first == std::string_view::npos || last == first) {
+        return {};
+    }
+    return directive.substr(first + 1, last - first - 1);
+}
+
+auto PreprocessShaderFile(
+    SShaderPreprocessor& preprocessor,
+    const std::filesystem::path& filePath,
+    std::size_t sourceStringIndex) -> std::expected<void, std::string> {
+
+    const auto shaderSource = ReadTextFromFile(filePath);
+    if (shaderSource.empty()) {
+        return std::unexpected(std::format("Either file {} was not found or is empty", filePath.string()));
+    }
+
+    auto& source = preprocessor.PreprocessedShader.Source;
+    auto& filePaths = preprocessor.PreprocessedShader.FilePaths;
+
+    auto lineNumber = std::size_t{0};
+    for (auto lineStart = std::size_t{0}; lineStart < shaderSource.size();) {
+
+        auto lineEnd = shaderSource.find('\n', lineStart);
+        if (lineEnd == std::string::npos) {
+            lineEnd = shaderSource.size();
+        }
+        const auto line = std::string_view(shaderSource).substr(lineStart, lineEnd - lineStart);
+        const auto directive = TrimShaderLine(line);
+        lineStart = lineEnd + 1;
+        lineNumber++;
+
+        // whatever is inserted in place of a line is followed by a #line pointing at the next one
+        const auto resumeLine = std::format("#line {} {}\n", lineNumber + 1, sourceStringIndex);
+
+        if (directive.starts_with("#version")) {
+            if (sourceStringIndex != 0) {
+                return std::unexpected(std::format("{}({}): included files can't have a #version", filePath.string(), lineNumber));
+            }
+            source.append(line).append("\n");
+            for (const auto& define : preprocessor.Defines) {
+                source.append(std::format("#define {} {}\n", define.Name, define.Value));
+            }
+            source.append(resumeLine);
+            continue;
+        }
+
+        if (directive.starts_with("#include")) {
+            const auto includeFileName = GetIncludeFileName(directive);
+            if (includeFileName.empty()) {
+                return std::unexpected(std::format("{}({}): expected #include \"file\"", filePath.string(), lineNumber));
+            }
+
+            std::error_code errorCode;
+            auto includeFilePath = std::filesystem::weakly_canonical(filePath.parent_path() / includeFileName, errorCode);
+            if (errorCode) {
+                includeFilePath = (filePath.parent_path() / includeFileName).lexically_normal();
+            }
+
+            if (std::ranges::find(filePaths, includeFilePath) == filePaths.end()) {
+                const auto includeSourceStringIndex = filePaths.size();
+                filePaths.push_back(includeFilePath);
+                source.append(std::format("#line 1 {}\n", includeSourceStringIndex));
+                auto includeResult = PreprocessShaderFile(preprocessor, includeFilePath, includeSourceStringIndex);
+                if (!includeResult) {
+                    return std::unexpected(std::format("{}\n  included from {}({})", includeResult.error(), filePath.string(), lineNumber));
+                }
+            }
+            source.append(resumeLine);
+            continue;
+        }
+
+        // the vertex layouts of the mega buffers come from VertexFormat.hpp
+        if (directive == "#pragma vertex_format") {
+            source.append(GetVertexFormatGlsl()).append("\n");
+            source.append(resumeLine);
+            continue;
+        }
+
+        source.append(line).append("\n");
+    }
+
+    return {};
+}
+
+auto PreprocessShader(
+    const std::filesystem::path& filePath,
+    std::span<const SShaderDefine> defines) -> std::expected<SPreprocessedShader, std::string> {
+
+    std::error_code errorCode;
+    auto shaderFilePath = std::filesystem::weakly_canonical(filePath, errorCode);
+    if (errorCode) {
+        shaderFilePath = filePath.lexically_normal();
+    }
+
+    SShaderPreprocessor preprocessor = {
+        .PreprocessedShader = { .FilePaths = { shaderFilePath } },
+        .Defines = defines
+    };
+
+    auto result = PreprocessShaderFile(preprocessor, shaderFilePath, 0);
+    if (!result) {
+        return std::unexpected(result.error());
+    }
+
+    return std::move(preprocessor.PreprocessedShader);
+}
+
+auto MapShaderLog(
+    std::string_view log,
+    std::span<const std::filesystem::path> filePaths) -> std::string {
+
+    // nvidia writes "0(12) : error", mesa "0:12(3): error" and amd "ERROR: 0:12: error"
+    auto mapLine = [&](std::string_view line) -> std::string {
+
+        auto prefixSize = std::size_t{0};
+        for (const auto prefix : { std::string_view("ERROR: "), std::string_view("WARNING: ") }) {
+            if (line.starts_with(prefix)) {
+                prefixSize = prefix.size();
+            }
+        }
+
+        const auto* begin = line.data() + prefixSize;
+        const auto* end = line.data() + line.size();
+
+        std::size_t sourceStringIndex = 0;
+        auto [sourceStringEnd, sourceStringError] = std::from_chars(begin, end, sourceStringIndex);
+        if (sourceStringError != std::errc{} || sourceStringEnd == end || sourceStringIndex >= filePaths.size()) {
+            return std::string(line);
+        }
+
+        const auto separator = *sourceStringEnd;
+        if (separator != '(' && separator != ':') {
+            return std::string(line);
+        }
+
+        std::size_t lineNumber = 0;
+        auto [lineNumberEnd, lineNumberError] = std::from_chars(sourceStringEnd + 1, end, lineNumber);
+        if (lineNumberError != std::errc{}) {
+            return std::string(line);
+        }
+        if (separator == '(' && lineNumberEnd != end && *lineNumberEnd == ')') {
+            lineNumberEnd++;
+        }
+
+        return std::format("{}{}({}){}",
+            line.substr(0, prefixSize),
+            filePaths[sourceStringIndex].lexically_proximate(std::filesystem::current_path()).string(),
+            lineNumber,
+            std::string_view(lineNumberEnd, end));
+    };
+
+    std::string mappedLog;
+    for (auto lineStart = std::size_t{0}; lineStart < log.size();) {
+        auto lineEnd = log.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) {
+            lineEnd = log.size();
+        }
+        mappedLog.append(mapLine(log.substr(lineStart, lineEnd - lineStart))).append("\n");
+        lineStart = lineEnd + 1;
+    }
+    return mappedLog;
+}
+
+auto InitializeShaderCompiler() -> void {
+
+    if (GLAD_GL_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+    spdlog::info("Parallel shader compilation: {}", GLAD_GL_KHR_parallel_shader_compile != 0);
+}
+
+auto BeginProgramCompile(
+    uint32_t shaderType,
+    const std::filesystem::path& filePath,
+    std::string_view label,
+    std::span<const SShaderDefine> defines) -> std::expected<SProgramCompile, std::string> {
+
+    SProgramCompile programCompile = {
+        .Label = std::string(label),
+        .StartTime = std::chrono::steady_clock::now()
+    };
+
+    auto preprocessedShader = PreprocessShader(filePath, defines);
+    if (!preprocessedShader) {
+        return std::unexpected(preprocessedShader.error());
+    }
+    programCompile.PreprocessedShader = std::move(*preprocessedShader);
+    const auto& source = programCompile.PreprocessedShader.Source;
+
+    programCompile.ProgramCacheKey = GetProgramCacheKey(shaderType, source);
+    if (auto cachedProgram = LoadProgramFromCache(programCompile.ProgramCacheKey); cachedProgram != 0) {
+        SetDebugLabel(cachedProgram, GL_PROGRAM, label);
+        programCompile.Program = cachedProgram;
+        programCompile.IsCached = true;
+        return programCompile;
+    }
+
+    // what glCreateShaderProgramv does, except that the binary is asked to be retrievable before linking and that
+    // nothing waits for the compiler here
+    const auto* sourcePtr = source.data();
+    programCompile.Shader = glCreateShader(shaderType);
+    glShaderSource(programCompile.Shader, 1, &sourcePtr, nullptr);
+    glCompileShader(programCompile.Shader);
+
+    programCompile.Program = glCreateProgram();
+    SetDebugLabel(programCompile.Program, GL_PROGRAM, label);
+    glProgramParameteri(programCompile.Program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    glProgramParameteri(programCompile.Program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(programCompile.Program, programCompile.Shader);
+    glLinkProgram(programCompile.Program);
+
+    return programCompile;
+}
+
+auto IsProgramCompileComplete(const SProgramCompile& programCompile) -> bool {
+
+    if (programCompile.IsCached || !GLAD_GL_KHR_parallel_shader_compile) {
+        return true;
+    }
+
+    int32_t completionStatus = GL_FALSE;
+    glGetProgramiv(programCompile.Program, GL_COMPLETION_STATUS_KHR, &completionStatus);
+    return completionStatus == GL_TRUE;
+}
+
+auto FinishProgramCompile(SProgramCompile& programCompile) -> std::expected<uint32_t, std::string> {
+
+    auto getElapsedMilliseconds = [&]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - programCompile.StartTime).count();
+    };
+
+    const auto program = std::exchange(programCompile.Program, 0);
+    if (programCompile.IsCached) {
+        spdlog::info("Loaded program {} from the program cache in {:.2f} ms", programCompile.Label, getElapsedMilliseconds());
+        return program;
+    }
+
+    const auto shader = std::exchange(programCompile.Shader, 0);
+
+    int32_t linkStatus = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+    if (linkStatus == GL_FALSE)
+    {
+        // a shader which didn't compile fails the link as well, its own log says why
+        int32_t compileStatus = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compileStatus);
+
+        std::string errorLog;
+        int32_t length = 512;
+        if (compileStatus == GL_FALSE) {
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+            errorLog.resize(length + 1, '\0');
+            glGetShaderInfoLog(shader, length, nullptr, errorLog.data());
+        } else {
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+            errorLog.resize(length + 1, '\0');
+            glGetProgramInfoLog(program, length, nullptr, errorLog.data());
+        }
+        glDeleteShader(shader);
+        glDeleteProgram(program);
+        return std::unexpected(MapShaderLog(errorLog.c_str(), programCompile.PreprocessedShader.FilePaths));
+    }
+
+    glDetachShader(program, shader);
+    glDeleteShader(shader);
+
+    const auto isCached = SaveProgramToCache(programCompile.ProgramCacheKey, program);
+    spdlog::info("Compiled program {} in {:.2f} ms{}", programCompile.Label, getElapsedMilliseconds(), isCached ? "" : ", unable to cache it");
+
+    return program;
+}
+
+auto AbortProgramCompile(SProgramCompile& programCompile) -> void {
+
+    glDeleteShader(std::exchange(programCompile.Shader, 0));
+    glDeleteProgram(std::exchange(programCompile.Program, 0));
+}
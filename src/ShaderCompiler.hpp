@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct SShaderDefine {
+    std::string Name;
+    std::string Value;
+};
+
+// source as it goes to the driver: includes resolved, defines and the vertex format in place and #line directives
+// telling where each line came from. FilePaths[i] is source string i of those directives, the shader file is 0
+struct SPreprocessedShader {
+    std::string Source;
+    std::vector<std::filesystem::path> FilePaths;
+};
+
+// #include "file" is resolved relative to the including file and pulls a file in once per shader, later includes
+// of the same file are skipped. defines follow the #version line, #pragma vertex_format expands to the vertex
+// layouts of VertexFormat.hpp
+auto PreprocessShader(
+    const std::filesystem::path& filePath,
+    std::span<const SShaderDefine> defines) -> std::expected<SPreprocessedShader, std::string>;
+
+// turns the source string numbers of a driver log ("0(12) : error", "0:12(3): error") into file names
+auto MapShaderLog(
+    std::string_view log,
+    std::span<const std::filesystem::path> filePaths) -> std::string;
+
+// a program on its way through the driver. compiling and linking are submitted by BeginProgramCompile and nothing
+// asks for their results before FinishProgramCompile, so the driver can work on all programs at once. with
+// GL_KHR_parallel_shader_compile it does so on its own threads and IsProgramCompileComplete tells when it is done
+struct SProgramCompile {
+    std::string Label;
+    SPreprocessedShader PreprocessedShader;
+    uint64_t ProgramCacheKey = 0;
+    uint32_t Shader = 0;
+    uint32_t Program = 0;
+    // the program came out of the program cache, there is nothing left to wait for
+    bool IsCached = false;
+    std::chrono::steady_clock::time_point StartTime;
+};
+
+// hands the driver as many compiler threads as it wants, when it can use them
+auto InitializeShaderCompiler() -> void;
+
+auto BeginProgramCompile(
+    uint32_t shaderType,
+    const std::filesystem::path& filePath,
+    std::string_view label,
+    std::span<const SShaderDefine> defines) -> std::expected<SProgramCompile, std::string>;
+auto IsProgramCompileComplete(const SProgramCompile& programCompile) -> bool;
+// waits for the driver when it is not done yet. the program belongs to the caller afterwards
+auto FinishProgramCompile(SProgramCompile& programCompile) -> std::expected<uint32_t, std::string>;
+auto AbortProgramCompile(SProgramCompile& programCompile) -> void;
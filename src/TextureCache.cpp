@@ -0,0 +1,200 @@
+#include "TextureCache.hpp"
+#include "Io.hpp"
+#include "Mipmap.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <random>
+
+#include <ktx.h>
+#include <spdlog/spdlog.h>
+
+// Cooked textures are plain KTX2 files, named after the content hash of the source image and the cooking version.
+// Bump g_textureCacheVersion whenever the way textures are cooked changes
+
+constexpr uint32_t g_textureCacheVersion = 2;
+constexpr uint32_t g_vkFormatR8G8B8A8Unorm = 37; // VK_FORMAT_R8G8B8A8_UNORM
+constexpr uint32_t g_vkFormatR8G8B8A8Srgb = 43; // VK_FORMAT_R8G8B8A8_SRGB
+constexpr uint32_t g_zstdCompressionLevel = 18;
+
+const std::filesystem::path g_textureCacheDirectory = "cache/textures";
+
+auto GetTextureCacheFilePath(
+    uint64_t contentHash,
+    bool isSrgb) -> std::filesystem::path {
+    return g_textureCacheDirectory / std::format("{:016x}_{}_{}.ktx2", contentHash, isSrgb ? "srgb" : "linear", g_textureCacheVersion);
+}
+
+auto TranscodeTexture(ktxTexture2* texture) -> std::optional<SCookedTexture> {
+
+    // the transfer function survives basis compression, vkFormat does not
+    const auto isSrgb = ktxTexture2_GetOETF_e(texture) == KHR_DF_TRANSFER_SRGB;
+
+    auto format = ECookedTextureFormat::Bc7;
+    if (ktxTexture2_NeedsTranscoding(texture)) {
+        if (ktxTexture2_TranscodeBasis(texture, KTX_TTF_BC7_RGBA, 0) != KTX_SUCCESS) {
+            if (ktxTexture2_TranscodeBasis(texture, KTX_TTF_RGBA32, 0) != KTX_SUCCESS) {
+                return std::nullopt;
+            }
+            format = ECookedTextureFormat::Rgba8;
+        }
+    } else if (texture->vkFormat == g_vkFormatR8G8B8A8Srgb || texture->vkFormat == g_vkFormatR8G8B8A8Unorm) {
+        format = ECookedTextureFormat::Rgba8;
+    } else {
+        return std::nullopt;
+    }
+
+    SCookedTexture cookedTexture = {};
+    cookedTexture.Width = texture->baseWidth;
+    cookedTexture.Height = texture->baseHeight;
+    cookedTexture.Format = format;
+    cookedTexture.IsSrgb = isSrgb;
+
+    for (uint32_t level = 0; level < texture->numLevels; level++) {
+        ktx_size_t levelOffset = 0;
+        if (ktxTexture_GetImageOffset(ktxTexture(texture), level, 0, 0, &levelOffset) != KTX_SUCCESS) {
+            return std::nullopt;
+        }
+
+        cookedTexture.Levels.push_back(SCookedTextureLevel{
+            .Width = std::max(texture->baseWidth >> level, 1u),
+            .Height = std::max(texture->baseHeight >> level, 1u),
+            .Offset = levelOffset,
+            .Size = ktxTexture_GetImageSize(ktxTexture(texture), level)
+        });
+    }
+
+    const auto* data = reinterpret_cast<const std::byte*>(ktxTexture_GetData(ktxTexture(texture)));
+    cookedTexture.Data.assign(data, data + ktxTexture_GetDataSize(ktxTexture(texture)));
+
+    return cookedTexture;
+}
+
+auto LoadCookedTexture(
+    uint64_t contentHash,
+    bool isSrgb) -> std::optional<SCookedTexture> {
+
+    auto mappedFile = MapFile(GetTextureCacheFilePath(contentHash, isSrgb), EFileAccessPattern::Sequential);
+    if (!mappedFile.has_value()) {
+        return std::nullopt;
+    }
+
+    ktxTexture2* texture = nullptr;
+    auto result = ktxTexture2_CreateFromMemory(
+        reinterpret_cast<const ktx_uint8_t*>(mappedFile->Data),
+        mappedFile->Size,
+        KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT,
+        &texture);
+    UnmapFile(*mappedFile);
+
+    if (result != KTX_SUCCESS) {
+        spdlog::warn("Unable to read cooked texture {:016x}: {}", contentHash, ktxErrorString(result));
+        return std::nullopt;
+    }
+
+    auto cookedTexture = TranscodeTexture(texture);
+    ktxTexture_Destroy(ktxTexture(texture));
+    return cookedTexture;
+}
+
+auto SaveCookedTexture(
+    uint64_t contentHash,
+    bool isSrgb,
+    ktxTexture2* texture) -> bool {
+
+    ktx_uint8_t* fileData = nullptr;
+    ktx_size_t fileDataSize = 0;
+    if (ktxTexture_WriteToMemory(ktxTexture(texture), &fileData, &fileDataSize) != KTX_SUCCESS) {
+        return false;
+    }
+
+    // each writer gets its own temporary file, models sharing an image cook it on several workers at once
+    auto cacheFilePath = GetTextureCacheFilePath(contentHash, isSrgb);
+    auto temporaryCacheFilePath = std::filesystem::path(cacheFilePath).replace_extension(
+        std::format(".{:08x}{:08x}.tmp", std::random_device{}(), std::random_device{}()));
+
+    std::error_code errorCode;
+    std::filesystem::create_directories(g_textureCacheDirectory, errorCode);
+
+    auto isWritten = false;
+    if (!errorCode) {
+        std::ofstream file{temporaryCacheFilePath, std::ofstream::binary | std::ofstream::trunc};
+        file.write(reinterpret_cast<const char*>(fileData), static_cast<std::streamsize>(fileDataSize));
+        file.close();
+        isWritten = !file.fail();
+    }
+    free(fileData);
+
+    if (!isWritten) {
+        std::filesystem::remove(temporaryCacheFilePath, errorCode);
+        return false;
+    }
+
+    // readers never see a half written cache file, the last of several writers wins
+    std::filesystem::rename(temporaryCacheFilePath, cacheFilePath, errorCode);
+    if (errorCode) {
+        std::filesystem::remove(temporaryCacheFilePath, errorCode);
+        return false;
+    }
+    return true;
+}
+
+auto CookTexture(
+    uint64_t contentHash,
+    const SMipmapChain& mipmapChain) -> std::optional<SCookedTexture> {
+
+    if (mipmapChain.Levels.empty()) {
+        return std::nullopt;
+    }
+
+    ktxTextureCreateInfo createInfo = {};
+    createInfo.vkFormat = mipmapChain.IsSrgb ? g_vkFormatR8G8B8A8Srgb : g_vkFormatR8G8B8A8Unorm;
+    createInfo.baseWidth = mipmapChain.Width;
+    createInfo.baseHeight = mipmapChain.Height;
+    createInfo.baseDepth = 1;
+    createInfo.numDimensions = 2;
+    createInfo.numLevels = static_cast<uint32_t>(mipmapChain.Levels.size());
+    createInfo.numLayers = 1;
+    createInfo.numFaces = 1;
+    createInfo.isArray = KTX_FALSE;
+    createInfo.generateMipmaps = KTX_FALSE;
+
+    ktxTexture2* texture = nullptr;
+    auto result = ktxTexture2_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &texture);
+    if (result != KTX_SUCCESS) {
+        spdlog::error("Unable to create texture {:016x}: {}", contentHash, ktxErrorString(result));
+        return std::nullopt;
+    }
+
+    for (uint32_t level = 0; const auto& mipmapLevel : mipmapChain.Levels) {
+        ktxTexture_SetImageFromMemory(ktxTexture(texture), level++, 0, 0, &mipmapChain.Pixels[mipmapLevel.Offset], mipmapLevel.Size);
+    }
+
+    // images are cooked in parallel already, the encoder stays on the calling thread
+    ktxBasisParams basisParams = {};
+    basisParams.structSize = sizeof(ktxBasisParams);
+    basisParams.uastc = KTX_TRUE;
+    basisParams.uastcFlags = KTX_PACK_UASTC_LEVEL_DEFAULT;
+    basisParams.threadCount = 1;
+
+    result = ktxTexture2_CompressBasisEx(texture, &basisParams);
+    if (result == KTX_SUCCESS) {
+        result = ktxTexture2_DeflateZstd(texture, g_zstdCompressionLevel);
+    }
+    if (result != KTX_SUCCESS) {
+        spdlog::error("Unable to encode texture {:016x}: {}", contentHash, ktxErrorString(result));
+        ktxTexture_Destroy(ktxTexture(texture));
+        return std::nullopt;
+    }
+
+    if (!SaveCookedTexture(contentHash, mipmapChain.IsSrgb, texture)) {
+        spdlog::warn("Unable to write cooked texture {:016x}", contentHash);
+    }
+
+    auto cookedTexture = TranscodeTexture(texture);
+    ktxTexture_Destroy(ktxTexture(texture));
+    return cookedTexture;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Mipmap.hpp"
+
+enum class ECookedTextureFormat : uint32_t {
+    Bc7,
+    Rgba8
+};
+
+struct SCookedTextureLevel {
+    uint32_t Width;
+    uint32_t Height;
+    std::size_t Offset;
+    std::size_t Size;
+};
+
+// a texture with its whole mip chain, transcoded from the cached KTX2 file into something the GPU samples directly.
+// falls back to plain rgba8 when the basis transcoder can't produce BC7
+struct SCookedTexture {
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    ECookedTextureFormat Format = ECookedTextureFormat::Bc7;
+    bool IsSrgb = false;
+    std::vector<SCookedTextureLevel> Levels;
+    std::vector<std::byte> Data;
+};
+
+// contentHash identifies the encoded source image (png, jpeg, ...) the texture was cooked from, the same image
+// can be cooked once as color (sRGB) and once as data (linear)
+auto LoadCookedTexture(
+    uint64_t contentHash,
+    bool isSrgb) -> std::optional<SCookedTexture>;
+
+// encodes a mip chain as UASTC with zstd supercompression into the texture cache and returns the transcoded result
+auto CookTexture(
+    uint64_t contentHash,
+    const SMipmapChain& mipmapChain) -> std::optional<SCookedTexture>;
@@ -0,0 +1,365 @@
+#include "TransformHierarchy.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <type_traits>
+
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/matrix_decompose.hpp>
+
+#include <poolstl/poolstl.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+  #include <xmmintrin.h>
+  #define TOADWART_TRANSFORM_SSE
+#endif
+
+// skew or perspective further from none than this keeps the matrix a node was created from
+constexpr float g_transformSkewEpsilon = 1e-4f;
+
+// nodes of a depth are updated in chunks of this many, depths with fewer nodes don't go to the thread pool
+constexpr uint32_t g_transformNodeChunkSize = 1024;
+
+auto GetLocalMatrix(
+    const glm::vec3& translation,
+    const glm::quat& rotation,
+    const glm::vec3& scale) -> glm::mat4 {
+
+    // T * R * S
+    const auto rotationMatrix = glm::mat3_cast(rotation);
+    return glm::mat4(
+        glm::vec4(rotationMatrix[0] * scale.x, 0.0f),
+        glm::vec4(rotationMatrix[1] * scale.y, 0.0f),
+        glm::vec4(rotationMatrix[2] * scale.z, 0.0f),
+        glm::vec4(translation, 1.0f));
+}
+
+// each column of the world matrix is the columns of the parent weighted by a column of the local matrix, 4 lanes at once
+auto MultiplyWorldMatrix(
+    const glm::mat4& parentWorldMatrix,
+    const glm::mat4& localMatrix,
+    glm::mat4& worldMatrix) -> void {
+
+#if defined(TOADWART_TRANSFORM_SSE)
+    const auto parentColumn0 = _mm_loadu_ps(&parentWorldMatrix[0][0]);
+    const auto parentColumn1 = _mm_loadu_ps(&parentWorldMatrix[1][0]);
+    const auto parentColumn2 = _mm_loadu_ps(&parentWorldMatrix[2][0]);
+    const auto parentColumn3 = _mm_loadu_ps(&parentWorldMatrix[3][0]);
+
+    for (auto column = 0; column < 4; column++) {
+        auto result = _mm_mul_ps(parentColumn0, _mm_set1_ps(localMatrix[column][0]));
+        result = _mm_add_ps(result, _mm_mul_ps(parentColumn1, _mm_set1_ps(localMatrix[column][1])));
+        result = _mm_add_ps(result, _mm_mul_ps(parentColumn2, _mm_set1_ps(localMatrix[column][2])));
+        result = _mm_add_ps(result, _mm_mul_ps(parentColumn3, _mm_set1_ps(localMatrix[column][3])));
+        _mm_storeu_ps(&worldMatrix[column][0], result);
+    }
+#else
+    worldMatrix = parentWorldMatrix * localMatrix;
+#endif
+}
+
+auto GetNodeIndex(
+    const STransformHierarchy& hierarchy,
+    const uint32_t node) -> uint32_t {
+
+    return node < hierarchy.NodeIndices.size()
+        ? hierarchy.NodeIndices[node]
+        : g_transformNodeNone;
+}
+
+auto CreateTransformNode(
+    STransformHierarchy& hierarchy,
+    const uint32_t parentNode,
+    const glm::vec3& translation,
+    const glm::quat& rotation,
+    const glm::vec3& scale) -> uint32_t {
+
+    const auto nodeIndex = static_cast<uint32_t>(hierarchy.NodeHandles.size());
+
+    auto node = 0u;
+    if (!hierarchy.FreeHandles.empty()) {
+        node = hierarchy.FreeHandles.back();
+        hierarchy.FreeHandles.pop_back();
+        hierarchy.NodeIndices[node] = nodeIndex;
+    } else {
+        node = static_cast<uint32_t>(hierarchy.NodeIndices.size());
+        hierarchy.NodeIndices.push_back(nodeIndex);
+    }
+
+    // appending keeps parents in front of their children, the depths are sorted out by the next update
+    hierarchy.ParentHandles.push_back(parentNode);
+    hierarchy.ParentIndices.push_back(GetNodeIndex(hierarchy, parentNode));
+    hierarchy.Translations.push_back(translation);
+    hierarchy.Rotations.push_back(rotation);
+    hierarchy.Scales.push_back(scale);
+    hierarchy.LocalMatrices.push_back(glm::mat4(1.0f));
+    hierarchy.HasLocalMatrix.push_back(0);
+    hierarchy.WorldMatrices.push_back(glm::mat4(1.0f));
+    hierarchy.IsDirty.push_back(1);
+    hierarchy.IsChanged.push_back(0);
+    hierarchy.IsRemoved.push_back(0);
+    hierarchy.NodeHandles.push_back(node);
+
+    hierarchy.IsOrderDirty = true;
+    hierarchy.DirtyNodeCount++;
+
+    return node;
+}
+
+auto CreateTransformNode(
+    STransformHierarchy& hierarchy,
+    const uint32_t parentNode,
+    const glm::mat4& localMatrix) -> uint32_t {
+
+    glm::vec3 translation;
+    glm::quat rotation;
+    glm::vec3 scale;
+    glm::vec3 skew;
+    glm::vec4 perspective;
+    const auto isDecomposed = glm::decompose(localMatrix, scale, rotation, translation, skew, perspective);
+    if (!isDecomposed) {
+        translation = glm::vec3(0.0f);
+        rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        scale = glm::vec3(1.0f);
+    }
+
+    const auto node = CreateTransformNode(hierarchy, parentNode, translation, rotation, scale);
+
+    // decompose drops shear, and gives up on matrices it can't take apart at all
+    const auto isSheared = !isDecomposed ||
+        glm::any(glm::greaterThan(glm::abs(skew), glm::vec3(g_transformSkewEpsilon))) ||
+        glm::any(glm::greaterThan(glm::abs(perspective - glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)), glm::vec4(g_transformSkewEpsilon)));
+    if (isSheared) {
+        const auto nodeIndex = hierarchy.NodeIndices[node];
+        hierarchy.LocalMatrices[nodeIndex] = localMatrix;
+        hierarchy.HasLocalMatrix[nodeIndex] = 1;
+    }
+
+    return node;
+}
+
+auto DestroyTransformNode(
+    STransformHierarchy& hierarchy,
+    const uint32_t node) -> void {
+
+    const auto nodeIndex = GetNodeIndex(hierarchy, node);
+    if (nodeIndex == g_transformNodeNone) {
+        return;
+    }
+
+    hierarchy.IsRemoved[nodeIndex] = 1;
+    hierarchy.IsOrderDirty = true;
+}
+
+auto SetTransformNodeLocal(
+    STransformHierarchy& hierarchy,
+    const uint32_t node,
+    const glm::vec3& translation,
+    const glm::quat& rotation,
+    const glm::vec3& scale) -> void {
+
+    const auto nodeIndex = hierarchy.NodeIndices[node];
+    hierarchy.Translations[nodeIndex] = translation;
+    hierarchy.Rotations[nodeIndex] = rotation;
+    hierarchy.Scales[nodeIndex] = scale;
+    hierarchy.HasLocalMatrix[nodeIndex] = 0;
+    if (hierarchy.IsDirty[nodeIndex] == 0) {
+        hierarchy.IsDirty[nodeIndex] = 1;
+        hierarchy.DirtyNodeCount++;
+    }
+}
+
+auto SetTransformNodeRotation(
+    STransformHierarchy& hierarchy,
+    const uint32_t node,
+    const glm::quat& rotation) -> void {
+
+    const auto nodeIndex = hierarchy.NodeIndices[node];
+    SetTransformNodeLocal(hierarchy, node, hierarchy.Translations[nodeIndex], rotation, hierarchy.Scales[nodeIndex]);
+}
+
+auto GetTransformNodeTranslation(
+    const STransformHierarchy& hierarchy,
+    const uint32_t node) -> glm::vec3 {
+
+    return hierarchy.Translations[hierarchy.NodeIndices[node]];
+}
+
+auto GetTransformNodeRotation(
+    const STransformHierarchy& hierarchy,
+    const uint32_t node) -> glm::quat {
+
+    return hierarchy.Rotations[hierarchy.NodeIndices[node]];
+}
+
+auto GetTransformNodeScale(
+    const STransformHierarchy& hierarchy,
+    const uint32_t node) -> glm::vec3 {
+
+    return hierarchy.Scales[hierarchy.NodeIndices[node]];
+}
+
+auto GetWorldMatrix(
+    const STransformHierarchy& hierarchy,
+    const uint32_t node) -> const glm::mat4& {
+
+    return hierarchy.WorldMatrices[hierarchy.NodeIndices[node]];
+}
+
+auto IsTransformNodeChanged(
+    const STransformHierarchy& hierarchy,
+    const uint32_t node) -> bool {
+
+    return hierarchy.IsChanged[hierarchy.NodeIndices[node]] != 0;
+}
+
+auto GetTransformNodeCount(const STransformHierarchy& hierarchy) -> uint32_t {
+
+    return static_cast<uint32_t>(hierarchy.NodeHandles.size());
+}
+
+// drops removed nodes and their descendants and sorts the rest by depth. nodes are stored parents first at all
+// times, one pass front to back sees every parent before its children
+auto SortTransformNodes(STransformHierarchy& hierarchy) -> void {
+
+    const auto nodeCount = static_cast<uint32_t>(hierarchy.NodeHandles.size());
+
+    std::vector<uint32_t> depths(nodeCount, 0);
+    std::vector<uint32_t> order;
+    order.reserve(nodeCount);
+    for (auto nodeIndex = 0u; nodeIndex < nodeCount; nodeIndex++) {
+
+        const auto parentIndex = GetNodeIndex(hierarchy, hierarchy.ParentHandles[nodeIndex]);
+        if (parentIndex != g_transformNodeNone) {
+            hierarchy.IsRemoved[nodeIndex] |= hierarchy.IsRemoved[parentIndex];
+            depths[nodeIndex] = depths[parentIndex] + 1;
+        }
+
+        if (hierarchy.IsRemoved[nodeIndex] == 0) {
+            order.push_back(nodeIndex);
+        }
+    }
+
+    // handles of removed nodes are let go only now, their children above looked their parents up by handle
+    for (auto nodeIndex = 0u; nodeIndex < nodeCount; nodeIndex++) {
+        if (hierarchy.IsRemoved[nodeIndex] != 0) {
+            const auto node = hierarchy.NodeHandles[nodeIndex];
+            hierarchy.NodeIndices[node] = g_transformNodeNone;
+            hierarchy.FreeHandles.push_back(node);
+        }
+    }
+
+    std::ranges::stable_sort(order, std::less{}, [&](uint32_t nodeIndex) { return depths[nodeIndex]; });
+
+    auto reorder = [&](auto& values) {
+        std::remove_reference_t<decltype(values)> sortedValues;
+        sortedValues.reserve(order.size());
+        for (const auto nodeIndex : order) {
+            sortedValues.push_back(values[nodeIndex]);
+        }
+        values = std::move(sortedValues);
+    };
+    reorder(hierarchy.ParentHandles);
+    reorder(hierarchy.Translations);
+    reorder(hierarchy.Rotations);
+    reorder(hierarchy.Scales);
+    reorder(hierarchy.LocalMatrices);
+    reorder(hierarchy.HasLocalMatrix);
+    reorder(hierarchy.WorldMatrices);
+    reorder(hierarchy.IsDirty);
+    reorder(hierarchy.IsChanged);
+    reorder(hierarchy.IsRemoved);
+    reorder(hierarchy.NodeHandles);
+    reorder(depths);
+
+    for (auto nodeIndex = 0u; nodeIndex < order.size(); nodeIndex++) {
+        hierarchy.NodeIndices[hierarchy.NodeHandles[nodeIndex]] = nodeIndex;
+    }
+
+    hierarchy.ParentIndices.resize(order.size());
+    hierarchy.DepthOffsets.clear();
+    hierarchy.DirtyNodeCount = 0;
+    for (auto nodeIndex = 0u; nodeIndex < order.size(); nodeIndex++) {
+        hierarchy.ParentIndices[nodeIndex] = GetNodeIndex(hierarchy, hierarchy.ParentHandles[nodeIndex]);
+        while (hierarchy.DepthOffsets.size() <= depths[nodeIndex]) {
+            hierarchy.DepthOffsets.push_back(nodeIndex);
+        }
+        hierarchy.DirtyNodeCount += hierarchy.IsDirty[nodeIndex];
+    }
+    hierarchy.DepthOffsets.push_back(static_cast<uint32_t>(order.size()));
+
+    hierarchy.IsOrderDirty = false;
+}
+
+auto UpdateTransformNodes(
+    STransformHierarchy& hierarchy,
+    const uint32_t firstNodeIndex,
+    const uint32_t lastNodeIndex) -> uint32_t {
+
+    auto changedNodeCount = 0u;
+    for (auto nodeIndex = firstNodeIndex; nodeIndex < lastNodeIndex; nodeIndex++) {
+
+        const auto parentIndex = hierarchy.ParentIndices[nodeIndex];
+        const auto isParentChanged = parentIndex != g_transformNodeNone && hierarchy.IsChanged[parentIndex] != 0;
+        if (hierarchy.IsDirty[nodeIndex] == 0 && !isParentChanged) {
+            hierarchy.IsChanged[nodeIndex] = 0;
+            continue;
+        }
+
+        const auto localMatrix = hierarchy.HasLocalMatrix[nodeIndex] != 0
+            ? hierarchy.LocalMatrices[nodeIndex]
+            : GetLocalMatrix(hierarchy.Translations[nodeIndex], hierarchy.Rotations[nodeIndex], hierarchy.Scales[nodeIndex]);
+        if (parentIndex == g_transformNodeNone) {
+            hierarchy.WorldMatrices[nodeIndex] = localMatrix;
+        } else {
+            MultiplyWorldMatrix(hierarchy.WorldMatrices[parentIndex], localMatrix, hierarchy.WorldMatrices[nodeIndex]);
+        }
+
+        hierarchy.IsDirty[nodeIndex] = 0;
+        hierarchy.IsChanged[nodeIndex] = 1;
+        changedNodeCount++;
+    }
+
+    return changedNodeCount;
+}
+
+auto UpdateTransformHierarchy(STransformHierarchy& hierarchy) -> uint32_t {
+
+    if (hierarchy.IsOrderDirty) {
+        SortTransformNodes(hierarchy);
+    }
+
+    // nothing moved now and nothing is left flagged from the last update
+    if (hierarchy.DirtyNodeCount == 0 && hierarchy.ChangedNodeCount == 0) {
+        return 0;
+    }
+
+    // a depth only reads the world matrices and changed flags of the depth above it
+    std::atomic<uint32_t> changedNodeCount = 0;
+    std::vector<uint32_t> chunkIndices;
+    for (auto depth = 0u; depth + 1 < hierarchy.DepthOffsets.size(); depth++) {
+
+        const auto firstNodeIndex = hierarchy.DepthOffsets[depth];
+        const auto lastNodeIndex = hierarchy.DepthOffsets[depth + 1];
+        const auto depthNodeCount = lastNodeIndex - firstNodeIndex;
+        if (depthNodeCount <= g_transformNodeChunkSize) {
+            changedNodeCount += UpdateTransformNodes(hierarchy, firstNodeIndex, lastNodeIndex);
+            continue;
+        }
+
+        chunkIndices.resize((depthNodeCount + g_transformNodeChunkSize - 1) / g_transformNodeChunkSize);
+        std::iota(chunkIndices.begin(), chunkIndices.end(), 0u);
+        std::for_each(poolstl::execution::par, chunkIndices.begin(), chunkIndices.end(), [&](uint32_t chunkIndex) {
+            const auto chunkFirstNodeIndex = firstNodeIndex + chunkIndex * g_transformNodeChunkSize;
+            const auto chunkLastNodeIndex = std::min(chunkFirstNodeIndex + g_transformNodeChunkSize, lastNodeIndex);
+            changedNodeCount += UpdateTransformNodes(hierarchy, chunkFirstNodeIndex, chunkLastNodeIndex);
+        });
+    }
+
+    hierarchy.DirtyNodeCount = 0;
+    hierarchy.ChangedNodeCount = changedNodeCount;
+    return hierarchy.ChangedNodeCount;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Runtime transforms of the scene. Nodes are stored as arrays per component (translation, rotation, scale, world
+// matrix) sorted by depth, every parent comes before its children and the nodes of a depth are a contiguous range.
+// An update walks the depths top down and recomputes the world matrices of dirty nodes and of the nodes below them,
+// the nodes of one depth in parallel.
+// Nodes are referred to by handles, their indices change when nodes are added or removed
+
+constexpr uint32_t g_transformNodeNone = 0xFFFFFFFF;
+
+struct STransformHierarchy {
+    // by node index
+    std::vector<uint32_t> ParentHandles;
+    std::vector<uint32_t> ParentIndices;
+    std::vector<glm::vec3> Translations;
+    std::vector<glm::quat> Rotations;
+    std::vector<glm::vec3> Scales;
+    // a local matrix which translation, rotation and scale can't express (shear), used until they are set
+    std::vector<glm::mat4> LocalMatrices;
+    std::vector<uint8_t> HasLocalMatrix;
+    std::vector<glm::mat4> WorldMatrices;
+    // the local transform changed since the last update
+    std::vector<uint8_t> IsDirty;
+    // the world matrix was recomputed by the last update
+    std::vector<uint8_t> IsChanged;
+    // removed with its descendants by the next update
+    std::vector<uint8_t> IsRemoved;
+    std::vector<uint32_t> NodeHandles;
+    // node indices of depth d are [DepthOffsets[d], DepthOffsets[d + 1])
+    std::vector<uint32_t> DepthOffsets;
+
+    // by handle
+    std::vector<uint32_t> NodeIndices;
+    std::vector<uint32_t> FreeHandles;
+
+    // nodes were added or removed, the next update sorts them again
+    bool IsOrderDirty = false;
+    uint32_t DirtyNodeCount = 0;
+    uint32_t ChangedNodeCount = 0;
+};
+
+// the parent has to exist, g_transformNodeNone makes a root
+auto CreateTransformNode(
+    STransformHierarchy& hierarchy,
+    uint32_t parentNode,
+    const glm::vec3& translation,
+    const glm::quat& rotation,
+    const glm::vec3& scale) -> uint32_t;
+// a local matrix as glTF has them, kept as it is when it has shear, translation, rotation and scale are the
+// closest decomposition then
+auto CreateTransformNode(
+    STransformHierarchy& hierarchy,
+    uint32_t parentNode,
+    const glm::mat4& localMatrix) -> uint32_t;
+// the node and everything below it, handles are free for reuse after the next update
+auto DestroyTransformNode(
+    STransformHierarchy& hierarchy,
+    uint32_t node) -> void;
+
+auto SetTransformNodeLocal(
+    STransformHierarchy& hierarchy,
+    uint32_t node,
+    const glm::vec3& translation,
+    const glm::quat& rotation,
+    const glm::vec3& scale) -> void;
+auto SetTransformNodeRotation(
+    STransformHierarchy& hierarchy,
+    uint32_t node,
+    const glm::quat& rotation) -> void;
+auto GetTransformNodeTranslation(const STransformHierarchy& hierarchy, uint32_t node) -> glm::vec3;
+auto GetTransformNodeRotation(const STransformHierarchy& hierarchy, uint32_t node) -> glm::quat;
+auto GetTransformNodeScale(const STransformHierarchy& hierarchy, uint32_t node) -> glm::vec3;
+
+// world matrix as of the last update
+auto GetWorldMatrix(const STransformHierarchy& hierarchy, uint32_t node) -> const glm::mat4&;
+auto IsTransformNodeChanged(const STransformHierarchy& hierarchy, uint32_t node) -> bool;
+auto GetTransformNodeCount(const STransformHierarchy& hierarchy) -> uint32_t;
+
+// returns the number of world matrices which changed, nodes created since the last update included
+auto UpdateTransformHierarchy(STransformHierarchy& hierarchy) -> uint32_t;
@@ -0,0 +1,461 @@
+#include "UploadQueue.hpp"
+#include "DebugLabel.hpp"
+#include "Macros.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <optional>
+
+#include <glad/gl.h>
+#include <spdlog/spdlog.h>
+
+struct SUploadRequest {
+    uint64_t Id = 0;
+    bool IsTexture = false;
+    bool IsCompressed = false;
+    uint32_t Target = 0;
+    std::size_t TargetOffset = 0;
+    int32_t Level = 0;
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    uint32_t Format = 0;
+    std::span<const std::byte> Data;
+    std::shared_ptr<const void> Owner;
+
+    // progress, bytes for buffers and rows of pixels or blocks for textures
+    std::size_t Submitted = 0;
+};
+
+// everything in the ring before End was consumed by the copies the fence follows
+struct SStagingFence {
+    GLsync Fence = nullptr;
+    uint64_t End = 0;
+};
+
+// consecutive buffer uploads into the same buffer are merged into one copy command
+struct SPendingBufferCopy {
+    uint32_t Buffer = 0;
+    std::size_t StagingOffset = 0;
+    std::size_t BufferOffset = 0;
+    std::size_t Size = 0;
+};
+
+constexpr std::size_t g_stagingAlignment = 16;
+constexpr uint64_t g_stagingWaitTimeoutInNanoseconds = 1'000'000'000;
+
+SUploadQueueSettings g_uploadQueueSettings = {};
+uint32_t g_stagingBuffer = 0;
+std::byte* g_stagingData = nullptr;
+
+// head and tail only ever grow, their difference is the part of the ring in use
+uint64_t g_stagingHead = 0;
+uint64_t g_stagingTail = 0;
+uint64_t g_stagingFencedHead = 0;
+std::deque<SStagingFence> g_stagingFences;
+
+std::deque<SUploadRequest> g_uploadRequests;
+uint64_t g_lastUploadId = 0;
+uint64_t g_submittedUploadId = 0;
+SPendingBufferCopy g_pendingBufferCopy = {};
+bool g_isStagingBufferBoundForUnpack = false;
+
+SUploadStatistics g_uploadStatistics = {};
+
+auto CreateUploadQueue(const SUploadQueueSettings& settings) -> bool {
+
+    g_uploadQueueSettings = settings;
+    g_uploadQueueSettings.StagingBufferSize = (settings.StagingBufferSize + g_stagingAlignment - 1) & ~(g_stagingAlignment - 1);
+    g_uploadQueueSettings.MaxChunkSize = std::clamp(settings.MaxChunkSize, g_stagingAlignment, g_uploadQueueSettings.StagingBufferSize / 2);
+
+    constexpr auto stagingFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glCreateBuffers(1, &g_stagingBuffer);
+    SetDebugLabel(g_stagingBuffer, GL_BUFFER, "StagingBuffer");
+    glNamedBufferStorage(g_stagingBuffer, static_cast<GLsizeiptr>(g_uploadQueueSettings.StagingBufferSize), nullptr, stagingFlags);
+    g_stagingData = static_cast<std::byte*>(glMapNamedBufferRange(
+        g_stagingBuffer,
+        0,
+        static_cast<GLsizeiptr>(g_uploadQueueSettings.StagingBufferSize),
+        stagingFlags));
+
+    if (g_stagingData == nullptr) {
+        spdlog::error("Unable to map the staging buffer");
+        glDeleteBuffers(1, &g_stagingBuffer);
+        g_stagingBuffer = 0;
+        return false;
+    }
+
+    return true;
+}
+
+auto DestroyUploadQueue() -> void {
+
+    for (auto& stagingFence : g_stagingFences) {
+        glClientWaitSync(stagingFence.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, g_stagingWaitTimeoutInNanoseconds);
+        glDeleteSync(stagingFence.Fence);
+    }
+    g_stagingFences.clear();
+    g_uploadRequests.clear();
+
+    if (g_stagingBuffer != 0) {
+        glUnmapNamedBuffer(g_stagingBuffer);
+        glDeleteBuffers(1, &g_stagingBuffer);
+    }
+    g_stagingBuffer = 0;
+    g_stagingData = nullptr;
+}
+
+auto EnqueueUploadRequest(SUploadRequest&& uploadRequest) -> uint64_t {
+
+    uploadRequest.Id = ++g_lastUploadId;
+    g_uploadStatistics.PendingBytes += uploadRequest.Data.size();
+    g_uploadStatistics.PendingUploads++;
+    g_uploadRequests.push_back(std::move(uploadRequest));
+    return g_lastUploadId;
+}
+
+auto EnqueueBufferUpload(
+    uint32_t buffer,
+    std::size_t bufferOffset,
+    std::span<const std::byte> data,
+    std::shared_ptr<const void> owner) -> uint64_t {
+
+    return EnqueueUploadRequest(SUploadRequest{
+        .IsTexture = false,
+        .Target = buffer,
+        .TargetOffset = bufferOffset,
+        .Data = data,
+        .Owner = std::move(owner)
+    });
+}
+
+auto EnqueueTextureUpload(
+    uint32_t texture,
+    int32_t level,
+    uint32_t width,
+    uint32_t height,
+    bool isCompressed,
+    uint32_t format,
+    std::span<const std::byte> data,
+    std::shared_ptr<const void> owner) -> uint64_t {
+
+    return EnqueueUploadRequest(SUploadRequest{
+        .IsTexture = true,
+        .IsCompressed = isCompressed,
+        .Target = texture,
+        .Level = level,
+        .Width = width,
+        .Height = height,
+        .Format = format,
+        .Data = data,
+        .Owner = std::move(owner)
+    });
+}
+
+auto ReclaimStagingMemory(bool waitForOldest) -> void {
+
+    while (!g_stagingFences.empty()) {
+        auto& stagingFence = g_stagingFences.front();
+        const auto waitResult = waitForOldest
+            ? glClientWaitSync(stagingFence.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, g_stagingWaitTimeoutInNanoseconds)
+            : glClientWaitSync(stagingFence.Fence, 0, 0);
+        if (waitResult != GL_ALREADY_SIGNALED && waitResult != GL_CONDITION_SATISFIED) {
+            return;
+        }
+
+        g_stagingTail = stagingFence.End;
+        glDeleteSync(stagingFence.Fence);
+        g_stagingFences.pop_front();
+        waitForOldest = false;
+    }
+}
+
+// allocations never straddle the end of the ring, the rest of it is skipped instead
+auto AllocateStagingMemory(std::size_t size) -> std::optional<std::size_t> {
+
+    const auto stagingBufferSize = g_uploadQueueSettings.StagingBufferSize;
+
+    // an idle ring starts over at its beginning, so even the biggest piece finds room
+    ReclaimStagingMemory(false);
+    if (g_stagingHead == g_stagingTail && g_stagingHead % stagingBufferSize != 0) {
+        g_stagingHead += stagingBufferSize - g_stagingHead % stagingBufferSize;
+        g_stagingTail = g_stagingHead;
+        g_stagingFencedHead = g_stagingHead;
+    }
+
+    auto head =(g_stagingHead + g_stagingAlignment - 1) & ~static_cast<uint64_t>(g_stagingAlignment - 1);
+    auto offset = static_cast<std::size_t>(head % stagingBufferSize);
+    if (offset + size > stagingBufferSize) {
+        head += stagingBufferSize - offset;
+        offset = 0;
+    }
+
+    if (head + size - g_stagingTail > stagingBufferSize) {
+        return std::nullopt;
+    }
+
+    g_stagingHead = head + size;
+    return offset;
+}
+
+auto FlushPendingBufferCopy() -> void {
+
+    if (g_pendingBufferCopy.Size == 0) {
+        return;
+    }
+
+    glCopyNamedBufferSubData(
+        g_stagingBuffer,
+        g_pendingBufferCopy.Buffer,
+        static_cast<GLintptr>(g_pendingBufferCopy.StagingOffset),
+        static_cast<GLintptr>(g_pendingBufferCopy.BufferOffset),
+        static_cast<GLsizeiptr>(g_pendingBufferCopy.Size));
+    g_uploadStatistics.FrameCopyCommands++;
+    g_pendingBufferCopy = {};
+}
+
+auto SubmitBufferChunk(
+    SUploadRequest& uploadRequest,
+    std::size_t stagingOffset,
+    std::size_t chunkSize) -> void {
+
+    const auto bufferOffset = uploadRequest.TargetOffset + uploadRequest.Submitted;
+    const auto isContiguous = g_pendingBufferCopy.Size > 0 &&
+        g_pendingBufferCopy.Buffer == uploadRequest.Target &&
+        g_pendingBufferCopy.StagingOffset + g_pendingBufferCopy.Size == stagingOffset &&
+        g_pendingBufferCopy.BufferOffset + g_pendingBufferCopy.Size == bufferOffset;
+
+    if (isContiguous) {
+        g_pendingBufferCopy.Size += chunkSize;
+        return;
+    }
+
+    FlushPendingBufferCopy();
+    g_pendingBufferCopy = SPendingBufferCopy{
+        .Buffer = uploadRequest.Target,
+        .StagingOffset = stagingOffset,
+        .BufferOffset = bufferOffset,
+        .Size = chunkSize
+    };
+}
+
+auto SubmitTextureChunk(
+    SUploadRequest& uploadRequest,
+    std::size_t stagingOffset,
+    std::size_t rowCount,
+    std::size_t chunkSize) -> void {
+
+    if (!g_isStagingBufferBoundForUnpack) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, g_stagingBuffer);
+        g_isStagingBufferBoundForUnpack = true;
+    }
+
+    const auto rowHeight = uploadRequest.IsCompressed ? 4u : 1u;
+    const auto y = static_cast<uint32_t>(uploadRequest.Submitted) * rowHeight;
+    const auto height = std::min(static_cast<uint32_t>(rowCount) * rowHeight, uploadRequest.Height - y);
+    const auto* pixels = reinterpret_cast<const void*>(stagingOffset);
+
+    if (uploadRequest.IsCompressed) {
+        glCompressedTextureSubImage2D(
+            uploadRequest.Target,
+            uploadRequest.Level,
+            0,
+            static_cast<int32_t>(y),
+            static_cast<int32_t>(uploadRequest.Width),
+            static_cast<int32_t>(height),
+            uploadRequest.Format,
+            static_cast<int32_t>(chunkSize),
+            pixels);
+    } else {
+        glTextureSubImage2D(
+            uploadRequest.Target,
+            uploadRequest.Level,
+            0,
+            static_cast<int32_t>(y),
+            static_cast<int32_t>(uploadRequest.Width),
+            static_cast<int32_t>(height),
+            GL_RGBA,
+            GL_UNSIGNED_BYTE,
+            pixels);
+    }
+    g_uploadStatistics.FrameCopyCommands++;
+}
+
+auto GetUploadRowCount(const SUploadRequest& uploadRequest) -> std::size_t {
+    return uploadRequest.IsCompressed
+        ? (uploadRequest.Height + 3) / 4
+        : uploadRequest.Height;
+}
+
+auto IsUploadRequestComplete(const SUploadRequest& uploadRequest) -> bool {
+    return uploadRequest.IsTexture
+        ? uploadRequest.Submitted >= GetUploadRowCount(uploadRequest)
+        : uploadRequest.Submitted >= uploadRequest.Data.size();
+}
+
+// moves the next piece of an upload into the ring and records its copy, false when the ring is full.
+// textures are cut along rows, or rows of blocks when compressed, so every piece is a valid sub image
+auto SubmitUploadChunk(SUploadRequest& uploadRequest) -> bool {
+
+    std::size_t dataOffset = 0;
+    std::size_t chunkSize = 0;
+    std::size_t rowCount = 0;
+
+    if (uploadRequest.IsTexture) {
+        const auto totalRowCount = GetUploadRowCount(uploadRequest);
+        const auto rowSize = uploadRequest.Data.size() / std::max(totalRowCount, std::size_t{1});
+        rowCount = std::min(totalRowCount - uploadRequest.Submitted, std::max(g_uploadQueueSettings.MaxChunkSize / std::max(rowSize, std::size_t{1}), std::size_t{1}));
+        dataOffset = uploadRequest.Submitted * rowSize;
+        chunkSize = rowCount * rowSize;
+    } else {
+        dataOffset = uploadRequest.Submitted;
+        chunkSize = std::min(uploadRequest.Data.size() - uploadRequest.Submitted, g_uploadQueueSettings.MaxChunkSize);
+    }
+
+    if (chunkSize > g_uploadQueueSettings.StagingBufferSize) {
+        spdlog::error("Upload of {} bytes does not fit into the staging buffer, dropping it", chunkSize);
+        uploadRequest.Submitted = uploadRequest.IsTexture ? GetUploadRowCount(uploadRequest) : uploadRequest.Data.size();
+        g_uploadStatistics.PendingBytes -= uploadRequest.Data.size() - dataOffset;
+        return true;
+    }
+
+    auto stagingOffset = AllocateStagingMemory(chunkSize);
+    if (!stagingOffset.has_value()) {
+        return false;
+    }
+
+    std::memcpy(g_stagingData + *stagingOffset, uploadRequest.Data.data() + dataOffset, chunkSize);
+
+    if (uploadRequest.IsTexture) {
+        SubmitTextureChunk(uploadRequest, *stagingOffset, rowCount, chunkSize);
+        uploadRequest.Submitted += rowCount;
+    } else {
+        SubmitBufferChunk(uploadRequest, *stagingOffset, chunkSize);
+        uploadRequest.Submitted += chunkSize;
+    }
+
+    g_uploadStatistics.FrameBytes += chunkSize;
+    g_uploadStatistics.TotalBytes += chunkSize;
+    g_uploadStatistics.PendingBytes -= chunkSize;
+    return true;
+}
+
+auto CompleteUploadRequests() -> void {
+
+    while (!g_uploadRequests.empty() && IsUploadRequestComplete(g_uploadRequests.front())) {
+        g_submittedUploadId = g_uploadRequests.front().Id;
+        g_uploadStatistics.PendingUploads--;
+        g_uploadRequests.pop_front();
+    }
+}
+
+// issues the merged copies and fences everything written into the ring since the last fence
+auto EndUploadBatch() -> void {
+
+    FlushPendingBufferCopy();
+
+    if (g_isStagingBufferBoundForUnpack) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        g_isStagingBufferBoundForUnpack = false;
+    }
+
+    if (g_stagingHead != g_stagingFencedHead) {
+        g_stagingFences.push_back(SStagingFence{
+            .Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+            .End = g_stagingHead
+        });
+        g_stagingFencedHead = g_stagingHead;
+    }
+}
+
+auto CountUploadStall() -> void {
+    g_uploadStatistics.FrameStalls++;
+    g_uploadStatistics.TotalStalls++;
+}
+
+auto ProcessUploadQueue(double budgetInMilliseconds) -> void {
+
+    TOADWART_PROFILE_SCOPED();
+
+    const auto startTime = std::chrono::steady_clock::now();
+    auto getElapsedMilliseconds = [&]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    };
+
+    g_uploadStatistics.FrameBytes = 0;
+    g_uploadStatistics.FrameCopyCommands = 0;
+    g_uploadStatistics.FrameStalls = 0;
+
+    ReclaimStagingMemory(false);
+
+    auto submittedChunkCount = 0;
+    while (!g_uploadRequests.empty()) {
+
+        if (submittedChunkCount > 0 && getElapsedMilliseconds() >= budgetInMilliseconds) {
+            break;
+        }
+
+        if (!SubmitUploadChunk(g_uploadRequests.front())) {
+            CountUploadStall();
+            break;
+        }
+        submittedChunkCount++;
+
+        CompleteUploadRequests();
+    }
+
+    EndUploadBatch();
+    CompleteUploadRequests();
+
+    g_uploadStatistics.FrameMilliseconds = getElapsedMilliseconds();
+}
+
+auto FinishUploadQueue() -> void {
+
+    TOADWART_PROFILE_SCOPED();
+
+    while (!g_uploadRequests.empty()) {
+
+        if (!SubmitUploadChunk(g_uploadRequests.front())) {
+            CountUploadStall();
+            EndUploadBatch();
+            ReclaimStagingMemory(true);
+            continue;
+        }
+
+        CompleteUploadRequests();
+    }
+
+    EndUploadBatch();
+    CompleteUploadRequests();
+}
+
+auto RetargetBufferUploads(
+    uint32_t buffer,
+    uint32_t newBuffer) -> void {
+
+    // a merged copy still waiting to be issued has to land in the old buffer, the caller copies it over afterwards
+    if (g_pendingBufferCopy.Buffer == buffer) {
+        FlushPendingBufferCopy();
+    }
+
+    for (auto& uploadRequest : g_uploadRequests) {
+        if (!uploadRequest.IsTexture && uploadRequest.Target == buffer) {
+            uploadRequest.Target = newBuffer;
+        }
+    }
+}
+
+auto GetLastUploadId() -> uint64_t {
+    return g_lastUploadId;
+}
+
+auto IsUploadSubmitted(uint64_t uploadId) -> bool {
+    return uploadId <= g_submittedUploadId;
+}
+
+auto GetUploadStatistics() -> const SUploadStatistics& {
+    return g_uploadStatistics;
+}
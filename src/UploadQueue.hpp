@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+// Streams buffer and texture data to the GPU through a persistently mapped staging buffer used as a ring.
+// Requests are queued right away and copied out of the ring by ProcessUploadQueue, once per frame and only for
+// as long as the frame budget allows. Regions of the ring are handed back once the fence of the frame which
+// consumed them has signaled, a full ring defers the remaining uploads to the next frame instead of waiting
+
+struct SUploadQueueSettings {
+    std::size_t StagingBufferSize = 64 * 1024 * 1024;
+    // uploads are cut into pieces of at most this size, so a single big upload can't blow the budget of a frame
+    std::size_t MaxChunkSize = 4 * 1024 * 1024;
+};
+
+struct SUploadStatistics {
+    std::size_t FrameBytes = 0;
+    uint32_t FrameCopyCommands = 0;
+    uint32_t FrameStalls = 0;
+    double FrameMilliseconds = 0.0;
+
+    std::size_t PendingBytes = 0;
+    uint32_t PendingUploads = 0;
+
+    std::size_t TotalBytes = 0;
+    uint32_t TotalStalls = 0;
+};
+
+auto CreateUploadQueue(const SUploadQueueSettings& settings) -> bool;
+auto DestroyUploadQueue() -> void;
+
+// data has to stay valid until the upload went through, owner is kept alive until then. both return an id
+// which can be checked with IsUploadSubmitted
+auto EnqueueBufferUpload(
+    uint32_t buffer,
+    std::size_t bufferOffset,
+    std::span<const std::byte> data,
+    std::shared_ptr<const void> owner) -> uint64_t;
+
+// format is the internal format when the texture is compressed, otherwise the pixels are GL_RGBA/GL_UNSIGNED_BYTE
+auto EnqueueTextureUpload(
+    uint32_t texture,
+    int32_t level,
+    uint32_t width,
+    uint32_t height,
+    bool isCompressed,
+    uint32_t format,
+    std::span<const std::byte> data,
+    std::shared_ptr<const void> owner) -> uint64_t;
+
+// copies queued uploads for at most budgetInMilliseconds, at least one piece always goes through
+auto ProcessUploadQueue(double budgetInMilliseconds) -> void;
+
+// drains the whole queue, waiting on the GPU whenever the ring runs full. meant for loading screens and startup
+auto FinishUploadQueue() -> void;
+
+// points the queued uploads of a buffer at another one, for buffers being replaced by a bigger copy of themselves.
+// has to be called before the contents of the old buffer get copied over
+auto RetargetBufferUploads(
+    uint32_t buffer,
+    uint32_t newBuffer) -> void;
+
+// id of the upload enqueued last, all uploads up to it are submitted once it is
+auto GetLastUploadId() -> uint64_t;
+
+// commands issued after an upload was submitted see its data, the copies are ordered on the GPU
+auto IsUploadSubmitted(uint64_t uploadId) -> bool;
+
+auto GetUploadStatistics() -> const SUploadStatistics&;
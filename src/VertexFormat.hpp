@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/common.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/type_precision.hpp>
+
+// Vertex layouts of the mega vertex buffers. Every format carries the GLSL of its storage buffer element next to
+// the C++ layout, the shader preprocessor injects it in place of "#pragma vertex_format", so both sides
+// can't drift apart. Switch formats with g_vertexPositionFormat and g_vertexUvFormat below, the model cache
+// keys its files on the selected formats
+
+enum class EVertexPositionFormat : uint32_t {
+    Float32,
+    Unorm16
+};
+
+enum class EVertexUvFormat : uint32_t {
+    Float32,
+    Float16
+};
+
+// positions are stored relative to the bounds of their primitive, object space is offset + position * scale
+struct SVertexQuantization {
+    glm::vec3 Scale;
+    glm::vec3 Offset;
+};
+
+template <EVertexPositionFormat TFormat>
+struct SVertexPositionFormat;
+
+template <>
+struct SVertexPositionFormat<EVertexPositionFormat::Float32> {
+    glm::vec3 Position;
+
+    static constexpr std::string_view Glsl = R"(
+struct SVertexPosition
+{
+    SPackedVec3 Position;
+};
+
+vec3 DecodePosition(in SVertexPosition vertex_position, in vec3 scale, in vec3 offset)
+{
+    return PackedToVec3(vertex_position.Position);
+}
+)";
+
+    static auto GetQuantization(std::span<const glm::vec3>) -> SVertexQuantization {
+        return SVertexQuantization{
+            .Scale = glm::vec3(1.0f),
+            .Offset = glm::vec3(0.0f)
+        };
+    }
+
+    static auto Encode(const glm::vec3& position, const SVertexQuantization&) -> SVertexPositionFormat {
+        return SVertexPositionFormat{
+            .Position = position
+        };
+    }
+};
+
+template <>
+struct SVertexPositionFormat<EVertexPositionFormat::Unorm16> {
+    uint32_t PositionXY;
+    uint32_t PositionZ;
+
+    static constexpr std::string_view Glsl = R"(
+struct SVertexPosition
+{
+    uint PositionXY;
+    uint PositionZ;
+};
+
+vec3 DecodePosition(in SVertexPosition vertex_position, in vec3 scale, in vec3 offset)
+{
+    return vec3(unpackUnorm2x16(vertex_position.PositionXY), unpackUnorm2x16(vertex_position.PositionZ).x) * scale + offset;
+}
+)";
+
+    static auto GetQuantization(std::span<const glm::vec3> positions) -> SVertexQuantization {
+
+        if (positions.empty()) {
+            return SVertexQuantization{
+                .Scale = glm::vec3(1.0f),
+                .Offset = glm::vec3(0.0f)
+            };
+        }
+
+        auto minimum = positions[0];
+        auto maximum = positions[0];
+        for (const auto& position : positions) {
+            minimum = glm::min(minimum, position);
+            maximum = glm::max(maximum, position);
+        }
+
+        return SVertexQuantization{
+            .Scale = glm::max(maximum - minimum, glm::vec3(1e-6f)),
+            .Offset = minimum
+        };
+    }
+
+    static auto Encode(const glm::vec3& position, const SVertexQuantization& quantization) -> SVertexPositionFormat {
+        const auto normalizedPosition = glm::clamp((position - quantization.Offset) / quantization.Scale, 0.0f, 1.0f);
+        return SVertexPositionFormat{
+            .PositionXY = glm::packUnorm2x16(glm::vec2(normalizedPosition.x, normalizedPosition.y)),
+            .PositionZ = glm::packUnorm2x16(glm::vec2(normalizedPosition.z, 0.0f))
+        };
+    }
+};
+
+template <EVertexUvFormat TFormat>
+struct SVertexNormalUvFormat;
+
+template <>
+struct SVertexNormalUvFormat<EVertexUvFormat::Float32> {
+    uint32_t Normal;
+    glm::vec2 Uv;
+
+    static constexpr std::string_view Glsl = R"(
+struct SVertexNormalUv
+{
+    uint Normal;
+    SPackedVec2 Uv;
+};
+
+vec2 DecodeUv(in SVertexNormalUv vertex_normal_uv)
+{
+    return PackedToVec2(vertex_normal_uv.Uv);
+}
+)";
+
+    static auto EncodeUv(const glm::vec2& uv) -> glm::vec2 {
+        return uv;
+    }
+};
+
+template <>
+struct SVertexNormalUvFormat<EVertexUvFormat::Float16> {
+    uint32_t Normal;
+    uint32_t Uv;
+
+    static constexpr std::string_view Glsl = R"(
+struct SVertexNormalUv
+{
+    uint Normal;
+    uint Uv;
+};
+
+vec2 DecodeUv(in SVertexNormalUv vertex_normal_uv)
+{
+    return unpackHalf2x16(vertex_normal_uv.Uv);
+}
+)";
+
+    static auto EncodeUv(const glm::vec2& uv) -> uint32_t {
+        return glm::packHalf2x16(uv);
+    }
+};
+
+constexpr auto g_vertexPositionFormat = EVertexPositionFormat::Unorm16;
+constexpr auto g_vertexUvFormat = EVertexUvFormat::Float16;
+
+using SVertexPosition = SVertexPositionFormat<g_vertexPositionFormat>;
+using SVertexNormalUv = SVertexNormalUvFormat<g_vertexUvFormat>;
+
+static_assert(sizeof(SVertexPositionFormat<EVertexPositionFormat::Float32>) == 12);
+static_assert(sizeof(SVertexPositionFormat<EVertexPositionFormat::Unorm16>) == 8);
+static_assert(sizeof(SVertexNormalUvFormat<EVertexUvFormat::Float32>) == 12);
+static_assert(sizeof(SVertexNormalUvFormat<EVertexUvFormat::Float16>) == 8);
+
+constexpr auto GetVertexFormatId() -> uint32_t {
+    return static_cast<uint32_t>(g_vertexPositionFormat) | (static_cast<uint32_t>(g_vertexUvFormat) << 8);
+}
+
+inline auto GetVertexFormatGlsl() -> std::string {
+    return std::string(SVertexPosition::Glsl) + std::string(SVertexNormalUv::Glsl);
+}